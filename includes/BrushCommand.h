@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief What a brush does to the particles it covers; combined in BrushCommand::actions.
+ */
+enum BrushActions : std::uint8_t
+{
+    /// @brief Highlights the constraints of the covered particles.
+    BRUSH_SELECT = 1 << 0,
+
+    /// @brief Moves the covered particles by the brush delta, clamped by their cloth's elasticity.
+    BRUSH_DRAG = 1 << 1,
+
+    /// @brief Pins the covered particles where they are until the cloth is reset.
+    BRUSH_PIN = 1 << 2,
+
+    /// @brief Removes the covered particles and tears every constraint through them.
+    BRUSH_CUT = 1 << 3,
+};
+
+/**
+ * @struct BrushCommand
+ * @brief One circular edit of the cloth, queued with Cloth::QueueBrush.
+ *
+ * All actions of a command share one region query and one pass over the
+ * particles under the brush, applied in the order select, drag, pin, cut.
+ */
+struct BrushCommand
+{
+    /// @brief Centre of the brush in simulation coordinates.
+    float x = 0.f;
+    float y = 0.f;
+
+    /// @brief Radius of the brush.
+    float radius = 0.f;
+
+    /// @brief Distance the brush moved since the previous step, for BRUSH_DRAG.
+    float deltaX = 0.f;
+    float deltaY = 0.f;
+
+    /// @brief Combination of BrushActions.
+    std::uint8_t actions = 0;
+};
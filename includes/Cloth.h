@@ -1,6 +1,22 @@
 #pragma once
 
-#include "Particle.h"
+#include "ClothDesc.h"
+#include "ColliderSet.h"
+#include "Constraint.h"
+#include "ConstraintHierarchy.h"
+#include "ConstraintKernel.h"
+#include "BrushCommand.h"
+#include "ClothInput.h"
+#include "ImplicitIntegrator.h"
+#include "IslandSet.h"
+#include "ParticleBuffer.h"
+#include "SelfCollision.h"
+#include "SolverSettings.h"
+#include "SpatialHash.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "SFML/System/Vector2.hpp"
+#include <memory>
 #include <vector>
 
 /**
@@ -8,43 +24,257 @@
  * @brief Represents a 2D cloth mesh made up of particles and constraints.
  *
  * Simulates realistic cloth behavior using Verlet integration and structural constraints.
- * Can be updated and rendered per frame as part of a physics simulation.
+ * Has no dependency on a window or the input system, so it can be stepped headless;
+ * rendering is handled by the viewer (see ClothRenderer).
  */
 class Cloth
 {
+    // Saves and restores the complete simulation state
+    friend class ClothCheckpoint;
+
 private:
     /**
-     * @brief Gravity vector applied to all particles in the cloth.
+     * @brief Size, placement and physical parameters of each cloth held.
+     */
+    std::vector<ClothDesc> m_cloths;
+
+    /**
+     * @brief First particle of each cloth, plus the total particle count at the end.
+     *
+     * Cloth i owns particles [m_clothParticleBegin[i], m_clothParticleBegin[i + 1]).
      */
-    sf::Vector2f m_gravity;
+    std::vector<std::uint32_t> m_clothParticleBegin;
 
     /**
-     * @brief Drag coefficient applied to particle velocity (simulates air resistance).
+     * @brief Width of the simulation area particles are kept inside.
      */
-    float m_drag;
+    int m_boundsWidth = 0;
 
     /**
-     * @brief Elasticity factor that determines how much constraints can stretch or compress.
+     * @brief Height of the simulation area particles are kept inside.
      */
-    float m_elasticity;
+    int m_boundsHeight = 0;
 
     /**
-     * @brief List of all particles making up the cloth mesh.
+     * @brief All particles making up the cloth mesh, stored as structure of arrays.
      */
-    std::vector<Particle> m_particles;
+    ParticleBuffer m_particles;
 
     /**
-     * @brief List of all constraints (springs) between particles.
+     * @brief List of all constraints (springs) between particles, grouped by color batch.
+     *
+     * Structural constraints come first, followed by shear and then bending constraints.
      */
     std::vector<Constraint> m_constraints;
 
+    /**
+     * @brief Independent constraint ranges solved one after another.
+     *
+     * On the grid these are four structural batches (horizontal-even, horizontal-odd,
+     * vertical-even and vertical-odd, where even/odd is the column or row of the first
+     * particle), four shear batches (two per diagonal) and four bending batches.
+     * Each batch spans all cloths, so many small cloths are solved in a few long passes.
+     */
+    std::vector<ConstraintBatch> m_batches;
+
+    /**
+     * @brief Threads used to solve each constraint batch; may be shared with other subsystems.
+     */
+    std::shared_ptr<ThreadPool> m_threadPool;
+
+    /**
+     * @brief Whether each phase uses the scalar reference loops instead of the SIMD kernels.
+     */
+    bool m_isReferenceSolver = false;
+
+    /**
+     * @brief Iteration budget and early-exit tolerance of the constraint solver.
+     */
+    SolverSettings m_solverSettings;
+
+    /**
+     * @brief Iterations and residual of the most recent step.
+     */
+    SolverStats m_lastStats;
+
+    /**
+     * @brief Per-chunk residuals of the current pass, combined in a fixed order.
+     */
+    std::vector<ConstraintResidual> m_chunkResiduals;
+
+    /**
+     * @brief Lagrange multiplier of every constraint, accumulated over the passes of a step
+     * (ConstraintModel::Compliance only).
+     */
+    std::vector<float> m_lambdas;
+
+    /**
+     * @brief Solves every constraint batch once.
+     *
+     * @param deltaTime Time step, which scales compliances under ConstraintModel::Compliance.
+     * @return Residual of the pass according to the solver settings' norm.
+     */
+    float SolveConstraintPass(float deltaTime);
+
+    /**
+     * @brief Horizontal and vertical constraint index of each particle.
+     *
+     * Two entries per particle (index 0 = horizontal, index 1 = vertical); NO_CONSTRAINT marks an empty slot.
+     */
+    std::vector<std::uint32_t> m_particleConstraints;
+
+    /**
+     * @brief Shear and bending constraints of each particle, in compressed rows.
+     *
+     * Particle i's constraints are m_softConstraints[m_softConstraintBegin[i], m_softConstraintBegin[i + 1]).
+     * Bending constraints are also listed under the particle they skip.
+     */
+    std::vector<std::uint32_t> m_softConstraintBegin;
+    std::vector<std::uint32_t> m_softConstraints;
+
+    /**
+     * @brief Rebuilds m_softConstraintBegin and m_softConstraints from the constraint list.
+     */
+    void BuildSoftConstraintIndex();
+
+    /**
+     * @brief Coarse grids solved before the fine passes when the solver settings ask for multigrid levels.
+     */
+    ConstraintHierarchy m_hierarchy;
+
+    /**
+     * @brief Set when constraints were torn or restored; the hierarchy's tethers are refreshed before the next solve.
+     */
+    bool m_isHierarchyDirty = false;
+
+    /**
+     * @brief Backward Euler integrator used instead of Verlet and the passes when the solver settings ask for it.
+     */
+    ImplicitIntegrator m_implicitIntegrator;
+
+    /**
+     * @brief Set when the springs of the implicit integrator no longer match the active constraints or the settings.
+     */
+    bool m_isSpringPatternDirty = true;
+
+    /**
+     * @brief Rebuilds the coarse grids for the current cloths and multigrid level count.
+     */
+    void BuildHierarchy();
+
+    /**
+     * @brief Connected pieces of cloth, put to sleep once they rest when the solver settings give a sleep speed.
+     */
+    IslandSet m_islands;
+
+    /**
+     * @brief Set when constraints were torn or every particle was woken; islands are rebuilt before the next step.
+     */
+    bool m_areIslandsDirty = true;
+
+    /**
+     * @brief Set when particles fell asleep or woke up; the awake runs and batches are rebuilt before the next step.
+     */
+    bool m_areRunsDirty = true;
+
+    /**
+     * @brief Awake particles in runs sharing gravity and drag; with nothing asleep, one run per group of alike cloths.
+     */
+    std::vector<ParticleRun> m_particleRuns;
+
+    /**
+     * @brief Parts of m_batches left after cutting out the constraints of sleeping islands, in the same order.
+     *
+     * With nothing asleep these equal m_batches, so the solver does exactly the same work.
+     */
+    std::vector<ConstraintBatch> m_awakeBatches;
+
+    /**
+     * @brief Rebuilds the islands and the awake runs and batches if they are out of date.
+     */
+    void UpdateIslands();
+
+    /**
+     * @brief Rebuilds m_particleRuns and m_awakeBatches from the particles' sleeping flags.
+     */
+    void BuildRuns();
+
+    /**
+     * @brief Wakes every particle; islands are found again before the next step.
+     */
+    void WakeAll();
+
+    /**
+     * @brief Lays out the particles and constraints of the given cloths in the existing storage.
+     *
+     * @param cloths Size, placement and physical parameters of each cloth.
+     */
+    void Build(const std::vector<ClothDesc>& cloths);
+
+    /**
+     * @brief Spatial index used to find the particles under the cursor.
+     */
+    SpatialHash m_spatialHash;
+
+    /**
+     * @brief Whether the hash holds every active particle at its current position.
+     *
+     * The first brush fills it; from then on UpdateSpatialHash keeps it current at
+     * the end of every step, so brushes only query. Cleared when the hash is emptied.
+     */
+    bool m_isSpatialHashFilled = false;
+
+    /**
+     * @brief Keeps particles apart when self-collision is enabled in the solver settings.
+     */
+    SelfCollision m_selfCollision;
+
+    /**
+     * @brief Static obstacles particles are pushed out of after the constraint solve.
+     */
+    ColliderSet m_colliders;
+
+    /**
+     * @brief Particles found under the brush by the last query.
+     */
+    std::vector<std::uint32_t> m_brushParticles;
+
+    /**
+     * @brief Brush edits waiting for the next step, applied in queue order.
+     */
+    std::vector<BrushCommand> m_brushCommands;
+
+    /**
+     * @brief Constraints currently highlighted, so they can be cleared without scanning all constraints.
+     */
+    std::vector<std::uint32_t> m_selectedConstraints;
+
+    /**
+     * @brief Queues the cursor as a brush, then applies and clears every queued brush command.
+     *
+     * @param input Pointer state for this step.
+     */
+    void ApplyBrushes(const ClothInput& input);
+
+    /**
+     * @brief Applies the actions of one brush command to the particles under it.
+     *
+     * The spatial hash must be up to date.
+     */
+    void ApplyBrush(const BrushCommand& brush);
+
 public:
+    /**
+     * @brief Marks an empty slot in the per-particle constraint table.
+     */
+    static constexpr std::uint32_t NO_CONSTRAINT = 0xFFFFFFFFu;
+
     /**
      * @brief Default constructor.
      *
-     * Initializes an empty cloth object. Use only if parameters will be set later.
+     * Holds no cloths until Rebuild is called.
      */
-    Cloth() = default;
+    Cloth();
 
     /**
      * @brief Constructs a cloth mesh with specified dimensions and physical properties.
@@ -60,29 +290,269 @@ public:
      */
     Cloth(int width_size, int height_size, int gap, int start_x, int start_y, float gravity, float drag, float elasticity);
 
+    /**
+     * @brief Constructs many independent cloths in shared, contiguous storage.
+     *
+     * Particles of all cloths live in one buffer, cloth after cloth, and their
+     * constraints are interleaved into the same four batches, so a step walks
+     * contiguous memory however many cloths there are.
+     *
+     * @param cloths Size, placement and physical parameters of each cloth.
+     */
+    explicit Cloth(const std::vector<ClothDesc>& cloths);
+
     /**
      * @brief Default destructor.
      */
     ~Cloth() = default;
 
+    Cloth(Cloth&&) = default;
+    Cloth& operator=(Cloth&&) = default;
+
+    /**
+     * @brief Replaces all cloths with a new set, reusing the existing storage.
+     *
+     * Nothing is allocated unless the new cloths need more particles or constraints
+     * than any set held before. Bounds, thread count, solver settings and colliders are kept.
+     *
+     * @param cloths Size, placement and physical parameters of each cloth.
+     */
+    void Rebuild(const std::vector<ClothDesc>& cloths);
+
+    /**
+     * @brief Returns every cloth to the state it was built in, mending any cuts.
+     *
+     * Only particle state and constraint flags are rewritten; the topology is left
+     * untouched, so this allocates nothing and costs about one integration step.
+     * Every particle wakes up.
+     */
+    void Reset();
+
+    /**
+     * @brief Sets the size of the area particles are kept inside.
+     *
+     * Wakes every particle, since sleeping ones may now lie outside the area.
+     *
+     * @param width Width of the simulation area (usually the window width).
+     * @param height Height of the simulation area (usually the window height).
+     */
+    void SetBounds(int width, int height);
+
+    /**
+     * @brief Returns the width of the area particles are kept inside.
+     */
+    int GetBoundsWidth() const;
+
+    /**
+     * @brief Returns the height of the area particles are kept inside.
+     */
+    int GetBoundsHeight() const;
+
+    /**
+     * @brief Sets how many threads solve the constraints.
+     *
+     * The result of a step is bit-identical for any thread count.
+     *
+     * @param threadCount Number of threads including the caller; zero uses all hardware threads.
+     */
+    void SetThreadCount(unsigned threadCount);
+
+    /**
+     * @brief Solves on an existing pool, e.g. one shared with the renderer.
+     *
+     * The result of a step is bit-identical for any pool.
+     *
+     * @param threadPool Pool to use; null falls back to the calling thread.
+     */
+    void SetThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
+    /**
+     * @brief Solves with the scalar reference loops instead of the SIMD kernels.
+     *
+     * Particles are integrated one at a time and structural constraints are
+     * solved by Constraint::Update, in the same batch and chunk order as the
+     * kernels. Both paths are meant to be bit-identical, so comparing state
+     * hashes (see StateHash) of a reference run against a kernel run shows
+     * the step at which an optimization changed the result. Independent of
+     * the thread count; combine with one thread for a fully serial run.
+     *
+     * @param isReference True to use the reference loops.
+     */
+    void SetReferenceSolver(bool isReference);
+
+    /**
+     * @brief Returns whether the scalar reference loops are in use.
+     */
+    bool IsReferenceSolver() const;
+
+    /**
+     * @brief Sets the iteration budget and early-exit tolerance of the constraint solver.
+     *
+     * Wakes every particle, so the new settings apply to all of them.
+     *
+     * @param settings New solver settings; iteration counts are clamped to at least one.
+     */
+    void SetSolverSettings(const SolverSettings& settings);
+
+    /**
+     * @brief Replaces the static colliders and rebuilds their hierarchy.
+     *
+     * Wakes every particle, so sleeping ones are pushed out of new colliders.
+     *
+     * @param colliders New obstacles; an empty list leaves only the bounds.
+     */
+    void SetColliders(const std::vector<Collider>& colliders);
+
+    /**
+     * @brief Returns the static colliders, in the order they were set.
+     */
+    const std::vector<Collider>& GetColliders() const;
+
+    /**
+     * @brief Returns the current solver settings.
+     */
+    const SolverSettings& GetSolverSettings() const;
+
+    /**
+     * @brief Returns how many passes the last step took and the residual it reached.
+     */
+    const SolverStats& GetLastStepStats() const;
+
+    /**
+     * @brief Queues a brush edit, applied at the start of the next step before the cursor's.
+     *
+     * Lets tools and scripts drag, pin or cut the cloth without a pointer.
+     *
+     * @param command Where the brush is and what it does.
+     */
+    void QueueBrush(const BrushCommand& command);
+
+    /**
+     * @brief Updates all particles and constraints in the cloth for one simulation step.
+     *
+     * Applies queued brushes and cursor interaction, applies gravity and drag, enforces constraints, and updates positions.
+     *
+     * @param deltaTime Time elapsed since the last step (in seconds).
+     * @param input Pointer state for this step (cursor position, brush size, buttons).
+     */
+    void Update(float deltaTime, const ClothInput& input);
+
     /**
-     * @brief Updates all particles and constraints in the cloth for the current frame.
+     * @brief Adds the phases of Update to a task graph, each depending on the one before.
+     *
+     * Each phase writes the particle arrays or reads what the one before
+     * wrote, so they form a chain; work added after the returned task
+     * (drawing, recording, hashing) can run side by side.
+     * Running the graph is equivalent to calling Update. Within each phase the
+     * loops and constraint batches are still split across the cloth's pool.
      *
-     * Handles mouse interaction, applies gravity and drag, enforces constraints, and updates positions.
+     * @param graph Graph to add the phases to; it holds on to this cloth.
+     * @param deltaTime Read when the graph runs; must outlive the graph.
+     * @param input Read when the graph runs; must outlive the graph.
+     * @return The last phase, which later tasks should depend on.
+     */
+    TaskGraph::TaskId AddStepTasks(TaskGraph& graph, const float& deltaTime, const ClothInput& input);
+
+    /**
+     * @brief First phase of Update: brush edits and Verlet integration of all awake particles.
      *
-     * @param deltaTime Time elapsed since the last frame (in seconds).
-     * @param win Reference to the SFML render window (used for coordinate conversion).
-     * @param mousePos Current mouse position in window coordinates.
-     * @param lastMousePos Previous mouse position (used for interaction like dragging).
+     * @param deltaTime Time elapsed since the last step (in seconds).
+     * @param input Pointer state for this step.
      */
-    void Update(float deltaTime, sf::RenderWindow& win, sf::Vector2i& mousePos, sf::Vector2i& lastMousePos);
+    void IntegrateParticles(float deltaTime, const ClothInput& input);
 
     /**
-     * @brief Renders the cloth on the SFML window.
+     * @brief Second phase of Update: constraint passes within the solver's iteration budget.
      *
-     * Draws all particles and connecting constraints.
+     * @param deltaTime Time elapsed since the last step (in seconds).
+     */
+    void SolveConstraints(float deltaTime);
+
+    /**
+     * @brief Third phase of Update: pushes apart particles closer than the self-collision distance.
+     *
+     * Does nothing unless the solver settings enable self-collision.
+     */
+    void SolveSelfCollisions();
+
+    /**
+     * @brief Fourth phase of Update: moves particles out of the static colliders.
+     */
+    void ResolveColliders();
+
+    /**
+     * @brief Fifth phase of Update: moves the awake particles that changed cell in the brush hash.
+     *
+     * Brushes in the next step then find the particles under them without a
+     * rescan. Does nothing until a brush has filled the hash.
+     */
+    void UpdateSpatialHash();
+
+    /**
+     * @brief Last phase of Update: puts islands that have rested long enough to sleep.
+     *
+     * Does nothing unless the solver settings give a sleep speed. Sleeping islands
+     * pushed by self-collision this step wake up again.
+     */
+    void UpdateSleep();
+
+    /**
+     * @brief Returns the number of connected pieces of cloth and how many of them are asleep.
+     *
+     * Both are zero while sleeping is disabled.
+     */
+    std::size_t GetIslandCount() const;
+    std::size_t GetSleepingIslandCount() const;
+
+    /**
+     * @brief Returns all particles of the cloth.
+     *
+     * @return Read-only reference to the particle storage.
+     */
+    const ParticleBuffer& GetParticles() const;
+
+    /**
+     * @brief Returns all constraints of the cloth, including destroyed ones.
+     *
+     * @return Read-only reference to the constraint list.
+     */
+    const std::vector<Constraint>& GetConstraints() const;
+
+    /**
+     * @brief Returns the number of structural constraints, which lead GetConstraints().
+     *
+     * Only these are drawn and recorded; shear and bending constraints are invisible.
+     */
+    std::size_t GetStructuralConstraintCount() const;
+
+    /**
+     * @brief Returns the independent constraint batches, in solve order.
+     */
+    const std::vector<ConstraintBatch>& GetBatches() const;
+
+    /**
+     * @brief Returns the number of cloths held.
+     */
+    std::size_t GetClothCount() const;
+
+    /**
+     * @brief Returns the description a cloth was built from.
+     *
+     * @param cloth Index of the cloth.
+     */
+    const ClothDesc& GetClothDesc(std::size_t cloth) const;
+
+    /**
+     * @brief Returns the first particle of a cloth.
+     *
+     * @param cloth Index of the cloth; GetClothCount() gives the total particle count.
+     */
+    std::uint32_t GetClothParticleBegin(std::size_t cloth) const;
+
+    /**
+     * @brief Returns the index of the cloth a particle belongs to.
      *
-     * @param win Reference to the SFML render window.
+     * @param particle Index of the particle.
      */
-    void RenderCloth(sf::RenderWindow& win);
+    std::size_t GetClothOfParticle(std::uint32_t particle) const;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+/// @brief Width of the application window in pixels.
+#define WIN_WIDTH 400
+
+/// @brief Height of the application window in pixels.
+#define WIN_HEIGHT 350
+
+/// @brief Width of the cloth mesh in simulation units.
+#define CLOTH_WIDTH 240
+
+/// @brief Height of the cloth mesh in simulation units.
+#define CLOTH_HEIGHT 190
+
+/// @brief Spacing (gap) between particles in the cloth mesh.
+#define CLOTH_GAPPING 10
+
+/// @brief Downward accleration due to gravity applied on the cloth
+#define GRAVITY 9.81
+
+/// @brief Air resistance or damping applied to particle motion.
+#define DRAG 0.01
+
+/// @brief Strength of the constraint forces keeping particles together.
+#define ELASTICITY 10
+
+/// @brief Radius of circular input that is used for interacting with cloth.
+#define CURSOR_SIZE 20
+
+/// @brief Fixed physics steps per second, independent of the rendering frame rate.
+#define PHYSICS_RATE 60
+
+/// @brief Maximum physics steps run in one rendered frame before falling behind real time.
+#define MAX_SUBSTEPS 5
+
+/// @brief Run physics on its own thread, overlapping with input handling and rendering.
+#define PIPELINED_PHYSICS true
+
+/// @brief Smallest distance particles keep from each other; 0 lets them pass through each other.
+#define SELF_COLLISION_DISTANCE 0
+
+/// @brief Fraction of shear (diagonal) stretch corrected per solver pass; 0 lets the cloth shear freely.
+#define SHEAR_STIFFNESS 0.5f
+
+/// @brief Fraction of bending (folding) corrected per solver pass; 0 lets the cloth fold freely.
+#define BENDING_STIFFNESS 0.2f
+
+/// @brief Solve with XPBD compliances instead of per-pass stiffness, so the material keeps its feel at any PHYSICS_RATE or pass count.
+#define XPBD_SOLVER false
+
+/// @brief XPBD compliance of the threads (inverse stiffness); 0 keeps them inextensible.
+#define STRUCTURAL_COMPLIANCE 0.f
+
+/// @brief XPBD compliances of shear and bending links; these match the stiffness defaults at 60 steps per second.
+#define SHEAR_COMPLIANCE 0.00056f
+#define BENDING_COMPLIANCE 0.0022f
+
+/// @brief Advance the cloth with a backward Euler step and stiff springs instead of Verlet and position passes.
+#define IMPLICIT_INTEGRATOR false
+
+/// @brief Stiffness of the threads' springs under IMPLICIT_INTEGRATOR (per unit mass, 1/s^2).
+#define SPRING_STIFFNESS 20000.f
+
+/// @brief Coarse grid levels solved each step to remove long-range stretch; worth it for tall cloths, 0 disables.
+#define MULTIGRID_LEVELS 0
+
+/// @brief Speed (pixels per step) below which resting pieces of cloth stop being simulated until touched; 0 disables sleeping.
+#define SLEEP_SPEED 0.01f
+
+/// @brief Checkpoint file saved with F5 and resumed from on startup, if present.
+#define CHECKPOINT_FILE "cloth_checkpoint.bin"
+
+/// @brief Trajectory file recorded with F6 and played back with F7.
+#define TRAJECTORY_FILE "cloth_trajectory.bin"
+
+/// @brief Step exactly once per frame and log every step's input and state hash, so a session can be replayed headless.
+#define DETERMINISTIC_MODE false
+
+/// @brief Checkpoint of the state a deterministic session starts from.
+#define INPUT_START_FILE "cloth_input_start.bin"
+
+/// @brief Input of every step of a deterministic session (see InputLog).
+#define INPUT_LOG_FILE "cloth_input.bin"
+
+/// @brief State hash of every step of a deterministic session, one "step hash" line each.
+#define HASH_LOG_FILE "cloth_hashes.txt"
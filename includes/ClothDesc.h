@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @enum PinMode
+ * @brief Which particles of a cloth are fixed in space.
+ */
+enum class PinMode : std::uint32_t
+{
+    /// @brief Every second particle of the top row (the classic hanging cloth).
+    TopAlternate,
+
+    /// @brief The whole top row.
+    Top,
+
+    /// @brief The two top corners.
+    Corners,
+
+    /// @brief The whole left column, like a flag on a pole.
+    Left,
+
+    /// @brief Nothing; the cloth falls freely.
+    None
+};
+
+/**
+ * @struct ClothDesc
+ * @brief Size, placement and physical parameters of one rectangular cloth.
+ *
+ * A Cloth can hold many of these side by side in shared storage (see Cloth's
+ * constructor taking a list of descriptions and ClothScene).
+ */
+struct ClothDesc
+{
+    /// @brief Number of particle intervals horizontally (the cloth has widthCount + 1 columns).
+    int widthCount = 0;
+
+    /// @brief Number of particle intervals vertically (the cloth has heightCount + 1 rows).
+    int heightCount = 0;
+
+    /// @brief Distance between neighbouring particles.
+    float gap = 10.f;
+
+    /// @brief Position of the top-left particle.
+    float startX = 0.f;
+    float startY = 0.f;
+
+    /// @brief Downward acceleration applied to the cloth.
+    float gravity = 9.81f;
+
+    /// @brief Air resistance factor damping particle movement.
+    float drag = 0.01f;
+
+    /// @brief Largest distance the cursor drags a particle in one step.
+    float elasticity = 10.f;
+
+    /// @brief Which particles are fixed in space.
+    PinMode pin = PinMode::TopAlternate;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SFML/System/Vector2.hpp"
+
+/**
+ * @struct ClothInput
+ * @brief Pointer state handed to the cloth solver for one simulation step.
+ *
+ * Sampled by the application (or synthesized by a headless driver) so that the
+ * simulation core never has to query a window or the input system itself.
+ */
+struct ClothInput
+{
+    /**
+     * @brief Current cursor position in simulation coordinates.
+     */
+    sf::Vector2i mousePos{0, 0};
+
+    /**
+     * @brief Cursor position at the previous step (used for dragging).
+     */
+    sf::Vector2i lastMousePos{0, 0};
+
+    /**
+     * @brief Radius of the circular interaction area around the cursor.
+     */
+    float cursorSize = 0.f;
+
+    /**
+     * @brief Whether the drag button (left mouse) is held.
+     */
+    bool isDragging = false;
+
+    /**
+     * @brief Whether the cut button (right mouse) is held.
+     */
+    bool isCutting = false;
+
+    /**
+     * @brief Whether the pin button (middle mouse) is held.
+     */
+    bool isPinning = false;
+};
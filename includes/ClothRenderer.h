@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Cloth.h"
+#include "ClothSnapshot.h"
+#include "SFML/Graphics.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ClothRenderer
+ * @brief Draws a Cloth into an SFML render window.
+ *
+ * Lives in the viewer so that the simulation core has no dependency on SFML's
+ * graphics or window modules. Keeps one persistent line mesh (two vertices per
+ * structural constraint) in a GPU vertex buffer and each frame uploads only the range of
+ * vertices that actually changed.
+ */
+class ClothRenderer
+{
+private:
+    /**
+     * @brief CPU copy of the line mesh; vertex 2c and 2c + 1 belong to constraint c.
+     */
+    std::vector<sf::Vertex> m_vertices;
+
+    /**
+     * @brief GPU copy of the line mesh.
+     */
+    sf::VertexBuffer m_vertexBuffer{sf::PrimitiveType::Lines, sf::VertexBuffer::Usage::Stream};
+
+    /**
+     * @brief Whether vertex buffers are supported; otherwise m_vertices is drawn directly.
+     */
+    bool m_useVertexBuffer = false;
+
+    /**
+     * @brief Active/selected state each constraint's colour was last written for.
+     */
+    std::vector<std::uint8_t> m_constraintStates;
+
+    /**
+     * @brief Outlines of the static colliders as line segments, built once by SetColliders.
+     */
+    std::vector<sf::Vertex> m_colliderVertices;
+
+    /**
+     * @brief Updates the mesh from particle positions and constraint states, then draws it.
+     *
+     * @param constraints Constraint endpoints.
+     * @param states ConstraintStateFlags per constraint, or nullptr to read them from the constraints.
+     */
+    void Draw(const std::vector<Constraint>& constraints, const std::uint8_t* states,
+              const float* x, const float* y, const float* previousX, const float* previousY,
+              sf::RenderWindow& win, float alpha);
+
+public:
+    /**
+     * @brief Default constructor.
+     */
+    ClothRenderer() = default;
+
+    /**
+     * @brief Default destructor.
+     */
+    ~ClothRenderer() = default;
+
+    /**
+     * @brief Allocates the mesh for a cloth.
+     *
+     * Called automatically when the cloth's structural constraint count changes.
+     *
+     * @param cloth The cloth that will be drawn.
+     */
+    void Reset(const Cloth& cloth);
+
+    /**
+     * @brief Allocates the mesh for a number of constraints.
+     *
+     * @param constraintCount Number of lines that will be drawn.
+     */
+    void Reset(std::size_t constraintCount);
+
+    /**
+     * @brief Builds the outlines of static colliders.
+     *
+     * @param colliders Colliders to outline; they are drawn by RenderColliders until replaced.
+     */
+    void SetColliders(const std::vector<Collider>& colliders);
+
+    /**
+     * @brief Draws the collider outlines built by SetColliders.
+     *
+     * @param win Reference to the SFML render window.
+     */
+    void RenderColliders(sf::RenderWindow& win);
+
+    /**
+     * @brief Renders the cloth on the SFML window.
+     *
+     * Draws every active structural constraint as a line, highlighting selected ones.
+     * Particle positions are blended between the previous and the current
+     * physics step.
+     *
+     * @param cloth The cloth to draw.
+     * @param win Reference to the SFML render window.
+     * @param alpha Interpolation factor: 0 draws the previous step, 1 the current one.
+     */
+    void RenderCloth(const Cloth& cloth, sf::RenderWindow& win, float alpha);
+
+    /**
+     * @brief Renders a snapshot of the cloth taken by another thread.
+     *
+     * @param snapshot Positions and constraint states to draw.
+     * @param cloth The cloth the snapshot was taken from (only its constraint endpoints are read).
+     * @param win Reference to the SFML render window.
+     * @param alpha Interpolation factor: 0 draws the start of the step, 1 its end.
+     */
+    void RenderSnapshot(const ClothSnapshot& snapshot, const Cloth& cloth, sf::RenderWindow& win, float alpha);
+
+    /**
+     * @brief Renders a snapshot against explicit constraint endpoints, e.g. a recorded trajectory.
+     *
+     * @param snapshot Positions and constraint states to draw.
+     * @param constraints Constraint endpoints; the first one per entry of the snapshot's constraint states is drawn.
+     * @param win Reference to the SFML render window.
+     * @param alpha Interpolation factor: 0 draws the start of the step, 1 its end.
+     */
+    void RenderSnapshot(const ClothSnapshot& snapshot, const std::vector<Constraint>& constraints, sf::RenderWindow& win, float alpha);
+};
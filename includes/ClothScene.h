@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ClothDesc.h"
+#include "Collider.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @class ClothScene
+ * @brief Reads cloth descriptions and static colliders from a text scene file.
+ *
+ * One directive per line; '#' starts a comment. Each line is a keyword
+ * followed by key=value pairs:
+ *
+ *     defaults gap=4 pin=left gravity=9.81
+ *     cloth x=20 y=40 width=12 height=8
+ *     cloth x=80 y=40 width=12 height=8 drag=0.02
+ *     circle x=60 y=200 r=30
+ *
+ * "cloth" adds a cloth; keys it omits come from the latest "defaults" line.
+ * Keys: width, height (particle intervals), gap, x, y (top-left particle),
+ * gravity, drag, elasticity, and pin (top-alternate, top, corners, left, none).
+ *
+ * "circle x= y= r=", "box x0= y0= x1= y1=" and "capsule x0= y0= x1= y1= r="
+ * add static colliders the particles are kept out of.
+ */
+class ClothScene
+{
+public:
+    /**
+     * @brief Parses a scene file.
+     *
+     * Errors are reported on std::cerr with the file name and line number.
+     *
+     * @param path File to read.
+     * @param cloths Receives the descriptions, in file order (cleared first).
+     * @param colliders Receives the colliders, in file order (cleared first).
+     * @return False if the file could not be read or contains an error.
+     */
+    static bool Load(const std::string& path, std::vector<ClothDesc>& cloths, std::vector<Collider>& colliders);
+};
@@ -2,33 +2,18 @@
 
 #include "Core.h"
 #include "Cloth.h"
-
-/// @brief Width of the application window in pixels.
-#define WIN_WIDTH 400
-
-/// @brief Height of the application window in pixels.
-#define WIN_HEIGHT 350
-
-/// @brief Width of the cloth mesh in simulation units.
-#define CLOTH_WIDTH 240
-
-/// @brief Height of the cloth mesh in simulation units.
-#define CLOTH_HEIGHT 190
-
-/// @brief Spacing (gap) between particles in the cloth mesh.
-#define CLOTH_GAPPING 10
-
-/// @brief Downward accleration due to gravity applied on the cloth
-#define GRAVITY 9.81
-
-/// @brief Air resistance or damping applied to particle motion.
-#define DRAG 0.01
-
-/// @brief Strength of the constraint forces keeping particles together.
-#define ELASTICITY 10
-
-/// @brief Radius of circular input that is used for interacting with cloth.
-#define CURSOR_SIZE 20
+#include "ClothConfig.h"
+#include "ClothRenderer.h"
+#include "ClothSnapshot.h"
+#include "InputLog.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TrajectoryReader.h"
+#include "TrajectoryWriter.h"
+#include "TripleBuffer.h"
+
+#include <fstream>
+#include <memory>
 
 /**
  * @class ClothSimulation
@@ -42,23 +27,125 @@ class ClothSimulation : public Core
 {
 private:
     /**
-     * @brief Current mouse position on the window.
+     * @brief Pointer state sampled from the window once per frame (render thread).
+     */
+    ClothInput m_input;
+
+    /**
+     * @brief Carries the latest sampled input from Update to FixedUpdate, which may run on another thread.
      *
-     * Used for interaction with the cloth (e.g., dragging particles).
+     * Only the newest sample matters to a step, so a new one replaces any the
+     * physics thread has not picked up yet instead of queueing behind it.
      */
-    sf::Vector2i m_mousePos{0, 0};
+    TripleBuffer<ClothInput> m_latestInput;
 
     /**
-     * @brief Previous frame's mouse position.
+     * @brief Pointer state handed to the cloth on every physics step (physics thread).
      *
-     * Useful for computing mouse drag delta.
+     * The previous position is the one seen by the last physics step, so the
+     * drag delta is consumed exactly once however many steps run per frame.
+     */
+    ClothInput m_physicsInput;
+
+    /**
+     * @brief Latest drawable cloth state, published by the physics thread in pipelined mode.
+     */
+    TripleBuffer<ClothSnapshot> m_snapshots;
+
+    /**
+     * @brief Number of physics steps simulated so far.
+     */
+    std::uint64_t m_stepCount = 0;
+
+    /**
+     * @brief The cloths being simulated; owned by value and reset in place.
+     */
+    Cloth m_cloth;
+
+    /**
+     * @brief Machine-sized pool the cloth solves on and the step graph runs on.
+     */
+    std::shared_ptr<ThreadPool> m_threadPool;
+
+    /**
+     * @brief One physics step: the cloth's solver phases, then hashing, recording and the render snapshot side by side.
+     */
+    TaskGraph m_stepGraph;
+
+    /**
+     * @brief Time step the step graph reads (physics thread).
+     */
+    float m_stepDeltaTime = 0.f;
+
+    /**
+     * @brief Draws the cloth constraints into the window.
+     */
+    ClothRenderer m_renderer;
+
+    /**
+     * @brief Scene file to build the cloths from; empty for the default cloth.
+     */
+    std::string m_scenePath;
+
+    /**
+     * @brief Set by the render thread (F5); the next physics step saves a checkpoint.
      */
-    sf::Vector2i m_mouseLastPos{0, 0};
+    std::atomic<bool> m_isSaveRequested{false};
 
     /**
-     * @brief Pointer to the main cloth object being simulated.
+     * @brief Set by the render thread (F8); the next physics step resets the cloths first.
      */
-    Cloth* m_cloth = nullptr;
+    std::atomic<bool> m_isResetRequested{false};
+
+    /**
+     * @brief Set by the render thread (F6); the physics thread starts or stops recording to match.
+     */
+    std::atomic<bool> m_isRecordRequested{false};
+
+    /**
+     * @brief Streams every physics step to TRAJECTORY_FILE while recording (physics thread).
+     */
+    TrajectoryWriter m_recorder;
+
+    /**
+     * @brief Mirrors m_recorder.IsOpen() for the render thread.
+     */
+    std::atomic<bool> m_isRecording{false};
+
+    /**
+     * @brief Whether a recording is being played back instead of simulating (F7).
+     */
+    std::atomic<bool> m_isPlaying{false};
+
+    /**
+     * @brief Source of the frames shown during playback (render thread).
+     */
+    TrajectoryReader m_player;
+
+    /**
+     * @brief Last two decoded playback frames, drawn like a live snapshot.
+     */
+    ClothSnapshot m_playbackFrame;
+
+    /**
+     * @brief Playback time not yet advanced into a frame (in seconds).
+     */
+    float m_playbackTime = 0.f;
+
+    /**
+     * @brief Input of every step of a lockstep session, written to INPUT_LOG_FILE.
+     */
+    InputLogWriter m_inputLog;
+
+    /**
+     * @brief State hash of every step of a lockstep session, written to HASH_LOG_FILE.
+     */
+    std::ofstream m_hashLog;
+
+    /**
+     * @brief Starts or stops playback of TRAJECTORY_FILE.
+     */
+    void TogglePlayback();
 
 protected:
     /**
@@ -84,12 +171,28 @@ protected:
 
     /**
      * @brief Called once per frame to render the cloth and other visuals.
+     *
+     * @param alpha Interpolation factor between the previous and current physics step.
      */
-    void Render() override;
+    void Render(float alpha) override;
+
+    /**
+     * @brief Handles the simulation's hotkeys.
+     *
+     * F5 saves a checkpoint, F6 starts or stops recording, F7 starts or stops playback,
+     * F8 resets the cloths.
+     *
+     * @param key The key that was pressed.
+     */
+    void OnKeyPressed(sf::Keyboard::Key key) override;
 
 public:
     /**
-     * @brief Destructor to clean up cloth simulation resources.
+     * @brief Builds the cloths from a scene file (see ClothScene) instead of the default cloth.
+     *
+     * Must be called before Run.
+     *
+     * @param path Scene file to load.
      */
-    ~ClothSimulation();
+    void SetScenePath(const std::string& path);
 };
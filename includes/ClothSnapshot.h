@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Cloth.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Per-constraint state bits stored in ClothSnapshot::constraintStates.
+ */
+enum ConstraintStateFlags : std::uint8_t
+{
+    /// @brief Constraint has not been cut.
+    CONSTRAINT_STATE_ACTIVE = 1 << 0,
+
+    /// @brief Constraint is under the cursor.
+    CONSTRAINT_STATE_SELECTED = 1 << 1,
+};
+
+/**
+ * @struct ClothSnapshot
+ * @brief Copy of everything needed to draw a cloth after one physics step.
+ *
+ * Filled by the physics thread and read by the render thread, so the renderer
+ * never touches state the solver is writing. Constraint endpoints are not
+ * copied: they never change after the cloth is built.
+ */
+struct ClothSnapshot
+{
+    /**
+     * @brief Particle positions at the end of the step.
+     */
+    std::vector<float> x, y;
+
+    /**
+     * @brief Particle positions at the start of the step (for interpolation).
+     */
+    std::vector<float> previousX, previousY;
+
+    /**
+     * @brief ConstraintStateFlags for each structural constraint (the leading ones of the cloth).
+     */
+    std::vector<std::uint8_t> constraintStates;
+
+    /**
+     * @brief Number of steps simulated when the snapshot was taken (0 = empty snapshot).
+     */
+    std::uint64_t step = 0;
+
+    /**
+     * @brief Copies the drawable state of a cloth into the snapshot, reusing its storage.
+     *
+     * @param cloth The cloth to copy from.
+     * @param stepIndex Step counter to record.
+     */
+    void Capture(const Cloth& cloth, std::uint64_t stepIndex);
+};
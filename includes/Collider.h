@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @enum ColliderShape
+ * @brief Geometry of a static collider.
+ */
+enum class ColliderShape : std::uint32_t
+{
+    /// @brief Disc of radius around (x0, y0).
+    Circle,
+
+    /// @brief Axis-aligned rectangle from (x0, y0) to (x1, y1).
+    Box,
+
+    /// @brief Segment from (x0, y0) to (x1, y1), thickened by radius.
+    Capsule
+};
+
+/**
+ * @struct Collider
+ * @brief A static obstacle particles are pushed out of.
+ */
+struct Collider
+{
+    ColliderShape shape = ColliderShape::Circle;
+
+    /// @brief First point: circle center, box minimum corner or capsule start.
+    float x0 = 0.f;
+    float y0 = 0.f;
+
+    /// @brief Second point: box maximum corner or capsule end (unused for circles).
+    float x1 = 0.f;
+    float y1 = 0.f;
+
+    /// @brief Radius of circles and capsules (unused for boxes).
+    float radius = 0.f;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Collider.h"
+#include "ParticleBuffer.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ColliderSet
+ * @brief Static colliders indexed by a bounding volume hierarchy.
+ *
+ * The hierarchy is a flat array of nodes built once by Build. Particles are
+ * resolved in small contiguous batches: the batch's bounding box is looked up
+ * in the hierarchy once, and each candidate collider is then tested against
+ * the whole batch in a tight loop. Thousands of props therefore cost little
+ * more than the few near each batch.
+ */
+class ColliderSet
+{
+private:
+    /**
+     * @brief Hierarchy node; leaves list colliders, inner nodes have two children.
+     *
+     * The left child directly follows its parent; for inner nodes, first is the
+     * index of the right child. For leaves, first indexes m_order and count > 0.
+     */
+    struct Node
+    {
+        float minX, minY, maxX, maxY;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    /// @brief Axis-aligned box.
+    struct Bounds
+    {
+        float minX, minY, maxX, maxY;
+    };
+
+    /// @brief Largest number of colliders in a leaf.
+    static constexpr std::uint32_t LEAF_SIZE = 4;
+
+    /**
+     * @brief All colliders, in the order they were added.
+     */
+    std::vector<Collider> m_colliders;
+
+    /**
+     * @brief Collider indices grouped by leaf.
+     */
+    std::vector<std::uint32_t> m_order;
+
+    /**
+     * @brief Bounds of the colliders in m_order's order, so leaves are tested without touching the colliders.
+     */
+    std::vector<Bounds> m_orderBounds;
+
+    /**
+     * @brief Flattened hierarchy; node 0 is the root.
+     */
+    std::vector<Node> m_nodes;
+
+    /**
+     * @brief Candidate colliders of each batch, one list per parallel chunk.
+     */
+    std::vector<std::vector<std::uint32_t>> m_chunkCandidates;
+
+    /**
+     * @brief Builds the subtree over m_order[begin, end) and returns its node index.
+     */
+    std::uint32_t BuildNode(std::uint32_t begin, std::uint32_t end, const std::vector<float>& centerX, const std::vector<float>& centerY);
+
+public:
+    /**
+     * @brief Removes all colliders.
+     */
+    void Clear();
+
+    /**
+     * @brief Adds a collider; call Build before the next Resolve.
+     */
+    void Add(const Collider& collider);
+
+    /**
+     * @brief Rebuilds the hierarchy over all colliders.
+     */
+    void Build();
+
+    /**
+     * @brief Collects the colliders whose bounds overlap a box, in a fixed order.
+     *
+     * @param result Receives collider indices (cleared first).
+     */
+    void Query(float minX, float minY, float maxX, float maxY, std::vector<std::uint32_t>& result) const;
+
+    /**
+     * @brief Moves every active, unpinned and awake particle that is inside a collider onto its surface.
+     *
+     * Boxes are left through the side the particle was outside of at the start of the step.
+     *
+     * @param particles Particles to resolve.
+     * @param threadPool Threads sharing the particle batches.
+     */
+    void Resolve(ParticleBuffer& particles, ThreadPool& threadPool);
+
+    /**
+     * @brief Returns all colliders, in the order they were added.
+     */
+    const std::vector<Collider>& GetColliders() const;
+
+    /**
+     * @brief Returns whether there are no colliders.
+     */
+    bool IsEmpty() const;
+};
@@ -1,9 +1,47 @@
 #pragma once
 
 #include <cmath>
-#include "SFML/Graphics/RenderWindow.hpp"
+#include <cstdint>
+#include "ParticleBuffer.h"
 
-class Particle;
+/**
+ * @enum ConstraintType
+ * @brief Role of a constraint in the cloth's grid.
+ */
+enum class ConstraintType : std::uint8_t
+{
+    /// @brief Link to a horizontal or vertical neighbour; always fully enforced.
+    Structural,
+
+    /// @brief Link to a diagonal neighbour; resists shearing with the solver's shear stiffness.
+    Shear,
+
+    /// @brief Link skipping one particle; resists folding with the solver's bending stiffness.
+    Bending,
+
+    /// @brief Coarse multigrid link spanning several structural links; only pulls together.
+    /// Lives in ConstraintHierarchy, never in the cloth's constraint list.
+    Tether
+};
+
+/**
+ * @struct ConstraintBatch
+ * @brief Contiguous range of constraints that share no particles.
+ *
+ * Constraints in one batch (one graph color) can be solved in any order, or in
+ * parallel, with the same result. All constraints of a batch have the same type.
+ */
+struct ConstraintBatch
+{
+    /// @brief Index of the first constraint in the batch.
+    std::uint32_t begin = 0;
+
+    /// @brief One past the index of the last constraint in the batch.
+    std::uint32_t end = 0;
+
+    /// @brief Type of every constraint in the batch.
+    ConstraintType type = ConstraintType::Structural;
+};
 
 /**
  * @class Constraint
@@ -30,25 +68,31 @@ private:
      */
     bool m_isActive = true;
 
+    /**
+     * @brief Role of the constraint; decides which kernel and stiffness solve it.
+     */
+    ConstraintType m_type = ConstraintType::Structural;
+
 public:
     /**
-     * @brief Reference to the first particle connected by this constraint.
+     * @brief Index of the first particle connected by this constraint.
      */
-    Particle& p_1;
+    std::uint32_t p_1;
 
     /**
-     * @brief Reference to the second particle connected by this constraint.
+     * @brief Index of the second particle connected by this constraint.
      */
-    Particle& p_2;
+    std::uint32_t p_2;
 
     /**
      * @brief Constructs a constraint between two particles with a specific rest length.
      *
-     * @param primary_particle Reference to the first particle.
-     * @param secondary_particle Reference to the second particle.
+     * @param primary_particle Index of the first particle.
+     * @param secondary_particle Index of the second particle.
      * @param length The rest length of the constraint (desired distance between particles).
+     * @param type Role of the constraint in the grid.
      */
-    Constraint(Particle& primary_particle, Particle& secondary_particle, float length);
+    Constraint(std::uint32_t primary_particle, std::uint32_t secondary_particle, float length, ConstraintType type = ConstraintType::Structural);
 
     /**
      * @brief Default destructor.
@@ -65,26 +109,45 @@ public:
     /**
      * @brief Updates the constraint, restoring the correct distance between particles.
      *
-     * Moves both particles to enforce the rest length, unless one is pinned or inactive.
+     * Moves both particles to enforce the rest length, unless the constraint is inactive.
+     * Scalar reference of a structural constraint; the solver uses ConstraintKernel.
+     *
+     * @param particles Particle storage the constraint's indices refer to.
+     * @return Violation before the correction, relative to the rest length (0 if inactive).
      */
-    void Update();
+    float Update(ParticleBuffer& particles);
 
     /**
      * @brief Disables the constraint and marks it as inactive.
      */
     void DestroyConstraint();
 
+    /**
+     * @brief Reactivates a destroyed constraint and clears its selection.
+     */
+    void RestoreConstraint();
+
     /**
      * @brief Returns whether the constraint is still active in the simulation.
      *
      * @return True if active, false if destroyed.
      */
-    bool IsActive();
+    bool IsActive() const { return m_isActive; }
 
     /**
      * @brief Returns whether the constraint is currently selected.
      *
      * @return True if selected, false otherwise.
      */
-    bool IsSelected();
+    bool IsSelected() const;
+
+    /**
+     * @brief Returns the rest length of the constraint.
+     */
+    float GetLength() const { return m_length; }
+
+    /**
+     * @brief Returns the role of the constraint in the grid.
+     */
+    ConstraintType GetType() const { return m_type; }
 };
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "ClothDesc.h"
+#include "Constraint.h"
+#include "ParticleBuffer.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ConstraintHierarchy
+ * @brief Coarse grids of the cloth lattice that carry stretch corrections over long distances.
+ *
+ * A single Gauss-Seidel pass moves a correction about one particle, so a tall
+ * cloth needs hundreds of steps to stop sagging. Level l of the hierarchy keeps
+ * every 2^l-th particle of each row and column and links neighbours with a tether
+ * as long as the 2^l structural links it spans. Tethers only pull, so a folded
+ * cloth is left alone; a tether is destroyed when any link it spans is torn.
+ *
+ * Solve works from the coarsest level down. After a level's tethers are solved,
+ * the displacement of its particles is interpolated onto the particles the next
+ * finer level adds: midpoints of intact tethers take the mean of both ends, cell
+ * centres the mean of all four corners. The fine passes that follow only have
+ * local error left to remove.
+ *
+ * Coarse particles are ordinary cloth particles, so no state is restricted or
+ * copied back. Tethers of one level are colored like the structural batches and
+ * every particle is written once per phase, so results do not depend on the
+ * thread count.
+ */
+class ConstraintHierarchy
+{
+public:
+    /**
+     * @brief Largest number of coarse levels (the coarsest keeps every 256th particle).
+     */
+    static constexpr int MAX_LEVELS = 8;
+
+private:
+    /**
+     * @brief A finer-level particle and the coarse corners it is interpolated from.
+     *
+     * Midpoints list their two corners twice, so every entry averages four.
+     */
+    struct Prolongation
+    {
+        std::uint32_t particle;
+        std::uint32_t corners[4];
+    };
+
+    /**
+     * @brief Tether batches and prolongations of one level.
+     */
+    struct Level
+    {
+        std::uint32_t batchBegin = 0;
+        std::uint32_t batchEnd = 0;
+        std::uint32_t prolongationBegin = 0;
+        std::uint32_t prolongationEnd = 0;
+    };
+
+    /**
+     * @brief Tethers of all levels, finest level first.
+     */
+    std::vector<Constraint> m_tethers;
+
+    /**
+     * @brief The two links each tether spans: structural constraints on level 1, tethers of the level below otherwise.
+     */
+    std::vector<std::uint32_t> m_tetherChildren;
+
+    /**
+     * @brief Independent tether ranges, four per level.
+     */
+    std::vector<ConstraintBatch> m_batches;
+
+    /**
+     * @brief Interpolation entries of all levels, finest level first.
+     */
+    std::vector<Prolongation> m_prolongations;
+
+    /**
+     * @brief Tethers each prolongation lies on or between, four per entry (repeated for midpoints).
+     */
+    std::vector<std::uint32_t> m_prolongationTethers;
+
+    /**
+     * @brief Whether all of an entry's tethers are intact, updated by Refresh.
+     *
+     * A torn tether would drag one side of the cut along with the other.
+     */
+    std::vector<std::uint8_t> m_isProlongationIntact;
+
+    /**
+     * @brief Ranges of m_batches and m_prolongations per level; index 0 is level 1.
+     */
+    std::vector<Level> m_levels;
+
+    /**
+     * @brief Horizontal and vertical link starting at each particle on the level being built.
+     */
+    std::vector<std::uint32_t> m_linkOfParticle;
+
+    /**
+     * @brief Particle positions before the coarsest level was solved.
+     */
+    std::vector<float> m_startX, m_startY;
+
+public:
+    /**
+     * @brief Builds the coarse levels of every cloth's grid.
+     *
+     * Storage is reused, so rebuilding a hierarchy of the same size allocates nothing.
+     *
+     * @param cloths Size and spacing of each cloth.
+     * @param clothParticleBegin First particle of each cloth, plus the total particle count.
+     * @param particleConstraints Horizontal and vertical structural constraint of each particle (see Cloth).
+     * @param levelCount Number of coarse levels; 0 leaves the hierarchy empty.
+     */
+    void Build(const std::vector<ClothDesc>& cloths, const std::vector<std::uint32_t>& clothParticleBegin,
+               const std::vector<std::uint32_t>& particleConstraints, int levelCount);
+
+    /**
+     * @brief Destroys tethers spanning torn links or sleeping particles and restores all others.
+     *
+     * @param constraints The cloth's constraints, which level 1 refers to.
+     * @param particles Particle storage; tethers of sleeping islands are left out.
+     */
+    void Refresh(const std::vector<Constraint>& constraints, const ParticleBuffer& particles);
+
+    /**
+     * @brief Solves every level once, coarsest first, and interpolates the corrections down.
+     *
+     * @param particles Particle storage the hierarchy was built for.
+     * @param threadPool Threads sharing the tether batches and the interpolation.
+     * @param isReference True to solve tethers with the scalar reference loop.
+     */
+    void Solve(ParticleBuffer& particles, ThreadPool& threadPool, bool isReference);
+
+    /**
+     * @brief Returns whether there are no tethers to solve.
+     */
+    bool IsEmpty() const { return m_tethers.empty(); }
+
+    /**
+     * @brief Returns the number of coarse levels built.
+     */
+    int GetLevelCount() const { return static_cast<int>(m_levels.size()); }
+
+    /**
+     * @brief Returns the tethers of all levels, finest level first.
+     */
+    const std::vector<Constraint>& GetTethers() const { return m_tethers; }
+};
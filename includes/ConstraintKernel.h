@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Constraint.h"
+#include "ParticleBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct ConstraintResidual
+ * @brief Violation statistics of a range of structural constraints.
+ */
+struct ConstraintResidual
+{
+    float maxViolation = 0.f;
+    float sumSquares = 0.f;
+    std::uint32_t activeCount = 0;
+};
+
+/**
+ * @class ConstraintKernel
+ * @brief Vectorized solvers for one batch of constraints of a single type.
+ *
+ * Constraints in a batch share no particles, so four of them are solved per
+ * instruction. When the four step through consecutive particles, as vertical
+ * links do, endpoints are loaded and stored as whole vectors; otherwise they
+ * are gathered and scattered lane by lane. Each type has its own kernel:
+ *
+ * - Structural constraints are fully enforced and measured for the residual.
+ * - Shear constraints move the particles a stiffness fraction of the way.
+ * - Bending constraints do the same, but only push apart, so they resist
+ *   folding without stiffening the cloth against stretch.
+ * - Tethers are fully enforced, but only pull together, so a coarse link
+ *   never pushes apart the fine links it spans when they fold.
+ *
+ * Targets without SSE2 use the scalar loop. Both produce bit-identical
+ * results, and structural constraints match Constraint::Update exactly.
+ *
+ * SolveCompliant is the XPBD counterpart: every constraint has a compliance
+ * and a Lagrange multiplier accumulated over the passes of a step. Bending
+ * links and tethers keep their one-sided behavior by clamping the multiplier.
+ */
+class ConstraintKernel
+{
+public:
+    /**
+     * @brief Solves constraints [begin, end) of one batch once.
+     *
+     * @param type Type of every constraint in the range.
+     * @param constraints All constraints of the cloth.
+     * @param particles Particle storage the constraints' indices refer to.
+     * @param stiffness Fraction of the correction applied (ignored for structural constraints and tethers).
+     * @param residual Receives the violations of structural constraints; may be nullptr.
+     */
+    static void Solve(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                      ParticleBuffer& particles, float stiffness, ConstraintResidual* residual);
+
+    /**
+     * @brief Same as Solve, but always uses the scalar reference loop.
+     */
+    static void SolveScalar(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                            ParticleBuffer& particles, float stiffness, ConstraintResidual* residual);
+
+    /**
+     * @brief Solves constraints [begin, end) of one batch once with the XPBD update.
+     *
+     * Structural violations are measured as |C + alpha * lambda| relative to the
+     * rest length, which goes to zero as the step converges even for compliant links.
+     *
+     * @param type Type of every constraint in the range.
+     * @param constraints All constraints of the cloth.
+     * @param particles Particle storage the constraints' indices refer to.
+     * @param alpha Compliance divided by the squared time step.
+     * @param lambdas Multiplier of every constraint of the cloth, zeroed at the start of the step.
+     * @param residual Receives the violations of structural constraints; may be nullptr.
+     */
+    static void SolveCompliant(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                               ParticleBuffer& particles, float alpha, float* lambdas, ConstraintResidual* residual);
+
+    /**
+     * @brief Same as SolveCompliant, but always uses the scalar reference loop.
+     */
+    static void SolveCompliantScalar(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                                     ParticleBuffer& particles, float alpha, float* lambdas, ConstraintResidual* residual);
+
+    /**
+     * @brief Returns the name of the kernel selected at compile time ("SSE2" or "Scalar").
+     */
+    static const char* GetKernelName();
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include "SFML/Graphics.hpp"
 
 
@@ -22,6 +24,45 @@ private:
      */
     int m_frameRate = 60;
 
+    /**
+     * @brief Number of fixed physics steps per simulated second.
+     */
+    int m_physicsRate = 60;
+
+    /**
+     * @brief Upper bound on physics steps per rendered frame.
+     *
+     * When a frame takes too long, the missed simulation time beyond this many
+     * steps is dropped instead of being caught up, so one slow frame cannot
+     * snowball into ever longer frames.
+     */
+    int m_maxSubsteps = 5;
+
+    /**
+     * @brief Whether FixedUpdate runs on its own thread, overlapping with Update and Render.
+     */
+    bool m_isPipelined = false;
+
+    /**
+     * @brief Whether every frame runs exactly one fixed step, regardless of elapsed time.
+     */
+    bool m_isLockstep = false;
+
+    /**
+     * @brief Thread running the physics loop in pipelined mode.
+     */
+    std::thread m_physicsThread;
+
+    /**
+     * @brief Keeps the physics thread running; cleared when the window closes.
+     */
+    std::atomic<bool> m_isPhysicsRunning{false};
+
+    /**
+     * @brief Physics loop of the pipelined mode: calls FixedUpdate at the physics rate.
+     */
+    void PhysicsLoop();
+
 protected:
     /**
      * @brief Called once before the main loop begins.
@@ -33,7 +74,10 @@ protected:
     /**
      * @brief Called at fixed time intervals, independent of frame rate.
      *
-     * Ideal for physics updates or time-consistent logic.
+     * Ideal for physics updates or time-consistent logic. Runs zero or more
+     * times per frame, as many as the elapsed real time requires. In pipelined
+     * mode it is called from the physics thread instead, concurrently with
+     * Update and Render.
      *
      * @param fixedDeltaTime The fixed time step duration (in seconds).
      */
@@ -51,9 +95,23 @@ protected:
     /**
      * @brief Called once per frame to render visual output.
      *
-     * Called after Update and before the next frame is displayed.
+     * Called after Update and the fixed steps, before the frame is displayed.
+     *
+     * @param alpha How far real time has advanced past the last fixed step, as a
+     *              fraction of the fixed step (0 to 1). Used to interpolate
+     *              between the previous and the current physics state. Always 1
+     *              in pipelined and lockstep mode, where the latest state is drawn.
+     */
+    virtual void Render(float alpha) = 0;
+
+    /**
+     * @brief Called from the event loop when a key is pressed.
+     *
+     * F1, F2 and Escape are handled by Core before this is called.
+     *
+     * @param key The key that was pressed.
      */
-    virtual void Render() = 0;
+    virtual void OnKeyPressed(sf::Keyboard::Key /*key*/) {}
 
 public:
     /**
@@ -106,4 +164,50 @@ public:
      * @param frameRate The desired frame rate (frames per second).
      */
     void SetFrameRate(int frameRate);
+
+    /**
+     * @brief Sets how many fixed physics steps run per simulated second.
+     *
+     * @param physicsRate Physics steps per second (e.g. 240 to step four times per 60 Hz frame).
+     */
+    void SetPhysicsRate(int physicsRate);
+
+    /**
+     * @brief Sets the maximum number of physics steps run in a single frame.
+     *
+     * @param maxSubsteps Step cap per frame; time beyond it is dropped.
+     */
+    void SetMaxSubsteps(int maxSubsteps);
+
+    /**
+     * @brief Runs FixedUpdate on a dedicated physics thread.
+     *
+     * Must be called before Run. The inheriting class is then responsible for
+     * handing data between FixedUpdate and Update/Render safely.
+     *
+     * @param pipelined True to overlap physics with input handling and rendering.
+     */
+    void SetPipelined(bool pipelined);
+
+    /**
+     * @brief Returns whether FixedUpdate runs on the physics thread.
+     */
+    bool IsPipelined() const;
+
+    /**
+     * @brief Runs exactly one FixedUpdate per frame instead of following real time.
+     *
+     * Each step then lines up with one call to Update, so the input of every
+     * step is the input sampled in that frame, however slow or fast frames are.
+     * The simulation runs slower or faster than real time accordingly. Has no
+     * effect in pipelined mode.
+     *
+     * @param lockstep True to step once per frame.
+     */
+    void SetLockstep(bool lockstep);
+
+    /**
+     * @brief Returns whether every frame runs exactly one fixed step.
+     */
+    bool IsLockstep() const;
 };
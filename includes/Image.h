@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct Image
+ * @brief 8-bit RGB pixels in rows from top to bottom, without padding.
+ */
+struct Image
+{
+    /// @brief Size in pixels.
+    int width = 0;
+    int height = 0;
+
+    /// @brief width * height * 3 bytes; red, green and blue of each pixel.
+    std::vector<std::uint8_t> pixels;
+
+    /**
+     * @brief Sets the size, reallocating only when the pixel count grows.
+     */
+    void Resize(int newWidth, int newHeight)
+    {
+        width = newWidth;
+        height = newHeight;
+        pixels.resize(static_cast<std::size_t>(newWidth) * static_cast<std::size_t>(newHeight) * 3);
+    }
+};
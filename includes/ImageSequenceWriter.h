@@ -0,0 +1,172 @@
+#pragma once
+
+#include "Image.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ImageSequenceWriter
+ * @brief Writes numbered PPM or PNG files from a background thread.
+ *
+ * Submitting a frame swaps its pixels with a free slot and hands the slot over
+ * through a lock-free queue, so the caller neither copies nor waits for the
+ * encoder or the disk. PNG files are written uncompressed (stored deflate
+ * blocks), which needs no zlib and keeps encoding at memory speed.
+ */
+class ImageSequenceWriter
+{
+private:
+    /**
+     * @brief Output file format, chosen from the pattern's extension.
+     */
+    enum class Format
+    {
+        Ppm,
+        Png
+    };
+
+    /**
+     * @brief One submitted frame waiting to be encoded.
+     */
+    struct Frame
+    {
+        std::uint64_t index = 0;
+        Image image;
+    };
+
+    /// @brief Number of frames that can be in flight between the two threads.
+    static constexpr std::uint32_t SLOT_COUNT = 8;
+
+    /**
+     * @brief Frame storage shared by both threads; ownership moves through the queues.
+     */
+    std::vector<Frame> m_frames;
+
+    /**
+     * @brief Slots ready to be filled (writer thread to caller).
+     */
+    SpscQueue<std::uint32_t, 2 * SLOT_COUNT> m_freeSlots;
+
+    /**
+     * @brief Slots ready to be written (caller to writer thread).
+     */
+    SpscQueue<std::uint32_t, 2 * SLOT_COUNT> m_filledSlots;
+
+    /**
+     * @brief Wakes the writer thread when a frame is queued or the sequence is closed.
+     */
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    /**
+     * @brief Background thread encoding and writing frames.
+     */
+    std::thread m_thread;
+
+    /**
+     * @brief Keeps the writer thread running; cleared by Close.
+     */
+    std::atomic<bool> m_isRunning{false};
+
+    /**
+     * @brief Frames skipped because every slot was still waiting to be written.
+     */
+    std::atomic<std::uint64_t> m_droppedFrames{0};
+
+    /**
+     * @brief Files written, and files that could not be written (writer thread).
+     */
+    std::atomic<std::uint64_t> m_writtenFrames{0};
+    std::atomic<std::uint64_t> m_failedFrames{0};
+
+    /// @brief printf pattern with one integer conversion, e.g. "frames/cloth_%05d.png".
+    std::string m_pattern;
+    Format m_format = Format::Ppm;
+
+    /// @brief Index given to the next submitted frame.
+    std::uint64_t m_nextIndex = 0;
+
+    /// @brief Encoded file of the frame being written (writer thread).
+    std::vector<std::uint8_t> m_payload;
+
+    /**
+     * @brief Writer thread: encodes and writes queued frames until closed.
+     */
+    void WriterLoop();
+
+    /**
+     * @brief Encodes one frame and writes it to its numbered file.
+     */
+    void WriteFrame(const Frame& frame);
+
+    /// @brief Encoders filling m_payload.
+    void EncodePpm(const Image& image);
+    void EncodePng(const Image& image);
+
+public:
+    ImageSequenceWriter() = default;
+
+    /**
+     * @brief Closes the sequence, writing any queued frames first.
+     */
+    ~ImageSequenceWriter();
+
+    ImageSequenceWriter(const ImageSequenceWriter&) = delete;
+    ImageSequenceWriter& operator=(const ImageSequenceWriter&) = delete;
+
+    /**
+     * @brief Starts a sequence and the writer thread.
+     *
+     * @param pattern Path with exactly one integer conversion (%d or %0Nd) for the
+     *                frame index, ending in .ppm or .png.
+     * @param width Width of every frame in pixels.
+     * @param height Height of every frame in pixels.
+     * @return False if the pattern or size is invalid.
+     */
+    bool Open(const std::string& pattern, int width, int height);
+
+    /**
+     * @brief Queues an image as the next frame.
+     *
+     * The image is swapped with a free slot: afterwards it holds the pixels of an
+     * older frame at the same size, ready to be drawn over.
+     *
+     * @param image Frame to write, of the size given to Open.
+     * @param waitForSlot Wait for the writer instead of dropping the frame when
+     *                    it is behind; for batch runs where every frame matters.
+     * @return False if the frame was dropped.
+     */
+    bool Submit(Image& image, bool waitForSlot = false);
+
+    /**
+     * @brief Writes the remaining queued frames and stops the writer thread.
+     */
+    void Close();
+
+    /**
+     * @brief Returns whether a sequence is in progress.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Returns how many frames were dropped since Open.
+     */
+    std::uint64_t GetDroppedFrames() const;
+
+    /**
+     * @brief Returns how many files were written since Open.
+     */
+    std::uint64_t GetWrittenFrames() const;
+
+    /**
+     * @brief Returns how many files could not be created or written since Open.
+     */
+    std::uint64_t GetFailedFrames() const;
+};
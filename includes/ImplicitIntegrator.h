@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ClothDesc.h"
+#include "Constraint.h"
+#include "ParticleBuffer.h"
+#include "SolverSettings.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class ImplicitIntegrator
+ * @brief Backward Euler step of the cloth's constraints treated as stiff springs.
+ *
+ * Each step linearizes the spring forces around the current positions and
+ * solves (I + h^2 H) dv = h (f + g - h H v) for the velocity change, where H is
+ * the spring stiffness matrix (2x2 blocks in CSR layout, one row per particle).
+ * The solve uses conjugate gradient with a block-Jacobi preconditioner; every
+ * sweep over rows, springs or particles is split across the thread pool, and
+ * dot products are combined in chunk order so the result does not depend on
+ * the thread count.
+ *
+ * The sparsity pattern (which particles are coupled) is built once and reused
+ * every step; only tearing, a reset or new solver settings require Build again.
+ * Masses are one, as everywhere else in the solver. Pinned, sleeping and
+ * inactive particles are held fixed.
+ */
+class ImplicitIntegrator
+{
+private:
+    /**
+     * @brief A constraint taken into the system as a spring.
+     */
+    struct Spring
+    {
+        std::uint32_t p1, p2;
+        float length;
+        float stiffness;
+
+        /// @brief Bending links only resist compression, like in the position solver.
+        bool isPushOnly;
+    };
+
+    /**
+     * @brief One end of a spring, seen from the row of that particle.
+     */
+    struct Incidence
+    {
+        std::uint32_t spring;
+        std::uint32_t other;
+
+        /// @brief Off-diagonal block of this row that couples to the other particle.
+        std::uint32_t block;
+    };
+
+    /// @brief Springs of all active constraints with a positive stiffness.
+    std::vector<Spring> m_springs;
+
+    /// @brief Per spring, from the current positions: stiffness block (xx, xy, yy) and force on p1 (x, y).
+    std::vector<float> m_springBlocks;
+    std::vector<float> m_springForces;
+
+    /// @brief Row i's springs are m_incidences[m_incidenceBegin[i], m_incidenceBegin[i + 1]).
+    std::vector<std::uint32_t> m_incidenceBegin;
+    std::vector<Incidence> m_incidences;
+
+    /// @brief Row i's off-diagonal blocks are [m_rowBegin[i], m_rowBegin[i + 1]); their columns and values (xx, xy, yy).
+    std::vector<std::uint32_t> m_rowBegin;
+    std::vector<std::uint32_t> m_columns;
+    std::vector<float> m_blocks;
+
+    /// @brief Diagonal block of each row and its inverse, the preconditioner (xx, xy, yy).
+    std::vector<float> m_diagonal;
+    std::vector<float> m_inverseDiagonal;
+
+    /// @brief Gravity step (pixels per second squared, drag applied) and damping factor of each particle's cloth.
+    std::vector<float> m_gravity;
+    std::vector<float> m_damping;
+
+    /// @brief Nonzero for particles held fixed this step.
+    std::vector<std::uint8_t> m_isFixed;
+
+    /// @brief Per-particle vectors, x and y interleaved.
+    std::vector<float> m_velocity;
+    std::vector<float> m_rhs;
+    std::vector<float> m_deltaVelocity;
+    std::vector<float> m_residual;
+    std::vector<float> m_preconditioned;
+    std::vector<float> m_direction;
+    std::vector<float> m_product;
+
+    /// @brief Partial dot products of one sweep, one pair per chunk, summed in chunk order.
+    std::vector<double> m_chunkSums;
+
+    /// @brief Conjugate gradient iterations and relative residual of the last step.
+    int m_lastIterations = 0;
+    float m_lastResidual = 0.f;
+
+    /**
+     * @brief Adds up the two partial sums each chunk of the last particle sweep left, in chunk order.
+     */
+    void SumChunks(std::size_t chunkCount, double& first, double& second) const;
+
+public:
+    /**
+     * @brief Builds the spring list and the sparsity pattern from the active constraints.
+     *
+     * @param particles Particle storage the constraints refer to.
+     * @param constraints All constraints of the cloth.
+     * @param cloths Physical parameters of each cloth.
+     * @param clothParticleBegin Cloth i owns particles [clothParticleBegin[i], clothParticleBegin[i + 1]).
+     * @param settings Spring stiffness, and the shear and bending stiffness that scale their springs.
+     */
+    void Build(const ParticleBuffer& particles, const std::vector<Constraint>& constraints, const std::vector<ClothDesc>& cloths,
+               const std::vector<std::uint32_t>& clothParticleBegin, const SolverSettings& settings);
+
+    /**
+     * @brief Advances every free particle by one implicit step.
+     *
+     * @param particles Particle storage given to Build.
+     * @param deltaTime Step size in seconds.
+     * @param boundsWidth Right edge particles are kept inside.
+     * @param boundsHeight Bottom edge particles are kept inside.
+     * @param settings Iteration budget and tolerance of the conjugate gradient solve.
+     * @param pool Threads sharing the sweeps.
+     */
+    void Step(ParticleBuffer& particles, float deltaTime, float boundsWidth, float boundsHeight, const SolverSettings& settings, ThreadPool& pool);
+
+    /**
+     * @brief Returns the number of conjugate gradient iterations of the last step.
+     */
+    int GetLastIterations() const { return m_lastIterations; }
+
+    /**
+     * @brief Returns the residual of the last solve relative to its right-hand side.
+     */
+    float GetLastResidual() const { return m_lastResidual; }
+};
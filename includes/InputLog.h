@@ -0,0 +1,172 @@
+#pragma once
+
+#include "ClothInput.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/**
+ * @file InputLog.h
+ * @brief Per-step record of the input a Cloth was stepped with, for replaying a session headless.
+ *
+ * A file is a fixed header followed by one fixed-size record per physics step:
+ *
+ *     int32 mouseX, mouseY, lastMouseX, lastMouseY, float cursorSize, uint32 bits
+ *
+ * where the bits hold INPUT_DRAGGING, INPUT_CUTTING, INPUT_PINNING and INPUT_RESET. The header
+ * stores the time step and the simulation bounds. Replaying the records from
+ * the same starting state (a checkpoint) repeats the session exactly, whatever
+ * the frame rate it was recorded at.
+ */
+namespace InputLogFormat
+{
+    /// @brief File signature.
+    constexpr char MAGIC[8] = {'C', 'L', 'O', 'T', 'H', 'I', 'N', 'P'};
+
+    /// @brief Current format version; bumped on any layout change.
+    constexpr std::uint32_t VERSION = 1;
+
+    /// @brief Record bits.
+    constexpr std::uint32_t INPUT_DRAGGING = 1u << 0;
+    constexpr std::uint32_t INPUT_CUTTING = 1u << 1;
+    constexpr std::uint32_t INPUT_PINNING = 1u << 3;
+
+    /// @brief The cloth was reset (Cloth::Reset) right before this step.
+    constexpr std::uint32_t INPUT_RESET = 1u << 2;
+
+    /**
+     * @brief Fixed-size file header.
+     */
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        float deltaTime;
+        std::int32_t boundsWidth;
+        std::int32_t boundsHeight;
+    };
+
+    /**
+     * @brief Input of one step.
+     */
+    struct Record
+    {
+        std::int32_t mouseX;
+        std::int32_t mouseY;
+        std::int32_t lastMouseX;
+        std::int32_t lastMouseY;
+        float cursorSize;
+        std::uint32_t bits;
+    };
+}
+
+/**
+ * @class InputLogWriter
+ * @brief Appends the input of each physics step to an input log.
+ */
+class InputLogWriter
+{
+private:
+    /**
+     * @brief Output file.
+     */
+    std::ofstream m_file;
+
+public:
+    /**
+     * @brief Creates the file and writes its header.
+     *
+     * @param path File to write (overwritten).
+     * @param deltaTime Fixed time step the steps are taken with.
+     * @param boundsWidth Width of the area particles are kept inside.
+     * @param boundsHeight Height of the area particles are kept inside.
+     * @return False if the file could not be created.
+     */
+    bool Open(const std::string& path, float deltaTime, int boundsWidth, int boundsHeight);
+
+    /**
+     * @brief Returns whether a file is open.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Appends the input of one step.
+     *
+     * @param input Input the step is taken with.
+     * @param isReset Whether the cloth was reset right before the step.
+     */
+    void Write(const ClothInput& input, bool isReset);
+
+    /**
+     * @brief Flushes and closes the file.
+     */
+    void Close();
+};
+
+/**
+ * @class InputLogReader
+ * @brief Reads an input log back one step at a time.
+ */
+class InputLogReader
+{
+private:
+    /**
+     * @brief Input file, positioned at the next record.
+     */
+    std::ifstream m_file;
+
+    /**
+     * @brief Time step stored in the header.
+     */
+    float m_deltaTime = 0.f;
+
+    /**
+     * @brief Simulation bounds stored in the header.
+     */
+    int m_boundsWidth = 0;
+    int m_boundsHeight = 0;
+
+    /**
+     * @brief Number of whole records in the file.
+     */
+    std::uint64_t m_stepCount = 0;
+
+public:
+    /**
+     * @brief Opens an input log and reads its header.
+     *
+     * @param path File to read.
+     * @return False if the file is missing or not an input log of this version.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Reads the input of the next step.
+     *
+     * @param input Receives the input.
+     * @param isReset Receives whether the cloth must be reset before the step.
+     * @return False at the end of the file.
+     */
+    bool Read(ClothInput& input, bool& isReset);
+
+    /**
+     * @brief Returns the time step the log was recorded with.
+     */
+    float GetDeltaTime() const;
+
+    /**
+     * @brief Returns the width of the simulation bounds the log was recorded with.
+     */
+    int GetBoundsWidth() const;
+
+    /**
+     * @brief Returns the height of the simulation bounds the log was recorded with.
+     */
+    int GetBoundsHeight() const;
+
+    /**
+     * @brief Returns the number of steps in the log.
+     */
+    std::uint64_t GetStepCount() const;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Constraint.h"
+#include "ParticleBuffer.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct ParticleRun
+ * @brief Consecutive awake particles integrated with the same gravity and drag.
+ */
+struct ParticleRun
+{
+    /// @brief Index of the first particle in the run.
+    std::uint32_t begin = 0;
+
+    /// @brief One past the index of the last particle in the run.
+    std::uint32_t end = 0;
+
+    /// @brief Cloth whose gravity and drag apply to the run.
+    std::uint32_t cloth = 0;
+};
+
+/**
+ * @class IslandSet
+ * @brief Groups particles into islands connected by active constraints and puts resting islands to sleep.
+ *
+ * Islands are found with union-find over all active constraints, so a piece torn
+ * off the cloth becomes an island of its own. An island sleeps once none of its
+ * free particles has moved faster than the sleep speed for a number of steps.
+ * Its particles are then flagged PARTICLE_SLEEPING, lose their residual velocity
+ * and are left out of integration and constraint solving until woken.
+ *
+ * Rebuilding after a tear keeps a new island asleep only if all of its particles
+ * were asleep, so the pieces of a cut made under the cursor are always awake.
+ */
+class IslandSet
+{
+public:
+    /**
+     * @brief Marks a particle that belongs to no island (it has been cut out).
+     */
+    static constexpr std::uint32_t NO_ISLAND = 0xFFFFFFFFu;
+
+private:
+    /**
+     * @brief Sleep state of one island.
+     */
+    struct Island
+    {
+        /// @brief Consecutive steps the island has been resting for.
+        std::uint32_t restingSteps = 0;
+
+        /// @brief Whether the island is asleep.
+        bool isSleeping = false;
+
+        /// @brief Set by Wake; applied by the next ApplyWakes.
+        bool isWakeRequested = false;
+
+        /// @brief Largest squared particle speed of the current step.
+        float maxSpeedSquared = 0.f;
+    };
+
+    /**
+     * @brief Union-find parent of each particle; only used while building.
+     */
+    std::vector<std::uint32_t> m_parent;
+
+    /**
+     * @brief Island of each particle, or NO_ISLAND.
+     */
+    std::vector<std::uint32_t> m_islandOfParticle;
+
+    /**
+     * @brief State of each island.
+     */
+    std::vector<Island> m_islands;
+
+    /**
+     * @brief Whether any island has asked to be woken since the last ApplyWakes.
+     */
+    bool m_isWakePending = false;
+
+    /**
+     * @brief Returns the root of a particle's set, halving the path on the way.
+     */
+    std::uint32_t Find(std::uint32_t particle);
+
+    /**
+     * @brief Puts the particles of sleeping islands to sleep and wakes all others.
+     */
+    void UpdateFlags(ParticleBuffer& particles) const;
+
+public:
+    /**
+     * @brief Finds the islands of the current topology.
+     *
+     * An island starts asleep only if all of its particles are asleep; the
+     * particles of every other island are woken. Storage is reused.
+     *
+     * @param particles Particle storage; sleeping flags are updated.
+     * @param constraints All constraints of the cloth; inactive ones do not connect.
+     */
+    void Build(ParticleBuffer& particles, const std::vector<Constraint>& constraints);
+
+    /**
+     * @brief Measures this step's motion and puts islands that have rested long enough to sleep.
+     *
+     * @param particles Particle storage, with the previous positions of this step.
+     * @param runs Awake particles, the only ones that can have moved.
+     * @param sleepSpeed Speed (pixels per step) below which a particle counts as resting.
+     * @param sleepSteps Number of consecutive resting steps before an island sleeps.
+     * @return True if any island fell asleep.
+     */
+    bool Update(ParticleBuffer& particles, const std::vector<ParticleRun>& runs, float sleepSpeed, std::uint32_t sleepSteps);
+
+    /**
+     * @brief Requests that the island of a particle wakes up; see ApplyWakes.
+     *
+     * @param particle Index of a particle of the island.
+     */
+    void Wake(std::uint32_t particle);
+
+    /**
+     * @brief Wakes the islands requested since the last call.
+     *
+     * @param particles Particle storage; sleeping flags are cleared.
+     * @return True if any island woke up.
+     */
+    bool ApplyWakes(ParticleBuffer& particles);
+
+    /**
+     * @brief Returns the number of islands.
+     */
+    std::size_t GetIslandCount() const { return m_islands.size(); }
+
+    /**
+     * @brief Returns the number of islands asleep.
+     */
+    std::size_t GetSleepingCount() const;
+
+    /**
+     * @brief Returns how many consecutive steps an island has been resting for.
+     */
+    std::uint32_t GetRestingSteps(std::uint32_t island) const { return m_islands[island].restingSteps; }
+
+    /**
+     * @brief Sets how many consecutive steps an island has been resting for, e.g. when restoring a checkpoint.
+     */
+    void SetRestingSteps(std::uint32_t island, std::uint32_t restingSteps) { m_islands[island].restingSteps = restingSteps; }
+
+    /**
+     * @brief Returns the island of a particle, or NO_ISLAND for particles that have been cut out.
+     */
+    std::uint32_t GetIsland(std::uint32_t particle) const { return m_islandOfParticle[particle]; }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Per-particle state bits stored in ParticleBuffer::GetFlags().
+ */
+enum ParticleFlags : std::uint8_t
+{
+    /// @brief Particle takes part in the simulation (cleared when the cloth is cut).
+    PARTICLE_ACTIVE = 1 << 0,
+
+    /// @brief Particle is fixed to its pin anchor.
+    PARTICLE_PINNED = 1 << 1,
+
+    /// @brief Particle belongs to a resting island and is skipped by integration and the solver (see IslandSet).
+    PARTICLE_SLEEPING = 1 << 2,
+};
+
+/**
+ * @class ParticleBuffer
+ * @brief Structure-of-arrays storage for all point masses of a cloth.
+ *
+ * Every particle attribute lives in its own contiguous array so the Verlet kernel
+ * can stream through positions a SIMD batch at a time. Particles are addressed by
+ * their index, which stays stable for the lifetime of the buffer.
+ */
+class ParticleBuffer
+{
+    // Saves and restores the raw arrays
+    friend class ClothCheckpoint;
+
+private:
+    /**
+     * @brief Current positions.
+     */
+    std::vector<float> m_x, m_y;
+
+    /**
+     * @brief Positions at the previous step (Verlet velocity is x - lastX).
+     */
+    std::vector<float> m_lastX, m_lastY;
+
+    /**
+     * @brief Positions at the end of the step before the current one, for render interpolation.
+     */
+    std::vector<float> m_previousX, m_previousY;
+
+    /**
+     * @brief Initial positions, restored by ResetToStart.
+     */
+    std::vector<float> m_startX, m_startY;
+
+    /**
+     * @brief Positions pinned particles are held at; the start position unless pinned in place later.
+     */
+    std::vector<float> m_pinX, m_pinY;
+
+    /**
+     * @brief Combination of ParticleFlags for each particle.
+     */
+    std::vector<std::uint8_t> m_flags;
+
+    /**
+     * @brief Flags restored by ResetToStart: active, and pinned if pinned with Pin.
+     */
+    std::vector<std::uint8_t> m_startFlags;
+
+public:
+    /**
+     * @brief Pre-allocates space for a number of particles.
+     *
+     * @param count Number of particles to reserve space for.
+     */
+    void Reserve(std::size_t count);
+
+    /**
+     * @brief Appends an active, unpinned particle at rest at the given position.
+     *
+     * @param x X-coordinate of the particle.
+     * @param y Y-coordinate of the particle.
+     * @return Index of the new particle.
+     */
+    std::uint32_t Add(float x, float y);
+
+    /**
+     * @brief Removes all particles, keeping the arrays' capacity for the next Add calls.
+     */
+    void Clear();
+
+    /**
+     * @brief Puts every particle back at rest at its start position, reactivates and wakes it.
+     *
+     * Pins set with Pin are kept; those set with PinInPlace are released.
+     */
+    void ResetToStart();
+
+    /**
+     * @brief Returns the number of particles in the buffer.
+     */
+    std::size_t Size() const;
+
+    /**
+     * @brief Remembers the current positions as the previous step's positions.
+     *
+     * Called at the start of every step so the viewer can blend between the
+     * last two physics states.
+     */
+    void StorePreviousPositions();
+
+    /**
+     * @brief Pins a particle to its start position, as part of the initial state.
+     *
+     * @param index Index of the particle.
+     */
+    void Pin(std::uint32_t index);
+
+    /**
+     * @brief Pins a particle where it is now, dropping its velocity.
+     *
+     * Unlike Pin, the pin only lasts until the next ResetToStart.
+     *
+     * @param index Index of the particle.
+     */
+    void PinInPlace(std::uint32_t index);
+
+    /**
+     * @brief Removes a particle from the simulation.
+     *
+     * @param index Index of the particle.
+     */
+    void Deactivate(std::uint32_t index);
+
+    /**
+     * @brief Returns whether a particle still takes part in the simulation.
+     *
+     * @param index Index of the particle.
+     */
+    bool IsActive(std::uint32_t index) const;
+
+    /**
+     * @brief Returns whether a particle is pinned.
+     *
+     * @param index Index of the particle.
+     */
+    bool IsPinned(std::uint32_t index) const;
+
+    /**
+     * @brief Puts a particle to sleep, dropping its velocity.
+     *
+     * @param index Index of the particle.
+     */
+    void Sleep(std::uint32_t index);
+
+    /**
+     * @brief Wakes a sleeping particle; it starts again from rest.
+     *
+     * @param index Index of the particle.
+     */
+    void Wake(std::uint32_t index);
+
+    /**
+     * @brief Wakes every particle.
+     */
+    void WakeAll();
+
+    /**
+     * @brief Returns whether a particle is asleep.
+     *
+     * @param index Index of the particle.
+     */
+    bool IsSleeping(std::uint32_t index) const;
+
+    /// @name Raw attribute arrays, each Size() elements long.
+    /// @{
+    float* GetX() { return m_x.data(); }
+    float* GetY() { return m_y.data(); }
+    float* GetLastX() { return m_lastX.data(); }
+    float* GetLastY() { return m_lastY.data(); }
+    const float* GetX() const { return m_x.data(); }
+    const float* GetY() const { return m_y.data(); }
+    const float* GetLastX() const { return m_lastX.data(); }
+    const float* GetLastY() const { return m_lastY.data(); }
+    const float* GetPreviousX() const { return m_previousX.data(); }
+    const float* GetPreviousY() const { return m_previousY.data(); }
+    const float* GetStartX() const { return m_startX.data(); }
+    const float* GetStartY() const { return m_startY.data(); }
+    const float* GetPinX() const { return m_pinX.data(); }
+    const float* GetPinY() const { return m_pinY.data(); }
+    const std::uint8_t* GetFlags() const { return m_flags.data(); }
+    /// @}
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ProfileEvent
+ * @brief One timed scope recorded by the profiler.
+ */
+struct ProfileEvent
+{
+    /// @brief Phase name (a string literal).
+    const char* name = nullptr;
+
+    /// @brief Small per-thread number, in order of first use.
+    std::uint32_t thread = 0;
+
+    /// @brief Start time in nanoseconds since the profiler was created.
+    std::int64_t startNs = 0;
+
+    /// @brief Duration in nanoseconds.
+    std::int64_t durationNs = 0;
+};
+
+/**
+ * @struct PhaseStats
+ * @brief Rolling duration percentiles of one phase.
+ */
+struct PhaseStats
+{
+    const char* name = nullptr;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    std::size_t samples = 0;
+};
+
+/**
+ * @class Profiler
+ * @brief Process-wide recorder of timed scopes.
+ *
+ * Events go into a fixed-size lock-free ring buffer: any thread can record
+ * without blocking, and the oldest events are overwritten once the ring is
+ * full. Readers take consistent copies of the ring to compute percentiles or
+ * to export a Chrome trace (chrome://tracing, Perfetto).
+ */
+class Profiler
+{
+private:
+    /**
+     * @brief One ring entry. The sequence number is 0 while the slot is being
+     *        written and the event index + 1 afterwards, so readers can detect torn reads.
+     */
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::uint32_t> thread{0};
+        std::atomic<std::int64_t> startNs{0};
+        std::atomic<std::int64_t> durationNs{0};
+    };
+
+    /**
+     * @brief Ring storage, CAPACITY entries.
+     */
+    std::unique_ptr<Slot[]> m_slots;
+
+    /**
+     * @brief Index of the next event to be written.
+     */
+    std::atomic<std::uint64_t> m_head{0};
+
+    /**
+     * @brief Recording switch; scopes cost one atomic load when disabled.
+     */
+    std::atomic<bool> m_isEnabled{true};
+
+    /**
+     * @brief Time zero of all event timestamps.
+     */
+    std::chrono::steady_clock::time_point m_epoch;
+
+    Profiler();
+
+public:
+    /**
+     * @brief Number of events kept in the ring (a power of two).
+     */
+    static constexpr std::size_t CAPACITY = 1 << 16;
+
+    /**
+     * @brief Returns the process-wide profiler.
+     */
+    static Profiler& Get();
+
+    /**
+     * @brief Returns nanoseconds elapsed since the profiler was created.
+     */
+    std::int64_t Now() const;
+
+    /**
+     * @brief Turns recording on or off.
+     */
+    void SetEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether scopes are being recorded.
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @brief Records one timed scope on the calling thread.
+     *
+     * @param name Phase name; must be a string with static lifetime.
+     * @param startNs Start time as returned by Now().
+     * @param endNs End time as returned by Now().
+     */
+    void Record(const char* name, std::int64_t startNs, std::int64_t endNs);
+
+    /**
+     * @brief Copies the events currently in the ring, oldest first.
+     *
+     * Entries being overwritten during the copy are skipped.
+     *
+     * @param events Receives the events (cleared first).
+     */
+    void CopyEvents(std::vector<ProfileEvent>& events) const;
+
+    /**
+     * @brief Computes p50/p99 durations of each phase over its most recent samples.
+     *
+     * @param stats Receives one entry per phase, in order of first appearance (cleared first).
+     * @param samplesPerPhase Size of the rolling window per phase.
+     */
+    void ComputeStats(std::vector<PhaseStats>& stats, std::size_t samplesPerPhase) const;
+
+    /**
+     * @brief Writes the events in the ring as a Chrome trace_event JSON file.
+     *
+     * @param path File to write.
+     * @return False if the file could not be written.
+     */
+    bool WriteChromeTrace(const std::string& path) const;
+};
+
+/**
+ * @class ProfileScope
+ * @brief Records the time between its construction and destruction under a phase name.
+ */
+class ProfileScope
+{
+private:
+    const char* m_name;
+    std::int64_t m_startNs;
+
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/// @brief Times the rest of the enclosing block as the given phase.
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Profiler.h"
+#include "SFML/Graphics.hpp"
+
+#include <vector>
+
+/**
+ * @class ProfilerOverlay
+ * @brief Draws the profiler's per-phase p50/p99 timings on top of the scene.
+ *
+ * The text is rebuilt only a few times per second, so the overlay itself
+ * barely shows up in the timings it displays.
+ */
+class ProfilerOverlay
+{
+private:
+    /**
+     * @brief Text holding one line per phase.
+     */
+    sf::Text m_text;
+
+    /**
+     * @brief Scratch storage reused by each refresh.
+     */
+    std::vector<PhaseStats> m_stats;
+
+    /**
+     * @brief Seconds since the text was last rebuilt.
+     */
+    float m_sinceRefresh = 0.f;
+
+    /**
+     * @brief Whether the overlay is drawn.
+     */
+    bool m_isVisible = false;
+
+public:
+    /**
+     * @brief Seconds between two refreshes of the text.
+     */
+    static constexpr float REFRESH_INTERVAL = 0.5f;
+
+    /**
+     * @brief Number of most recent samples per phase the percentiles cover.
+     */
+    static constexpr std::size_t SAMPLE_WINDOW = 240;
+
+    /**
+     * @param font Font of the overlay text; must outlive the overlay.
+     */
+    explicit ProfilerOverlay(const sf::Font& font);
+
+    /**
+     * @brief Shows or hides the overlay.
+     */
+    void Toggle();
+
+    /**
+     * @brief Returns whether the overlay is drawn.
+     */
+    bool IsVisible() const;
+
+    /**
+     * @brief Rebuilds the text once the refresh interval has passed.
+     *
+     * @param deltaTime Elapsed time since the last frame (in seconds).
+     */
+    void Update(float deltaTime);
+
+    /**
+     * @brief Draws the overlay if it is visible.
+     */
+    void Draw(sf::RenderWindow& win) const;
+};
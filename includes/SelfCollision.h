@@ -0,0 +1,135 @@
+#pragma once
+
+#include "ParticleBuffer.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SelfCollision
+ * @brief Keeps particles at least a minimum distance apart.
+ *
+ * Broadphase: a dense uniform grid over the particles' current bounding box,
+ * with about two cells per particle, rebuilt every step with a counting sort
+ * so each cell's particles (and a copy of their positions) are contiguous in
+ * memory. Narrowphase: every particle gathers the push-outs from the particles
+ * in the cells within the distance against the copied positions and applies
+ * the sum to itself (Jacobi style). A particle only writes its own position,
+ * so the pass runs in parallel and gives the same result for any thread count.
+ *
+ * Sleeping particles (see IslandSet) are obstacles: they push awake particles
+ * away but are neither moved nor pushed by each other. Awake particles touching
+ * them are reported, so the caller can decide whether to wake their islands.
+ */
+class SelfCollision
+{
+public:
+    /**
+     * @brief An awake particle found touching a sleeping one.
+     */
+    struct SleepingContact
+    {
+        std::uint32_t particle;
+        std::uint32_t sleeper;
+    };
+
+private:
+    /// @brief Edge length of a grid cell and its inverse.
+    float m_cellSize = 1.f;
+    float m_inverseCellSize = 1.f;
+
+    /// @brief Corner of the grid: the smallest coordinates of any active particle.
+    float m_originX = 0.f;
+    float m_originY = 0.f;
+
+    /// @brief Grid dimensions in cells.
+    int m_columns = 0;
+    int m_rows = 0;
+
+    /**
+     * @brief Grid cell of each particle in the current pass; NOT_STORED for inactive ones.
+     */
+    std::vector<std::uint32_t> m_cellOfParticle;
+
+    /**
+     * @brief Offset of each cell's first entry in m_sorted, plus the total at the end.
+     */
+    std::vector<std::uint32_t> m_cellStart;
+
+    /**
+     * @brief Next free entry of each cell while scattering.
+     */
+    std::vector<std::uint32_t> m_cellCursor;
+
+    /**
+     * @brief Active particles ordered by cell, ascending index within a cell.
+     */
+    std::vector<std::uint32_t> m_sorted;
+
+    /// @brief Positions in m_sorted order, read by the narrowphase.
+    std::vector<float> m_sortedX, m_sortedY;
+
+    /// @brief Whether each entry of m_sorted is asleep.
+    std::vector<std::uint8_t> m_sortedSleeping;
+
+    /// @brief Sleeping particle each entry of m_sorted touched, or NOT_STORED; written by the narrowphase.
+    std::vector<std::uint32_t> m_sleeperOf;
+
+    /// @brief Bounding box of the active particles of each bounds chunk (min x, min y, max x, max y).
+    std::vector<float> m_chunkBounds;
+
+    /// @brief Contacts of awake with sleeping particles found by the last Solve, in m_sorted order.
+    std::vector<SleepingContact> m_sleepingContacts;
+
+    /// @brief Number of overlapping pairs, and of contacts with sleeping particles, found per narrowphase chunk.
+    std::vector<std::uint32_t> m_chunkContacts;
+    std::vector<std::uint32_t> m_chunkSleepingContacts;
+
+    /**
+     * @brief Number of overlapping pairs found by the last Solve (each pair counted once).
+     */
+    std::uint32_t m_lastContactCount = 0;
+
+    /**
+     * @brief Fits the grid to the active particles' bounding box, keeping the cell count near twice the particle count.
+     */
+    void ResizeGrid(const ParticleBuffer& particles, float minDistance, ThreadPool& threadPool);
+
+    /**
+     * @brief Sorts the active particles into the grid with a counting sort.
+     */
+    void BuildGrid(const ParticleBuffer& particles);
+
+public:
+    /**
+     * @brief Marks an inactive particle that is not in the grid.
+     */
+    static constexpr std::uint32_t NOT_STORED = 0xFFFFFFFFu;
+
+    /**
+     * @brief Pushes apart every pair of active particles closer than a distance.
+     *
+     * Pinned and sleeping particles are not moved.
+     *
+     * @param particles Particles to separate.
+     * @param minDistance Smallest allowed distance between two particles.
+     * @param threadPool Threads running the bounding box and the narrowphase.
+     */
+    void Solve(ParticleBuffer& particles, float minDistance, ThreadPool& threadPool);
+
+    /**
+     * @brief Forgets the contacts of the last Solve, for a step with no awake particle to separate.
+     */
+    void Clear();
+
+    /**
+     * @brief Returns the number of overlapping pairs the last Solve found.
+     */
+    std::uint32_t GetLastContactCount() const;
+
+    /**
+     * @brief Returns the awake particles the last Solve found touching a sleeping one, with the first one each touched.
+     */
+    const std::vector<SleepingContact>& GetSleepingContacts() const;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Cloth.h"
+#include "Collider.h"
+#include "Image.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class SoftwareRenderer
+ * @brief Draws a Cloth into an Image on the CPU, for machines without a display or GPU.
+ *
+ * Produces the same picture as the viewer: active structural constraints in
+ * white, highlighted ones in red, collider outlines in grey on black, with the
+ * simulation bounds fitted into the image. Lines are one pixel wide and
+ * anti-aliased (Xiaolin Wu's algorithm).
+ *
+ * The image is split into square tiles. Each frame, segments are binned to the
+ * tiles their bounding box overlaps, in parallel chunks; then every tile draws
+ * its own segments, so threads never write the same pixel. Segments are drawn
+ * in constraint order within each tile, so the image does not depend on the
+ * thread count.
+ */
+class SoftwareRenderer
+{
+public:
+    /**
+     * @brief Width and height of a tile in pixels.
+     */
+    static constexpr int TILE_SIZE = 64;
+
+private:
+    /**
+     * @brief A line in image coordinates and the palette entry it is drawn with.
+     */
+    struct Segment
+    {
+        float x0, y0, x1, y1;
+        std::uint32_t color;
+    };
+
+    /**
+     * @brief Threads sharing the binning and the tiles; may be shared with the solver.
+     */
+    std::shared_ptr<ThreadPool> m_threadPool;
+
+    /**
+     * @brief Collider outlines in simulation coordinates, four floats per line.
+     */
+    std::vector<float> m_colliderLines;
+
+    /**
+     * @brief Collider lines followed by every structural constraint, transformed for the current frame.
+     */
+    std::vector<Segment> m_segments;
+
+    /// @brief Tile grid of the current image size.
+    int m_tileCountX = 0;
+    int m_tileCountY = 0;
+
+    /**
+     * @brief Segment count of every (chunk, tile) pair, then the write offset of each.
+     */
+    std::vector<std::uint32_t> m_chunkTileCounts;
+
+    /**
+     * @brief Segments of tile t are m_tileSegments[m_tileBegin[t], m_tileBegin[t + 1]).
+     */
+    std::vector<std::uint32_t> m_tileBegin;
+    std::vector<std::uint32_t> m_tileSegments;
+
+    /**
+     * @brief Returns the range of tiles a segment's bounding box overlaps, or false if it lies outside the image.
+     */
+    bool GetTileRange(const Segment& segment, int& tileX0, int& tileY0, int& tileX1, int& tileY1) const;
+
+    /**
+     * @brief Clears one tile of the image and draws its segments.
+     */
+    void RenderTile(int tile, Image& image) const;
+
+public:
+    /**
+     * @brief Creates a renderer drawing on the calling thread.
+     */
+    SoftwareRenderer();
+
+    /**
+     * @brief Sets how many threads bin and draw.
+     *
+     * @param threadCount Number of threads including the caller; zero uses all hardware threads.
+     */
+    void SetThreadCount(unsigned threadCount);
+
+    /**
+     * @brief Bins and draws on an existing pool, e.g. the one the cloth solves on.
+     *
+     * @param threadPool Pool to use; null falls back to the calling thread.
+     */
+    void SetThreadPool(std::shared_ptr<ThreadPool> threadPool);
+
+    /**
+     * @brief Sets the static colliders outlined under the cloth.
+     *
+     * @param colliders Colliders to outline, usually Cloth::GetColliders().
+     */
+    void SetColliders(const std::vector<Collider>& colliders);
+
+    /**
+     * @brief Draws the current state of a cloth.
+     *
+     * The image keeps its size; storage is reused, so rendering at a fixed size
+     * allocates nothing after the first frame.
+     *
+     * @param cloth Cloth to draw.
+     * @param image Image to draw into, already sized (see Image::Resize).
+     */
+    void Render(const Cloth& cloth, Image& image);
+};
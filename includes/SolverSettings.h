@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief How per-constraint violations are combined into one residual.
+ */
+enum class ResidualNorm
+{
+    /// @brief Largest relative violation of any active constraint.
+    Max,
+
+    /// @brief Root mean square of the relative violations of all active constraints.
+    RMS,
+};
+
+/**
+ * @brief How a solver pass corrects a violated constraint.
+ */
+enum class ConstraintModel
+{
+    /// @brief Position-based: structural links are fully enforced, soft links corrected by a stiffness fraction per pass.
+    /// How stiff the cloth ends up depends on the step rate and the pass count.
+    Stiffness,
+
+    /// @brief Extended position-based (XPBD): every link has a compliance and accumulates its Lagrange multiplier
+    /// over the passes of a step, so the material does not change with the step rate or the pass count.
+    Compliance,
+};
+
+/**
+ * @brief How particles are advanced each step.
+ */
+enum class IntegratorType
+{
+    /// @brief Explicit Verlet step followed by the constraint passes.
+    Verlet,
+
+    /// @brief Backward Euler step with the constraints as stiff springs (see ImplicitIntegrator); replaces the passes.
+    ImplicitEuler,
+};
+
+/**
+ * @struct SolverSettings
+ * @brief Iteration budget of the constraint solver.
+ *
+ * Each step runs at least minIterations and at most maxIterations passes over
+ * all constraint batches, stopping early once the residual drops to tolerance.
+ * With self-collision enabled, one collision pass follows the constraint passes.
+ * Structural constraints are always fully enforced; shear and bending constraints
+ * are corrected by their stiffness and do not count towards the residual.
+ * With multigrid levels, each step first solves the coarse grids once (see ConstraintHierarchy).
+ * With a sleep speed, pieces of cloth that rest are skipped until touched (see IslandSet).
+ * The compliance model replaces the stiffness fractions by compliances; shear and
+ * bending links are still switched off by a zero stiffness. Rigid multigrid tethers
+ * would undo compliant threads, so the coarse grids are only solved when the
+ * structural compliance is zero.
+ * The implicit integrator treats every constraint as a spring instead and solves
+ * for all of them at once, so it needs no passes; the iteration budget then
+ * limits nothing, and the stats report its conjugate gradient iterations.
+ * The defaults reproduce a single structural pass per step without self-collision.
+ */
+struct SolverSettings
+{
+    /// @brief Passes always performed, even if the cloth is already within tolerance.
+    int minIterations = 1;
+
+    /// @brief Upper bound on passes per step.
+    int maxIterations = 1;
+
+    /// @brief Residual (relative stretch, e.g. 0.01 = 1%) at which the solver stops early.
+    float tolerance = 0.f;
+
+    /// @brief Norm used to measure the residual.
+    ResidualNorm norm = ResidualNorm::Max;
+
+    /// @brief Smallest distance particles keep from each other; 0 disables self-collision.
+    float selfCollisionDistance = 0.f;
+
+    /// @brief Fraction of a shear constraint's violation corrected per pass; 0 skips shear batches.
+    float shearStiffness = 0.f;
+
+    /// @brief Fraction of a bending constraint's compression corrected per pass; 0 skips bending batches.
+    float bendingStiffness = 0.f;
+
+    /// @brief Coarse grid levels solved before the passes, to remove long-range stretch; 0 disables multigrid.
+    int multigridLevels = 0;
+
+    /// @brief Speed (pixels per step) below which a resting piece of cloth is put to sleep; 0 disables sleeping.
+    float sleepSpeed = 0.f;
+
+    /// @brief Projection used by the passes.
+    ConstraintModel model = ConstraintModel::Stiffness;
+
+    /// @brief Compliance (inverse stiffness, in s^2 per unit mass) of each constraint type under ConstraintModel::Compliance; 0 is rigid.
+    float structuralCompliance = 0.f;
+    float shearCompliance = 0.f;
+    float bendingCompliance = 0.f;
+
+    /// @brief Time integration; ImplicitEuler stays stable with stiff springs at large steps.
+    IntegratorType integrator = IntegratorType::Verlet;
+
+    /// @brief Spring stiffness of the threads per unit mass (1/s^2) under ImplicitEuler; shear and bending springs are scaled by their stiffness.
+    float springStiffness = 20000.f;
+
+    /// @brief Upper bound on conjugate gradient iterations per implicit step.
+    int cgMaxIterations = 50;
+
+    /// @brief Conjugate gradient stops once its residual falls to this fraction of the right-hand side.
+    float cgTolerance = 0.001f;
+};
+
+/**
+ * @struct SolverStats
+ * @brief What the constraint solver did during the last step.
+ */
+struct SolverStats
+{
+    /// @brief Number of passes performed (conjugate gradient iterations under ImplicitEuler).
+    int iterations = 0;
+
+    /// @brief Residual measured during the last pass, before its corrections were applied
+    /// (the relative residual of the linear solve under ImplicitEuler).
+    float residual = 0.f;
+
+    /// @brief Overlapping particle pairs pushed apart by self-collision.
+    std::uint32_t contacts = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "ParticleBuffer.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SpatialHash
+ * @brief Uniform-grid spatial hash over particle positions for radius queries.
+ *
+ * Grid cells are hashed into a fixed table of buckets. The hash is updated
+ * incrementally: only particles that moved to a different cell since the last
+ * update are relinked, and a query only visits the buckets of cells that
+ * overlap the query circle. Finding the particles that changed cell still
+ * reads the position of every particle in the updated range, so callers
+ * should update only the ranges that may have moved (e.g. not sleeping
+ * islands), and can split that scan across a thread pool.
+ */
+class SpatialHash
+{
+private:
+    /**
+     * @brief One over the edge length of a grid cell.
+     */
+    float m_inverseCellSize = 1.f;
+
+    /**
+     * @brief Bucket count - 1 (bucket count is a power of two).
+     */
+    std::uint32_t m_mask = 0;
+
+    /**
+     * @brief Particle indices stored in each bucket.
+     */
+    std::vector<std::vector<std::uint32_t>> m_buckets;
+
+    /**
+     * @brief Bucket each particle is currently stored in, or NOT_STORED.
+     */
+    std::vector<std::uint32_t> m_bucketOf;
+
+    /**
+     * @brief Position of each particle inside its bucket.
+     */
+    std::vector<std::uint32_t> m_slotOf;
+
+    /**
+     * @brief Bucket each particle of the range being updated belongs in now; written by the parallel scan.
+     */
+    std::vector<std::uint32_t> m_nextBucketOf;
+
+    /**
+     * @brief Number of particles that changed bucket in each chunk of the parallel scan.
+     */
+    std::vector<std::uint32_t> m_chunkMoves;
+
+    /**
+     * @brief Buckets already visited by the current query.
+     */
+    std::vector<std::uint32_t> m_visited;
+
+    /**
+     * @brief Hashes integer cell coordinates to a bucket index.
+     */
+    std::uint32_t BucketOfCell(std::int32_t cellX, std::int32_t cellY) const;
+
+    /**
+     * @brief Hashes the cell containing a point to a bucket index.
+     */
+    std::uint32_t BucketOf(float x, float y) const;
+
+    /**
+     * @brief Appends a particle to a bucket.
+     */
+    void Insert(std::uint32_t particle, std::uint32_t bucket);
+
+    /**
+     * @brief Removes a particle from its bucket (swap with the last entry).
+     */
+    void Remove(std::uint32_t particle);
+
+public:
+    /**
+     * @brief Marks a particle that is not in the hash (inactive or not yet inserted).
+     */
+    static constexpr std::uint32_t NOT_STORED = 0xFFFFFFFFu;
+
+    /**
+     * @brief Clears the hash and sizes it for a set of particles.
+     *
+     * @param cellSize Edge length of a grid cell; roughly the typical query radius works well.
+     * @param particleCount Number of particles that will be stored.
+     */
+    void Reset(float cellSize, std::size_t particleCount);
+
+    /**
+     * @brief Removes every particle, keeping the cell size and all storage.
+     */
+    void Clear();
+
+    /**
+     * @brief Returns the edge length of a grid cell.
+     */
+    float GetCellSize() const { return 1.f / m_inverseCellSize; }
+
+    /**
+     * @brief Brings the hash up to date with the current particle positions.
+     *
+     * Every particle is checked; only those whose cell changed since the
+     * previous update are moved, and inactive particles are dropped.
+     *
+     * @param particles Particle storage the hash was sized for.
+     */
+    void Update(const ParticleBuffer& particles);
+
+    /**
+     * @brief Brings the particles [begin, end) up to date, like Update, leaving all others as they are.
+     *
+     * @param particles Particle storage the hash was sized for.
+     * @param begin First particle to check.
+     * @param end One past the last particle to check.
+     */
+    void Update(const ParticleBuffer& particles, std::uint32_t begin, std::uint32_t end);
+
+    /**
+     * @brief Brings the particles [begin, end) up to date like Update, finding those that changed cell on a thread pool.
+     *
+     * The particles are relinked on the calling thread in index order, so the
+     * buckets end up exactly as after the serial Update.
+     *
+     * @param particles Particle storage the hash was sized for.
+     * @param begin First particle to check.
+     * @param end One past the last particle to check.
+     * @param threadPool Threads scanning the range.
+     */
+    void Update(const ParticleBuffer& particles, std::uint32_t begin, std::uint32_t end, ThreadPool& threadPool);
+
+    /**
+     * @brief Collects all stored particles strictly inside a circle.
+     *
+     * @param particles Particle storage the hash was last updated with.
+     * @param x X-coordinate of the circle's center.
+     * @param y Y-coordinate of the circle's center.
+     * @param radius Radius of the circle.
+     * @param result Receives the indices of the particles found (cleared first).
+     */
+    void Query(const ParticleBuffer& particles, float x, float y, float radius, std::vector<std::uint32_t>& result);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @class SpscQueue
+ * @brief Fixed-capacity lock-free queue between one producer thread and one consumer thread.
+ *
+ * @tparam T Element type.
+ * @tparam Capacity Maximum number of queued elements plus one; must be a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    /**
+     * @brief Ring of element slots.
+     */
+    std::array<T, Capacity> m_items;
+
+    /**
+     * @brief Next slot to read (advanced by the consumer).
+     */
+    std::atomic<std::size_t> m_head{0};
+
+    /**
+     * @brief Next slot to write (advanced by the producer).
+     */
+    std::atomic<std::size_t> m_tail{0};
+
+public:
+    /**
+     * @brief Appends an element (producer thread only).
+     *
+     * @return False if the queue is full and the element was dropped.
+     */
+    bool Push(const T& item)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t next = (tail + 1) & (Capacity - 1);
+
+        if (next == m_head.load(std::memory_order_acquire)) { return false; }
+
+        m_items[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element (consumer thread only).
+     *
+     * @param item Receives the element.
+     * @return False if the queue was empty.
+     */
+    bool Pop(T& item)
+    {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire)) { return false; }
+
+        item = m_items[head];
+        m_head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+};
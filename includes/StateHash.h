@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Cloth.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @class StateHash
+ * @brief Fast 64-bit fingerprint of the simulation state, for comparing runs step by step.
+ *
+ * Covers the exact bits of every particle's position, last position, pin anchor and flags,
+ * and whether each constraint is intact. Two runs that hash equal after every
+ * step took bit-identical paths, so a diff of two hash logs (one line per step)
+ * pinpoints the first step where builds, thread counts or kernels disagree.
+ *
+ * The hash is not cryptographic; it only has to make accidental collisions
+ * between diverged states vanishingly unlikely, and be cheap enough to compute
+ * every step.
+ */
+class StateHash
+{
+public:
+    /**
+     * @brief Hashes the current state of a cloth.
+     *
+     * @param cloth Cloth to hash.
+     * @return Fingerprint of the state; equal states always give equal hashes.
+     */
+    static std::uint64_t Compute(const Cloth& cloth);
+
+    /**
+     * @brief Formats a hash as 16 lowercase hex digits, as written to hash logs.
+     */
+    static std::string ToHex(std::uint64_t hash);
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @class TaskGraph
+ * @brief Tasks with dependencies, run on a ThreadPool.
+ *
+ * A task is queued as soon as every task it depends on has finished, so
+ * independent branches run side by side while the rest keep their order.
+ * Tasks may use the pool themselves (e.g. a parallel-for inside a phase).
+ * The graph is built once and can be run any number of times; running it
+ * allocates nothing.
+ */
+class TaskGraph
+{
+public:
+    /// @brief Handle of a task, returned by Add.
+    using TaskId = std::uint32_t;
+
+private:
+    /**
+     * @brief A task and the tasks waiting for it.
+     */
+    struct Node
+    {
+        std::function<void()> body;
+        std::vector<TaskId> successors;
+        std::uint32_t dependencyCount = 0;
+    };
+
+    std::vector<Node> m_nodes;
+
+    /// @brief Per task, dependencies not yet finished in the current run.
+    std::unique_ptr<std::atomic<std::uint32_t>[]> m_remaining;
+
+    /// @brief Tasks of the current run not yet finished.
+    std::atomic<std::size_t> m_pending{0};
+
+    /// @brief Pool of the current run.
+    ThreadPool* m_pool = nullptr;
+
+    /**
+     * @brief Pool task: runs one node, then queues the successors it released.
+     */
+    static void RunNode(const void* context, std::size_t node, std::size_t);
+
+    /**
+     * @brief Queues a node whose dependencies have all finished.
+     */
+    void Submit(TaskId node);
+
+public:
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /**
+     * @brief Adds a task with no dependencies yet.
+     */
+    TaskId Add(std::function<void()> body);
+
+    /**
+     * @brief Makes after wait for before to finish.
+     */
+    void Precede(TaskId before, TaskId after);
+
+    /**
+     * @brief Removes every task.
+     */
+    void Clear();
+
+    /**
+     * @brief Runs every task once and returns when all have finished.
+     *
+     * The calling thread runs tasks too while it waits. Must not be called again
+     * before it returns.
+     *
+     * @param pool Threads sharing the tasks.
+     */
+    void Run(ThreadPool& pool);
+};
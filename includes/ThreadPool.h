@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Work-stealing scheduler shared by the solver, the renderer and task graphs.
+ *
+ * Every worker owns a deque of tasks: it pushes and pops at the back, while
+ * idle workers steal from the front of the others. Threads outside the pool
+ * submit through one shared deque. A thread waiting for its tasks keeps
+ * running queued ones meanwhile, so nested loops and task graphs never block a
+ * worker. A pool created with one thread has no workers and runs everything
+ * inline on the caller.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief A unit of work: run(context, begin, end), then pending is decremented.
+     */
+    struct Task
+    {
+        void (*run)(const void* context, std::size_t begin, std::size_t end) = nullptr;
+        const void* context = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        /// @brief Counter the submitter waits on; decremented once the task has run.
+        std::atomic<std::size_t>* pending = nullptr;
+    };
+
+private:
+    /**
+     * @brief Task deque of one thread; a ring buffer that grows but never shrinks.
+     */
+    struct Queue
+    {
+        std::mutex mutex;
+        std::vector<Task> ring;
+
+        /// @brief Steal end and owner end; both only grow, the ring index is taken modulo its size.
+        std::size_t head = 0;
+        std::size_t tail = 0;
+    };
+
+    /**
+     * @brief Deque 0 is shared by threads outside the pool, deque i belongs to worker i.
+     */
+    std::vector<std::unique_ptr<Queue>> m_queues;
+
+    /**
+     * @brief Worker threads (thread count - 1, the caller is the last one).
+     */
+    std::vector<std::thread> m_workers;
+
+    /**
+     * @brief Tasks sitting in any deque; idle workers sleep while it is zero.
+     */
+    std::atomic<std::size_t> m_queuedTasks{0};
+
+    /**
+     * @brief Idle workers sleep here until a task is queued or the pool shuts down.
+     */
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+
+    /**
+     * @brief Set when the pool is being destroyed.
+     */
+    std::atomic<bool> m_stop{false};
+
+    /**
+     * @brief Main loop of worker thread index (1-based, matching its deque).
+     */
+    void WorkerLoop(unsigned index);
+
+    /**
+     * @brief Returns the deque the calling thread pushes to and pops from.
+     */
+    unsigned GetOwnQueue() const;
+
+    /**
+     * @brief Takes a task from the thread's own deque, or steals one from another.
+     */
+    bool FindTask(unsigned ownQueue, Task& task);
+
+    /**
+     * @brief Runs a task and marks it finished.
+     */
+    static void Execute(const Task& task);
+
+    /**
+     * @brief Task body of ParallelFor: calls the loop body on one chunk.
+     */
+    static void RunChunk(const void* context, std::size_t begin, std::size_t end);
+
+public:
+    /**
+     * @brief Creates the pool.
+     *
+     * @param threadCount Total number of threads that execute tasks, including the caller.
+     *                    Zero picks the number of hardware threads.
+     */
+    explicit ThreadPool(unsigned threadCount);
+
+    /**
+     * @brief Stops and joins all workers. No task may still be queued.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the number of threads taking part in loops, including the caller.
+     */
+    unsigned GetThreadCount() const;
+
+    /**
+     * @brief Queues a task on the calling thread's deque and wakes an idle worker.
+     *
+     * The task's pending counter must already count it. With no workers the task
+     * runs inline before Submit returns.
+     */
+    void Submit(const Task& task);
+
+    /**
+     * @brief Runs queued tasks, own ones first, until pending drops to zero.
+     */
+    void Wait(const std::atomic<std::size_t>& pending);
+
+    /**
+     * @brief Runs body over [begin, end) split into chunks of at most grain indices.
+     *
+     * Blocks until every chunk has finished. Chunk boundaries are always
+     * begin + k * grain, whatever the thread count or whichever thread steals
+     * them. Ranges no larger than one chunk run inline on the calling thread
+     * without waking the workers. May be called from inside another task.
+     *
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param grain Maximum number of indices per chunk.
+     * @param body Called as body(chunkBegin, chunkEnd) for each chunk. Pass lambdas
+     *             through std::cref so the std::function is not heap-allocated per call.
+     */
+    void ParallelFor(std::size_t begin, std::size_t end, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file TrajectoryFormat.h
+ * @brief Shared layout and integer coding of trajectory files (see TrajectoryWriter).
+ *
+ * A file is a header, the constraint endpoints, then one record per frame:
+ *
+ *     uint32 payloadSize, payload
+ *
+ * The payload holds varints: the step index, the number of constraints whose
+ * state changed followed by (index delta, state byte) pairs, and then the
+ * zigzag-coded difference of every quantized x and y to the previous frame.
+ * The first frame is coded against zero. Positions are quantized to 16 bits
+ * across the simulation bounds.
+ */
+namespace TrajectoryFormat
+{
+    /// @brief File signature.
+    constexpr char MAGIC[8] = {'C', 'L', 'O', 'T', 'H', 'T', 'R', 'J'};
+
+    /// @brief Current format version; bumped on any layout change.
+    constexpr std::uint32_t VERSION = 1;
+
+    /// @brief Largest quantized coordinate, mapped to the far edge of the bounds.
+    constexpr float QUANT_MAX = 65535.f;
+
+    /**
+     * @brief Fixed-size file header.
+     */
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t particleCount;
+        std::uint32_t constraintCount;
+        float boundsWidth;
+        float boundsHeight;
+    };
+
+    /// @brief Maps a signed delta to an unsigned value with small magnitudes first (0, -1, 1, -2, ...).
+    inline std::uint32_t ZigZag(std::int32_t value)
+    {
+        return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+    }
+
+    /// @brief Inverse of ZigZag.
+    inline std::int32_t UnZigZag(std::uint32_t value)
+    {
+        return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+    }
+
+    /// @brief Appends a value in 7-bit groups, low group first; the high bit marks a continuation.
+    inline void PutVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /**
+     * @brief Reads a varint written by PutVarint.
+     *
+     * @param data Payload being read.
+     * @param size Payload size.
+     * @param offset Read position, advanced past the value.
+     * @param value Receives the value.
+     * @return False if the payload ends inside the value.
+     */
+    inline bool GetVarint(const std::uint8_t* data, std::size_t size, std::size_t& offset, std::uint64_t& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 64 && offset < size; shift += 7)
+        {
+            std::uint8_t byte = data[offset++];
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0) { return true; }
+        }
+
+        return false;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ClothSnapshot.h"
+#include "Constraint.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @class TrajectoryReader
+ * @brief Plays back a file written by TrajectoryWriter, one frame at a time.
+ *
+ * Frames are decoded into a ClothSnapshot, so playback draws through the same
+ * path as the pipelined viewer without stepping a Cloth at all.
+ */
+class TrajectoryReader
+{
+private:
+    /**
+     * @brief Input file, positioned at the next frame record.
+     */
+    std::ifstream m_file;
+
+    /**
+     * @brief File offset of the first frame, for Rewind.
+     */
+    std::streampos m_firstFrame;
+
+    /**
+     * @brief Constraint endpoints stored in the file header; rest lengths are not recorded.
+     */
+    std::vector<Constraint> m_constraints;
+
+    /// @brief Dequantization scale from 16-bit coordinates to simulation units.
+    float m_scaleX = 1.f;
+    float m_scaleY = 1.f;
+
+    /// @brief Quantized positions of the current frame, the reference of the next delta.
+    std::vector<std::uint16_t> m_x, m_y;
+
+    /// @brief Coded payload of the frame being read.
+    std::vector<std::uint8_t> m_payload;
+
+    /**
+     * @brief Number of frames read since Open or Rewind.
+     */
+    std::uint64_t m_framesRead = 0;
+
+public:
+    /**
+     * @brief Opens a trajectory file and reads its header.
+     *
+     * @param path File to read.
+     * @return False if the file is missing or not a trajectory of this version.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Returns whether a file is open.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Decodes the next frame.
+     *
+     * The frame's previous positions are set to the frame read before it, so
+     * it can be interpolated like a live snapshot.
+     *
+     * @param frame Receives the positions, constraint states and step index.
+     * @return False at the end of the file or on a damaged frame.
+     */
+    bool ReadFrame(ClothSnapshot& frame);
+
+    /**
+     * @brief Goes back to the first frame.
+     */
+    void Rewind();
+
+    /**
+     * @brief Returns the recorded constraint endpoints.
+     */
+    const std::vector<Constraint>& GetConstraints() const;
+
+    /**
+     * @brief Returns the number of particles in each frame.
+     */
+    std::size_t GetParticleCount() const;
+
+    /**
+     * @brief Returns how many frames were read since Open or Rewind.
+     */
+    std::uint64_t GetFramesRead() const;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Cloth.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class TrajectoryWriter
+ * @brief Streams every step of a Cloth to a compressed trajectory file.
+ *
+ * The simulation thread only quantizes positions into a preallocated frame slot
+ * and hands it over through a lock-free queue. Delta coding and file I/O happen
+ * on a background thread, so a slow disk never stalls a physics step. See
+ * TrajectoryFormat.h for the file layout; TrajectoryReader plays files back.
+ */
+class TrajectoryWriter
+{
+private:
+    /**
+     * @brief One captured step, quantized but not yet coded.
+     */
+    struct Frame
+    {
+        std::uint64_t step = 0;
+        std::vector<std::uint16_t> x, y;
+        std::vector<std::uint8_t> constraintStates;
+    };
+
+    /// @brief Number of frames that can be in flight between the two threads.
+    static constexpr std::uint32_t SLOT_COUNT = 32;
+
+    /**
+     * @brief Frame storage shared by both threads; ownership moves through the queues.
+     */
+    std::vector<Frame> m_frames;
+
+    /**
+     * @brief Slots ready to be filled (writer thread to simulation thread).
+     */
+    SpscQueue<std::uint32_t, 2 * SLOT_COUNT> m_freeSlots;
+
+    /**
+     * @brief Slots ready to be written (simulation thread to writer thread).
+     */
+    SpscQueue<std::uint32_t, 2 * SLOT_COUNT> m_filledSlots;
+
+    /**
+     * @brief Wakes the writer thread when a frame is queued or the file is closed.
+     */
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    /**
+     * @brief Background thread coding and writing frames.
+     */
+    std::thread m_thread;
+
+    /**
+     * @brief Keeps the writer thread running; cleared by Close.
+     */
+    std::atomic<bool> m_isRunning{false};
+
+    /**
+     * @brief Frames skipped because every slot was still waiting to be written.
+     */
+    std::atomic<std::uint64_t> m_droppedFrames{0};
+
+    /**
+     * @brief Output file; only touched by the writer thread while open.
+     */
+    std::ofstream m_file;
+
+    /// @brief Quantization scale from simulation units to 16-bit coordinates.
+    float m_scaleX = 1.f;
+    float m_scaleY = 1.f;
+
+    /// @brief Last written frame, the reference of the next delta (writer thread).
+    std::vector<std::uint16_t> m_lastX, m_lastY;
+    std::vector<std::uint8_t> m_lastStates;
+
+    /// @brief Coded payload of the frame being written (writer thread).
+    std::vector<std::uint8_t> m_payload;
+
+    /**
+     * @brief Writer thread: codes and writes queued frames until closed.
+     */
+    void WriterLoop();
+
+    /**
+     * @brief Codes one frame against the previous one and appends it to the file.
+     */
+    void WriteFrame(const Frame& frame);
+
+public:
+    TrajectoryWriter() = default;
+
+    /**
+     * @brief Closes the file, writing any queued frames first.
+     */
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    /**
+     * @brief Creates a trajectory file for a cloth and starts the writer thread.
+     *
+     * The particle count, constraint endpoints and bounds are fixed for the
+     * whole recording. Only structural constraints are recorded, since shear
+     * and bending constraints are never drawn.
+     *
+     * @param path File to write (overwritten).
+     * @param cloth Cloth that will be captured.
+     * @return False if the file could not be created.
+     */
+    bool Open(const std::string& path, const Cloth& cloth);
+
+    /**
+     * @brief Queues the current state of the cloth as the next frame.
+     *
+     * @param cloth The cloth given to Open.
+     * @param step Step index stored with the frame.
+     * @param waitForSlot Wait for the writer instead of dropping the frame when
+     *                    it is behind; for batch runs where every step matters.
+     * @return False if the frame was dropped.
+     */
+    bool Capture(const Cloth& cloth, std::uint64_t step, bool waitForSlot = false);
+
+    /**
+     * @brief Writes the remaining queued frames and closes the file.
+     */
+    void Close();
+
+    /**
+     * @brief Returns whether a recording is in progress.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Returns how many frames were dropped since Open.
+     */
+    std::uint64_t GetDroppedFrames() const;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief Lock-free hand-off of the latest value from one producer thread to one consumer thread.
+ *
+ * The producer fills the back slot and publishes it; the consumer acquires the
+ * most recently published slot. Neither side ever waits for the other, and the
+ * consumer always sees a complete value (never one being written).
+ *
+ * @tparam T Slot type; slots are reused, so vectors inside keep their capacity.
+ */
+template <typename T>
+class TripleBuffer
+{
+private:
+    /// @brief Bit set on the middle index when it holds a value the consumer has not seen.
+    static constexpr std::uint8_t FRESH = 1 << 2;
+
+    /// @brief Mask for the slot index part of the middle index.
+    static constexpr std::uint8_t INDEX = FRESH - 1;
+
+    /**
+     * @brief The three slots: one owned by each side plus the one in flight.
+     */
+    T m_slots[3];
+
+    /**
+     * @brief Slot being handed over, plus the FRESH bit.
+     */
+    std::atomic<std::uint8_t> m_middle{1};
+
+    /**
+     * @brief Slot owned by the producer.
+     */
+    std::uint8_t m_back = 0;
+
+    /**
+     * @brief Slot owned by the consumer.
+     */
+    std::uint8_t m_front = 2;
+
+public:
+    /**
+     * @brief Returns the slot the producer writes into (producer thread only).
+     */
+    T& GetBack() { return m_slots[m_back]; }
+
+    /**
+     * @brief Makes the back slot the latest value and takes a free slot as the new back (producer thread only).
+     */
+    void Publish()
+    {
+        std::uint8_t previous = m_middle.exchange(static_cast<std::uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+        m_back = previous & INDEX;
+    }
+
+    /**
+     * @brief Takes the latest published value, if there is one newer than the current front (consumer thread only).
+     *
+     * @return True if the front slot changed.
+     */
+    bool Acquire()
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) { return false; }
+
+        std::uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Returns the slot the consumer reads from (consumer thread only).
+     */
+    const T& GetFront() const { return m_slots[m_front]; }
+};
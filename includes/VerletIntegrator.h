@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ParticleBuffer.h"
+
+/**
+ * @struct VerletParams
+ * @brief Per-step constants shared by every particle in an integration batch.
+ */
+struct VerletParams
+{
+    /// @brief Time step (in seconds).
+    float deltaTime = 0.f;
+
+    /// @brief Drag coefficient; velocity is scaled by (1 - drag) each step.
+    float drag = 0.f;
+
+    /// @brief Acceleration applied to every free particle (e.g. gravity).
+    float accelerationX = 0.f;
+    float accelerationY = 0.f;
+
+    /// @brief Size of the area particles are clamped into, starting at (0, 0).
+    float boundsWidth = 0.f;
+    float boundsHeight = 0.f;
+};
+
+/**
+ * @class VerletIntegrator
+ * @brief Vectorized Verlet integration over a ParticleBuffer.
+ *
+ * Integrates, pins and clamps a whole batch of particles per instruction. The
+ * kernel is chosen at compile time: AVX2 (8 lanes) when the core is built with
+ * CLOTH_ENABLE_AVX2, SSE2 (4 lanes) on any other x86 target, and a scalar loop
+ * everywhere else. All three produce bit-identical results.
+ */
+class VerletIntegrator
+{
+public:
+    /**
+     * @brief Advances particles [begin, end) by one time step.
+     *
+     * Inactive particles are left untouched, pinned particles are snapped back
+     * to their pin anchor, and all others are integrated and kept inside
+     * the bounds.
+     *
+     * @param particles Particle storage to update in place.
+     * @param begin Index of the first particle to integrate.
+     * @param end One past the index of the last particle to integrate.
+     * @param params Step constants.
+     */
+    static void Integrate(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params);
+
+    /**
+     * @brief Same as Integrate, but always uses the scalar reference loop.
+     */
+    static void IntegrateScalar(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params);
+
+    /**
+     * @brief Returns the name of the kernel selected at compile time ("AVX2", "SSE2" or "Scalar").
+     */
+    static const char* GetKernelName();
+};
@@ -1,97 +1,1045 @@
 #include "Cloth.h"
-#include "ClothSimulation.h"
+#include "ClothConfig.h"
+#include "ConstraintKernel.h"
+#include "Profiler.h"
+#include "VerletIntegrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/// @brief Number of constraints each thread solves per chunk; small cloths stay on one thread.
+static constexpr std::size_t CONSTRAINT_GRAIN = 8192;
+
+/// @brief Consecutive resting steps before an island falls asleep (one second at the default physics rate).
+static constexpr std::uint32_t SLEEP_STEPS = 60;
 
 Cloth::Cloth(int width_size, int height_size, int gap, int start_x, int start_y, float gravity, float drag, float elasticity)
+    : Cloth(std::vector<ClothDesc>{ClothDesc{width_size, height_size, static_cast<float>(gap), static_cast<float>(start_x), static_cast<float>(start_y), gravity, drag, elasticity, PinMode::TopAlternate}})
+{
+}
+
+Cloth::Cloth() : Cloth(std::vector<ClothDesc>{})
+{
+}
+
+Cloth::Cloth(const std::vector<ClothDesc>& cloths)
+{
+    // Keep particles inside the default window area until told otherwise
+    m_boundsWidth = WIN_WIDTH;
+    m_boundsHeight = WIN_HEIGHT;
+
+    // Solve on the calling thread until told otherwise
+    m_threadPool = std::make_shared<ThreadPool>(1);
+
+    Build(cloths);
+}
+
+void Cloth::Rebuild(const std::vector<ClothDesc>& cloths)
+{
+    Build(cloths);
+}
+
+void Cloth::Reset()
+{
+    // Topology is unchanged, so only the state a step or a cut can modify is restored
+    m_particles.ResetToStart();
+
+    for (Constraint& constraint : m_constraints)
+    {
+        constraint.RestoreConstraint();
+    }
+
+    m_selectedConstraints.clear();
+    m_brushParticles.clear();
+    m_brushCommands.clear();
+    m_spatialHash.Clear();
+    m_isSpatialHashFilled = false;
+    m_lastStats = SolverStats();
+    m_isHierarchyDirty = true;
+    m_isSpringPatternDirty = true;
+    WakeAll();
+}
+
+void Cloth::Build(const std::vector<ClothDesc>& cloths)
 {
-    // Set physics parameters
-    m_gravity = {0.f, gravity};   // Gravity only in positive Y-direction
-    m_drag = drag;                // Air resistance factor
-    m_elasticity = elasticity;    // Constraint elasticity
+    // Every container is cleared rather than replaced, so it keeps its capacity:
+    // rebuilding at the same or a smaller size allocates nothing
+    m_cloths = cloths;
+    m_particles.Clear();
+    m_constraints.clear();
+    m_batches.clear();
+    m_clothParticleBegin.clear();
+    m_selectedConstraints.clear();
+    m_brushParticles.clear();
+    m_brushCommands.clear();
+    m_lastStats = SolverStats();
 
     // Pre-allocate space for performance
-    int total_particles = (width_size + 1) * (height_size + 1);
-    m_particles.reserve(total_particles);
-    m_constraints.reserve(2 * total_particles); // Two constraints per particle (horizontal and vertical)
+    std::size_t total_particles = 0;
+    for (const ClothDesc& desc : m_cloths)
+    {
+        total_particles += static_cast<std::size_t>(std::max(desc.widthCount, 0) + 1) * (std::max(desc.heightCount, 0) + 1);
+    }
+
+    m_particles.Reserve(total_particles);
+    m_constraints.reserve(6 * total_particles); // Two structural, two shear and two bending constraints per particle
+    m_particleConstraints.assign(2 * total_particles, NO_CONSTRAINT);
+    m_clothParticleBegin.reserve(m_cloths.size() + 1);
+
+    float largestGap = 1.f;
+
+    // Create each cloth's particles in a grid layout, cloth after cloth
+    for (ClothDesc& desc : m_cloths)
+    {
+        desc.widthCount = std::max(desc.widthCount, 0);
+        desc.heightCount = std::max(desc.heightCount, 0);
+        largestGap = std::max(largestGap, desc.gap);
+
+        m_clothParticleBegin.push_back(static_cast<std::uint32_t>(m_particles.Size()));
+
+        for (int y = 0; y <= desc.heightCount; y++)
+        {
+            for (int x = 0; x <= desc.widthCount; x++)
+            {
+                std::uint32_t particle = m_particles.Add(desc.startX + x * desc.gap, desc.startY + y * desc.gap);
+
+                bool isPinned = false;
+                switch (desc.pin)
+                {
+                    case PinMode::TopAlternate: isPinned = y == 0 && x % 2 == 0; break;
+                    case PinMode::Top: isPinned = y == 0; break;
+                    case PinMode::Corners: isPinned = y == 0 && (x == 0 || x == desc.widthCount); break;
+                    case PinMode::Left: isPinned = x == 0; break;
+                    case PinMode::None: break;
+                }
+
+                // Pinned particles fix the cloth in space
+                if (isPinned)
+                {
+                    m_particles.Pin(particle);
+                }
+            }
+        }
+    }
+
+    m_clothParticleBegin.push_back(static_cast<std::uint32_t>(m_particles.Size()));
+
+    // Index particles for cursor queries
+    m_spatialHash.Reset(2.f * largestGap, m_particles.Size());
+    m_isSpatialHashFilled = false;
+
+    // Split constraints into four colors so no two in a batch share a particle:
+    // horizontal links starting in even / odd columns, then vertical links starting in even / odd rows.
+    // Every color collects its links from all cloths, so the batch count does not grow with the cloth count.
+    for (int parity = 0; parity < 2; parity++)
+    {
+        ConstraintBatch batch;
+        batch.begin = static_cast<std::uint32_t>(m_constraints.size());
+
+        for (std::size_t cloth = 0; cloth < m_cloths.size(); cloth++)
+        {
+            const ClothDesc& desc = m_cloths[cloth];
+            const std::uint32_t first = m_clothParticleBegin[cloth];
+            const std::uint32_t row = desc.widthCount + 1;
+
+            for (int y = 0; y <= desc.heightCount; y++)
+            {
+                for (int x = parity; x < desc.widthCount; x += 2)
+                {
+                    // Link (x + 1, y) to its left neighbor (x, y)
+                    std::uint32_t particle = first + y * row + x + 1;
+                    m_constraints.emplace_back(particle, particle - 1, desc.gap);
+                }
+            }
+        }
+
+        batch.end = static_cast<std::uint32_t>(m_constraints.size());
+        m_batches.push_back(batch);
+    }
 
-    // Create particles in a grid layout
-    for (int y = 0; y <= height_size; y++)
+    for (int parity = 0; parity < 2; parity++)
     {
-        for (int x = 0; x <= width_size; x++)
+        ConstraintBatch batch;
+        batch.begin = static_cast<std::uint32_t>(m_constraints.size());
+
+        for (std::size_t cloth = 0; cloth < m_cloths.size(); cloth++)
         {
-            // Create a new particle at its grid position
-            m_particles.emplace_back(start_x + x * gap, start_y + y * gap);
-            Particle& particle = m_particles.back();
+            const ClothDesc& desc = m_cloths[cloth];
+            const std::uint32_t first = m_clothParticleBegin[cloth];
+            const std::uint32_t row = desc.widthCount + 1;
 
-            // Add horizontal constraint to the left neighbor
-            if (x != 0)
+            for (int y = parity; y < desc.heightCount; y += 2)
             {
-                // particle added just before current added particle
-                Particle& leftParticle = m_particles[m_particles.size() - 2];
+                for (int x = 0; x <= desc.widthCount; x++)
+                {
+                    // Link (x, y + 1) to its upper neighbor (x, y)
+                    std::uint32_t particle = first + (y + 1) * row + x;
+                    m_constraints.emplace_back(particle, particle - row, desc.gap);
+                }
+            }
+        }
 
-                m_constraints.emplace_back(particle, leftParticle, gap);
-                Constraint& c = m_constraints.back();
+        batch.end = static_cast<std::uint32_t>(m_constraints.size());
+        m_batches.push_back(batch);
+    }
 
-                // Add constraint references to both connected particles
-                leftParticle.AddConstraint(&c, 0); // 0 = horizontal
-                particle.AddConstraint(&c, 0);
+    // Shear: diagonal links of each grid cell, colored by the column they start in.
+    // First both parities of the "\" diagonal, then both of the "/" diagonal.
+    for (int diagonal = 0; diagonal < 2; diagonal++)
+    {
+        for (int parity = 0; parity < 2; parity++)
+        {
+            ConstraintBatch batch;
+            batch.begin = static_cast<std::uint32_t>(m_constraints.size());
+            batch.type = ConstraintType::Shear;
+
+            for (std::size_t cloth = 0; cloth < m_cloths.size(); cloth++)
+            {
+                const ClothDesc& desc = m_cloths[cloth];
+                const std::uint32_t first = m_clothParticleBegin[cloth];
+                const std::uint32_t row = desc.widthCount + 1;
+                const float length = desc.gap * std::sqrt(2.f);
+
+                for (int y = 0; y < desc.heightCount; y++)
+                {
+                    for (int x = parity; x < desc.widthCount; x += 2)
+                    {
+                        // Link the lower corner of the cell's diagonal to its upper corner
+                        std::uint32_t upper = first + y * row + x + diagonal;
+                        std::uint32_t lower = first + (y + 1) * row + x + 1 - diagonal;
+                        m_constraints.emplace_back(lower, upper, length, ConstraintType::Shear);
+                    }
+                }
             }
 
-            // Add vertical constraint to the upper neighbor
-            if (y != 0)
+            batch.end = static_cast<std::uint32_t>(m_constraints.size());
+            m_batches.push_back(batch);
+        }
+    }
+
+    // Bending: links skipping one particle, horizontal then vertical. Links starting
+    // in columns (rows) 0-1, 4-5, ... share no particles, nor do those starting in 2-3, 6-7, ...
+    for (int parity = 0; parity < 2; parity++)
+    {
+        ConstraintBatch batch;
+        batch.begin = static_cast<std::uint32_t>(m_constraints.size());
+        batch.type = ConstraintType::Bending;
+
+        for (std::size_t cloth = 0; cloth < m_cloths.size(); cloth++)
+        {
+            const ClothDesc& desc = m_cloths[cloth];
+            const std::uint32_t first = m_clothParticleBegin[cloth];
+            const std::uint32_t row = desc.widthCount + 1;
+
+            for (int y = 0; y <= desc.heightCount; y++)
             {
-                // particle at (x, y - 1) coordinates of the current (x, y) particle
-                Particle& upParticle = m_particles[x + (y - 1) * (width_size + 1)];
+                for (int x = 0; x + 1 < desc.widthCount; x++)
+                {
+                    if ((x / 2) % 2 != parity) continue;
 
-                m_constraints.emplace_back(particle, upParticle, gap);
-                Constraint& c = m_constraints.back();
+                    // Link (x + 2, y) to (x, y)
+                    std::uint32_t particle = first + y * row + x + 2;
+                    m_constraints.emplace_back(particle, particle - 2, 2.f * desc.gap, ConstraintType::Bending);
+                }
+            }
+        }
+
+        batch.end = static_cast<std::uint32_t>(m_constraints.size());
+        m_batches.push_back(batch);
+    }
+
+    for (int parity = 0; parity < 2; parity++)
+    {
+        ConstraintBatch batch;
+        batch.begin = static_cast<std::uint32_t>(m_constraints.size());
+        batch.type = ConstraintType::Bending;
 
-                // Add constraint references to both connected particles
-                upParticle.AddConstraint(&c, 1); // 1 = vertical
-                particle.AddConstraint(&c, 1);
+        for (std::size_t cloth = 0; cloth < m_cloths.size(); cloth++)
+        {
+            const ClothDesc& desc = m_cloths[cloth];
+            const std::uint32_t first = m_clothParticleBegin[cloth];
+            const std::uint32_t row = desc.widthCount + 1;
+
+            for (int y = 0; y + 1 < desc.heightCount; y++)
+            {
+                if ((y / 2) % 2 != parity) continue;
+
+                for (int x = 0; x <= desc.widthCount; x++)
+                {
+                    // Link (x, y + 2) to (x, y)
+                    std::uint32_t particle = first + (y + 2) * row + x;
+                    m_constraints.emplace_back(particle, particle - 2 * row, 2.f * desc.gap, ConstraintType::Bending);
+                }
             }
+        }
+
+        batch.end = static_cast<std::uint32_t>(m_constraints.size());
+        m_batches.push_back(batch);
+    }
+
+    // Record each particle's horizontal (slot 0) and vertical (slot 1) constraint.
+    // Links to the right / lower neighbor take precedence over the left / upper one.
+    for (std::size_t b = 0; b < 4; b++)
+    {
+        // First two batches are horizontal, last two vertical
+        int slot = b < 2 ? 0 : 1;
+
+        for (std::uint32_t c = m_batches[b].begin; c < m_batches[b].end; c++)
+        {
+            const Constraint& constraint = m_constraints[c];
+
+            // p_2 is the left / upper particle, so this is its right / lower link
+            m_particleConstraints[2 * constraint.p_2 + slot] = c;
 
-            // Pin every second particle on the top row to fix the cloth in space
-            if (y == 0 && x % 2 == 0)
+            if (m_particleConstraints[2 * constraint.p_1 + slot] == NO_CONSTRAINT)
             {
-                particle.Pin();
+                m_particleConstraints[2 * constraint.p_1 + slot] = c;
             }
         }
     }
+
+    BuildSoftConstraintIndex();
+    BuildHierarchy();
+    m_isSpringPatternDirty = true;
+    WakeAll();
+}
+
+void Cloth::BuildHierarchy()
+{
+    m_hierarchy.Build(m_cloths, m_clothParticleBegin, m_particleConstraints, m_solverSettings.multigridLevels);
+    m_isHierarchyDirty = true;
 }
 
-void Cloth::Update(float deltaTime, sf::RenderWindow& win, sf::Vector2i& mousePos, sf::Vector2i& lastMousePos)
+void Cloth::BuildSoftConstraintIndex()
 {
-    // Update each particle's position and apply physics
-    for (Particle& particle : m_particles)
+    // Count each particle's shear and bending links, then fill the rows in constraint order
+    m_softConstraintBegin.assign(m_particles.Size() + 1, 0);
+
+    for (const Constraint& constraint : m_constraints)
     {
-        particle.Update(deltaTime, win, mousePos, lastMousePos, CURSOR_SIZE, m_drag, m_gravity, m_elasticity, WIN_WIDTH, WIN_HEIGHT);
+        if (constraint.GetType() == ConstraintType::Structural) continue;
+
+        m_softConstraintBegin[constraint.p_1 + 1]++;
+        m_softConstraintBegin[constraint.p_2 + 1]++;
+
+        // A bending link also belongs to the particle it skips, so cutting that one tears it
+        if (constraint.GetType() == ConstraintType::Bending)
+        {
+            m_softConstraintBegin[(constraint.p_1 + constraint.p_2) / 2 + 1]++;
+        }
     }
 
-    // Enforce constraints to maintain cloth structure
-    for (Constraint& constraint : m_constraints)
+    for (std::size_t i = 0; i < m_particles.Size(); i++)
     {
-        constraint.Update();
+        m_softConstraintBegin[i + 1] += m_softConstraintBegin[i];
     }
+
+    m_softConstraints.resize(m_softConstraintBegin.back());
+
+    // Use each row's begin as its fill cursor; afterwards it holds the next row's begin
+    for (std::uint32_t c = 0; c < m_constraints.size(); c++)
+    {
+        const Constraint& constraint = m_constraints[c];
+        if (constraint.GetType() == ConstraintType::Structural) continue;
+
+        m_softConstraints[m_softConstraintBegin[constraint.p_1]++] = c;
+        m_softConstraints[m_softConstraintBegin[constraint.p_2]++] = c;
+
+        if (constraint.GetType() == ConstraintType::Bending)
+        {
+            m_softConstraints[m_softConstraintBegin[(constraint.p_1 + constraint.p_2) / 2]++] = c;
+        }
+    }
+
+    // Shift the cursors back into row begins
+    for (std::size_t i = m_particles.Size(); i > 0; i--)
+    {
+        m_softConstraintBegin[i] = m_softConstraintBegin[i - 1];
+    }
+    m_softConstraintBegin[0] = 0;
 }
 
-void Cloth::RenderCloth(sf::RenderWindow& win)
+void Cloth::SetBounds(int width, int height)
 {
-    // Create a line list to draw all active constraints
-    sf::VertexArray lines(sf::PrimitiveType::Lines);
+    m_boundsWidth = width;
+    m_boundsHeight = height;
+    WakeAll();
+}
 
-    for (Constraint& constraint : m_constraints)
+int Cloth::GetBoundsWidth() const { return m_boundsWidth; }
+
+int Cloth::GetBoundsHeight() const { return m_boundsHeight; }
+
+void Cloth::SetThreadCount(unsigned threadCount)
+{
+    m_threadPool = std::make_shared<ThreadPool>(threadCount);
+}
+
+void Cloth::SetThreadPool(std::shared_ptr<ThreadPool> threadPool)
+{
+    m_threadPool = threadPool ? std::move(threadPool) : std::make_shared<ThreadPool>(1);
+}
+
+void Cloth::SetReferenceSolver(bool isReference) { m_isReferenceSolver = isReference; }
+
+bool Cloth::IsReferenceSolver() const { return m_isReferenceSolver; }
+
+void Cloth::SetSolverSettings(const SolverSettings& settings)
+{
+    const int levelCount = m_solverSettings.multigridLevels;
+
+    m_solverSettings = settings;
+    m_solverSettings.minIterations = std::max(m_solverSettings.minIterations, 1);
+    m_solverSettings.maxIterations = std::max(m_solverSettings.maxIterations, m_solverSettings.minIterations);
+    m_solverSettings.multigridLevels = std::clamp(m_solverSettings.multigridLevels, 0, ConstraintHierarchy::MAX_LEVELS);
+    m_solverSettings.sleepSpeed = std::max(m_solverSettings.sleepSpeed, 0.f);
+    m_solverSettings.structuralCompliance = std::max(m_solverSettings.structuralCompliance, 0.f);
+    m_solverSettings.shearCompliance = std::max(m_solverSettings.shearCompliance, 0.f);
+    m_solverSettings.bendingCompliance = std::max(m_solverSettings.bendingCompliance, 0.f);
+
+    m_solverSettings.springStiffness = std::max(m_solverSettings.springStiffness, 0.f);
+    m_solverSettings.cgMaxIterations = std::max(m_solverSettings.cgMaxIterations, 1);
+    m_solverSettings.cgTolerance = std::max(m_solverSettings.cgTolerance, 0.f);
+
+    if (m_solverSettings.multigridLevels != levelCount)
     {
-        // Skip inactive constraints
-        if (!constraint.IsActive()) continue;
+        BuildHierarchy();
+    }
+
+    // Spring stiffness and which types become springs may have changed
+    m_isSpringPatternDirty = true;
 
-        // Highlight selected constraints in red
-        sf::Color color = constraint.IsSelected() ? sf::Color::Red : sf::Color::White;
+    WakeAll();
+}
 
-        // Added the vertices of the line in vertex array
-        lines.append(sf::Vertex{constraint.p_1.GetPos(), color});
-        lines.append(sf::Vertex{constraint.p_2.GetPos(), color});
+void Cloth::SetColliders(const std::vector<Collider>& colliders)
+{
+    m_colliders.Clear();
+    for (const Collider& collider : colliders)
+    {
+        m_colliders.Add(collider);
     }
+    m_colliders.Build();
+    WakeAll();
+}
+
+const std::vector<Collider>& Cloth::GetColliders() const { return m_colliders.GetColliders(); }
+
+const SolverSettings& Cloth::GetSolverSettings() const { return m_solverSettings; }
+
+const SolverStats& Cloth::GetLastStepStats() const { return m_lastStats; }
+
+void Cloth::Update(float deltaTime, const ClothInput& input)
+{
+    IntegrateParticles(deltaTime, input);
+    SolveConstraints(deltaTime);
+    SolveSelfCollisions();
+    ResolveColliders();
+    UpdateSpatialHash();
+    UpdateSleep();
+}
 
-    // Render all constraint lines to the window
-    win.draw(lines);
+TaskGraph::TaskId Cloth::AddStepTasks(TaskGraph& graph, const float& deltaTime, const ClothInput& input)
+{
+    const TaskGraph::TaskId integrate = graph.Add([this, &deltaTime, &input] { IntegrateParticles(deltaTime, input); });
+    const TaskGraph::TaskId constraints = graph.Add([this, &deltaTime] { SolveConstraints(deltaTime); });
+    const TaskGraph::TaskId selfCollisions = graph.Add([this] { SolveSelfCollisions(); });
+    const TaskGraph::TaskId colliders = graph.Add([this] { ResolveColliders(); });
+    const TaskGraph::TaskId spatialHash = graph.Add([this] { UpdateSpatialHash(); });
+    const TaskGraph::TaskId sleep = graph.Add([this] { UpdateSleep(); });
+
+    graph.Precede(integrate, constraints);
+    graph.Precede(constraints, selfCollisions);
+    graph.Precede(selfCollisions, colliders);
+    graph.Precede(colliders, spatialHash);
+    graph.Precede(spatialHash, sleep);
+
+    return sleep;
+}
+
+void Cloth::IntegrateParticles(float deltaTime, const ClothInput& input)
+{
+    PROFILE_SCOPE("Integrate");
+
+    // Keep the state this step starts from for render interpolation
+    m_particles.StorePreviousPositions();
+
+    // Brushes run first so the integration loop stays free of branches on input
+    ApplyBrushes(input);
+
+    // Leave out islands that are asleep after the input has woken or torn them
+    UpdateIslands();
+
+    if (m_solverSettings.integrator == IntegratorType::ImplicitEuler)
+    {
+        // The sparsity pattern is cached; only tearing or new settings rebuild it
+        if (m_isSpringPatternDirty)
+        {
+            m_implicitIntegrator.Build(m_particles, m_constraints, m_cloths, m_clothParticleBegin, m_solverSettings);
+            m_isSpringPatternDirty = false;
+        }
+
+        m_implicitIntegrator.Step(m_particles, deltaTime, static_cast<float>(m_boundsWidth), static_cast<float>(m_boundsHeight), m_solverSettings, *m_threadPool);
+        return;
+    }
+
+    // Integrate all particles a SIMD batch at a time
+    VerletParams params;
+    params.deltaTime = deltaTime;
+    params.accelerationX = 0.f;
+    params.boundsWidth = static_cast<float>(m_boundsWidth);
+    params.boundsHeight = static_cast<float>(m_boundsHeight);
+
+    for (const ParticleRun& run : m_particleRuns)
+    {
+        params.drag = m_cloths[run.cloth].drag;
+        params.accelerationY = m_cloths[run.cloth].gravity;   // Gravity only in positive Y-direction
+
+        if (m_isReferenceSolver)
+        {
+            VerletIntegrator::IntegrateScalar(m_particles, run.begin, run.end, params);
+        }
+        else
+        {
+            VerletIntegrator::Integrate(m_particles, run.begin, run.end, params);
+        }
+    }
+}
+
+void Cloth::UpdateIslands()
+{
+    if (m_areIslandsDirty && m_solverSettings.sleepSpeed > 0.f)
+    {
+        m_islands.Build(m_particles, m_constraints);
+        m_areIslandsDirty = false;
+        m_areRunsDirty = true;
+    }
+
+    if (m_areRunsDirty)
+    {
+        BuildRuns();
+        m_areRunsDirty = false;
+
+        // Tethers of sleeping islands are left out
+        m_isHierarchyDirty = true;
+    }
+}
+
+void Cloth::BuildRuns()
+{
+    m_particleRuns.clear();
+    m_awakeBatches.clear();
+
+    const std::uint8_t* flags = m_particles.GetFlags();
+
+    // Neighbouring cloths with the same parameters are integrated as one run, split around sleeping particles
+    std::size_t cloth = 0;
+    while (cloth < m_cloths.size())
+    {
+        std::size_t last = cloth + 1;
+        while (last < m_cloths.size() && m_cloths[last].gravity == m_cloths[cloth].gravity && m_cloths[last].drag == m_cloths[cloth].drag)
+        {
+            last++;
+        }
+
+        ParticleRun run;
+        run.begin = m_clothParticleBegin[cloth];
+        run.cloth = static_cast<std::uint32_t>(cloth);
+
+        for (std::uint32_t i = run.begin; i < m_clothParticleBegin[last]; i++)
+        {
+            if (!(flags[i] & PARTICLE_SLEEPING)) continue;
+
+            if (i > run.begin)
+            {
+                run.end = i;
+                m_particleRuns.push_back(run);
+            }
+            run.begin = i + 1;
+        }
+
+        run.end = m_clothParticleBegin[last];
+        if (run.end > run.begin)
+        {
+            m_particleRuns.push_back(run);
+        }
+
+        cloth = last;
+    }
+
+    // Active constraints never join two islands, so one sleeping end marks a constraint of a sleeping island.
+    // Inactive constraints are skipped by the kernels anyway and do not split a batch.
+    for (const ConstraintBatch& batch : m_batches)
+    {
+        ConstraintBatch awake = batch;
+
+        for (std::uint32_t c = batch.begin; c < batch.end; c++)
+        {
+            const Constraint& constraint = m_constraints[c];
+            if (!constraint.IsActive() || !(flags[constraint.p_1] & PARTICLE_SLEEPING)) continue;
+
+            if (c > awake.begin)
+            {
+                awake.end = c;
+                m_awakeBatches.push_back(awake);
+            }
+            awake.begin = c + 1;
+        }
+
+        awake.end = batch.end;
+        if (awake.end > awake.begin)
+        {
+            m_awakeBatches.push_back(awake);
+        }
+    }
+}
+
+void Cloth::WakeAll()
+{
+    m_particles.WakeAll();
+    m_areIslandsDirty = true;
+    m_areRunsDirty = true;
+}
+
+void Cloth::SolveConstraints(float deltaTime)
+{
+    PROFILE_SCOPE("Constraints");
+
+    // The implicit step already solved for the springs; only report how it went
+    if (m_solverSettings.integrator == IntegratorType::ImplicitEuler)
+    {
+        m_lastStats = SolverStats();
+        m_lastStats.iterations = m_implicitIntegrator.GetLastIterations();
+        m_lastStats.residual = m_implicitIntegrator.GetLastResidual();
+        return;
+    }
+
+    const bool isCompliant = m_solverSettings.model == ConstraintModel::Compliance;
+
+    // Remove long-range stretch on the coarse grids, so the passes below only have local error left.
+    // Rigid tethers would take the give out of compliant threads, so those skip this.
+    if (!m_hierarchy.IsEmpty() && !(isCompliant && m_solverSettings.structuralCompliance > 0.f))
+    {
+        PROFILE_SCOPE("Multigrid");
+
+        if (m_isHierarchyDirty)
+        {
+            m_hierarchy.Refresh(m_constraints, m_particles);
+            m_isHierarchyDirty = false;
+        }
+
+        m_hierarchy.Solve(m_particles, *m_threadPool, m_isReferenceSolver);
+    }
+
+    // Multipliers start from zero every step and build up over its passes
+    if (isCompliant)
+    {
+        m_lambdas.assign(m_constraints.size(), 0.f);
+    }
+
+    // Enforce constraints, repeating passes until the residual is small enough or the budget runs out
+    m_lastStats = SolverStats();
+
+    for (int iteration = 0; iteration < m_solverSettings.maxIterations; iteration++)
+    {
+        m_lastStats.residual = SolveConstraintPass(deltaTime);
+        m_lastStats.iterations = iteration + 1;
+
+        if (m_lastStats.iterations >= m_solverSettings.minIterations && m_lastStats.residual <= m_solverSettings.tolerance)
+        {
+            break;
+        }
+    }
+}
+
+void Cloth::SolveSelfCollisions()
+{
+    if (m_solverSettings.selfCollisionDistance <= 0.f) { return; }
+
+    PROFILE_SCOPE("SelfCollision");
+
+    // Sleeping particles do not push each other, so with everything asleep there is nothing to do
+    if (m_particleRuns.empty())
+    {
+        m_selfCollision.Clear();
+        m_lastStats.contacts = 0;
+        return;
+    }
+
+    m_selfCollision.Solve(m_particles, m_solverSettings.selfCollisionDistance, *m_threadPool);
+    m_lastStats.contacts = m_selfCollision.GetLastContactCount();
+}
+
+void Cloth::ResolveColliders()
+{
+    if (m_colliders.IsEmpty()) { return; }
+
+    PROFILE_SCOPE("Colliders");
+
+    m_colliders.Resolve(m_particles, *m_threadPool);
+}
+
+void Cloth::UpdateSpatialHash()
+{
+    if (!m_isSpatialHashFilled) { return; }
+
+    PROFILE_SCOPE("SpatialHash");
+
+    // Only awake particles moved; islands falling asleep below are still in the runs
+    for (const ParticleRun& run : m_particleRuns)
+    {
+        m_spatialHash.Update(m_particles, run.begin, run.end, *m_threadPool);
+    }
+}
+
+void Cloth::UpdateSleep()
+{
+    if (m_solverSettings.sleepSpeed <= 0.f || m_areIslandsDirty) { return; }
+
+    PROFILE_SCOPE("Sleep");
+
+    // Awake particles running into a sleeping island wake it; those merely resting against it do not
+    if (m_solverSettings.selfCollisionDistance > 0.f)
+    {
+        const float* x = m_particles.GetX();
+        const float* y = m_particles.GetY();
+        const float* previousX = m_particles.GetPreviousX();
+        const float* previousY = m_particles.GetPreviousY();
+        const float sleepSpeedSquared = m_solverSettings.sleepSpeed * m_solverSettings.sleepSpeed;
+
+        for (const SelfCollision::SleepingContact& contact : m_selfCollision.GetSleepingContacts())
+        {
+            const float deltaX = x[contact.particle] - previousX[contact.particle];
+            const float deltaY = y[contact.particle] - previousY[contact.particle];
+
+            if (deltaX * deltaX + deltaY * deltaY >= sleepSpeedSquared)
+            {
+                m_islands.Wake(contact.sleeper);
+            }
+        }
+
+        if (m_islands.ApplyWakes(m_particles))
+        {
+            m_areRunsDirty = true;
+        }
+    }
+
+    // Islands falling asleep now may still have moved a little this step, so they are not checked above
+    if (m_islands.Update(m_particles, m_particleRuns, m_solverSettings.sleepSpeed, SLEEP_STEPS))
+    {
+        m_areRunsDirty = true;
+    }
+}
+
+std::size_t Cloth::GetIslandCount() const
+{
+    return m_solverSettings.sleepSpeed > 0.f && !m_areIslandsDirty ? m_islands.GetIslandCount() : 0;
+}
+
+std::size_t Cloth::GetSleepingIslandCount() const
+{
+    return m_solverSettings.sleepSpeed > 0.f && !m_areIslandsDirty ? m_islands.GetSleepingCount() : 0;
+}
+
+float Cloth::SolveConstraintPass(float deltaTime)
+{
+    // One residual slot per chunk of every structural batch; constraints of sleeping islands are left out
+    std::size_t chunkCount = 0;
+    for (const ConstraintBatch& batch : m_awakeBatches)
+    {
+        if (batch.type != ConstraintType::Structural) continue;
+
+        chunkCount += (batch.end - batch.begin + CONSTRAINT_GRAIN - 1) / CONSTRAINT_GRAIN;
+    }
+    m_chunkResiduals.resize(chunkCount);
+
+    // Solve one color batch at a time. Constraints within a batch are independent,
+    // so splitting them across threads gives the same result as solving them serially.
+    std::size_t chunkOffset = 0;
+    Constraint* constraints = m_constraints.data();
+
+    // XPBD compliances act through alpha = compliance / dt^2, which keeps the material independent of the step rate
+    const bool isCompliant = m_solverSettings.model == ConstraintModel::Compliance;
+    const float inverseDeltaTimeSquared = 1.f / (deltaTime * deltaTime);
+    float* lambdas = m_lambdas.data();
+
+    for (const ConstraintBatch& batch : m_awakeBatches)
+    {
+        if (isCompliant)
+        {
+            if (batch.type != ConstraintType::Structural)
+            {
+                // Shear and bending are still switched off by a zero stiffness
+                const float stiffness = batch.type == ConstraintType::Shear ? m_solverSettings.shearStiffness : m_solverSettings.bendingStiffness;
+                if (stiffness <= 0.f) continue;
+            }
+
+            const float compliance = batch.type == ConstraintType::Structural ? m_solverSettings.structuralCompliance
+                                   : batch.type == ConstraintType::Shear ? m_solverSettings.shearCompliance
+                                                                         : m_solverSettings.bendingCompliance;
+            const float alpha = compliance * inverseDeltaTimeSquared;
+            const bool isStructural = batch.type == ConstraintType::Structural;
+
+            auto solve = [this, constraints, lambdas, &batch, chunkOffset, alpha, isStructural](std::size_t begin, std::size_t end)
+            {
+                ConstraintResidual* residual = nullptr;
+                if (isStructural)
+                {
+                    residual = &m_chunkResiduals[chunkOffset + (begin - batch.begin) / CONSTRAINT_GRAIN];
+                    *residual = ConstraintResidual();
+                }
+
+                if (m_isReferenceSolver)
+                {
+                    ConstraintKernel::SolveCompliantScalar(batch.type, constraints, begin, end, m_particles, alpha, lambdas, residual);
+                }
+                else
+                {
+                    ConstraintKernel::SolveCompliant(batch.type, constraints, begin, end, m_particles, alpha, lambdas, residual);
+                }
+            };
+
+            m_threadPool->ParallelFor(batch.begin, batch.end, CONSTRAINT_GRAIN, std::cref(solve));
+
+            if (isStructural)
+            {
+                chunkOffset += (batch.end - batch.begin + CONSTRAINT_GRAIN - 1) / CONSTRAINT_GRAIN;
+            }
+            continue;
+        }
+
+        if (batch.type == ConstraintType::Structural)
+        {
+            // Only the threads of the cloth count towards the residual
+            auto solve = [this, constraints, &batch, chunkOffset](std::size_t begin, std::size_t end)
+            {
+                ConstraintResidual& residual = m_chunkResiduals[chunkOffset + (begin - batch.begin) / CONSTRAINT_GRAIN];
+                residual = ConstraintResidual();
+
+                if (!m_isReferenceSolver)
+                {
+                    ConstraintKernel::Solve(ConstraintType::Structural, constraints, begin, end, m_particles, 1.f, &residual);
+                    return;
+                }
+
+                // One constraint at a time, counting violations the way the kernel does
+                for (std::size_t c = begin; c < end; c++)
+                {
+                    if (!constraints[c].IsActive()) continue;
+
+                    const float violation = constraints[c].Update(m_particles);
+                    residual.maxViolation = std::max(residual.maxViolation, violation);
+                    residual.sumSquares += violation * violation;
+                    residual.activeCount++;
+                }
+            };
+
+            m_threadPool->ParallelFor(batch.begin, batch.end, CONSTRAINT_GRAIN, std::cref(solve));
+            chunkOffset += (batch.end - batch.begin + CONSTRAINT_GRAIN - 1) / CONSTRAINT_GRAIN;
+            continue;
+        }
+
+        // Shear and bending batches are skipped entirely when their stiffness is zero
+        const float stiffness = batch.type == ConstraintType::Shear ? m_solverSettings.shearStiffness : m_solverSettings.bendingStiffness;
+        if (stiffness <= 0.f) continue;
+
+        auto solve = [this, constraints, &batch, stiffness](std::size_t begin, std::size_t end)
+        {
+            if (m_isReferenceSolver)
+            {
+                ConstraintKernel::SolveScalar(batch.type, constraints, begin, end, m_particles, stiffness, nullptr);
+            }
+            else
+            {
+                ConstraintKernel::Solve(batch.type, constraints, begin, end, m_particles, stiffness, nullptr);
+            }
+        };
+
+        m_threadPool->ParallelFor(batch.begin, batch.end, CONSTRAINT_GRAIN, std::cref(solve));
+    }
+
+    // Combine chunks in order so the result does not depend on the thread count
+    float maxViolation = 0.f;
+    float sumSquares = 0.f;
+    std::uint32_t activeCount = 0;
+
+    for (const ConstraintResidual& residual : m_chunkResiduals)
+    {
+        maxViolation = std::max(maxViolation, residual.maxViolation);
+        sumSquares += residual.sumSquares;
+        activeCount += residual.activeCount;
+    }
+
+    if (m_solverSettings.norm == ResidualNorm::Max)
+    {
+        return maxViolation;
+    }
+
+    return activeCount > 0 ? std::sqrt(sumSquares / activeCount) : 0.f;
+}
+
+void Cloth::QueueBrush(const BrushCommand& command) { m_brushCommands.push_back(command); }
+
+void Cloth::ApplyBrushes(const ClothInput& input)
+{
+    // Clear last step's highlight
+    for (std::uint32_t c : m_selectedConstraints)
+    {
+        m_constraints[c].SetIsSelected(false);
+    }
+    m_selectedConstraints.clear();
+
+    // The cursor is one more brush, after those queued since the last step
+    if (input.cursorSize > 0.f)
+    {
+        const sf::Vector2f mouseDelta = static_cast<sf::Vector2f>(input.mousePos - input.lastMousePos);
+
+        BrushCommand cursor;
+        cursor.x = static_cast<float>(input.mousePos.x);
+        cursor.y = static_cast<float>(input.mousePos.y);
+        cursor.radius = input.cursorSize;
+        cursor.deltaX = mouseDelta.x;
+        cursor.deltaY = mouseDelta.y;
+        cursor.actions = BRUSH_SELECT;
+        if (input.isDragging) cursor.actions |= BRUSH_DRAG;
+        if (input.isPinning) cursor.actions |= BRUSH_PIN;
+        if (input.isCutting) cursor.actions |= BRUSH_CUT;
+
+        m_brushCommands.push_back(cursor);
+    }
+
+    if (m_brushCommands.empty()) { return; }
+
+    // Positions do not change while brushes are applied, so one index serves them all.
+    // Once filled, the end of every step keeps it current, so it is only queried here.
+    if (!m_isSpatialHashFilled)
+    {
+        m_spatialHash.Update(m_particles);
+        m_isSpatialHashFilled = true;
+    }
+
+    for (const BrushCommand& brush : m_brushCommands)
+    {
+        ApplyBrush(brush);
+    }
+
+    m_brushCommands.clear();
+}
+
+void Cloth::ApplyBrush(const BrushCommand& brush)
+{
+    // Find the particles under the brush; only those are touched below
+    m_spatialHash.Query(m_particles, brush.x, brush.y, brush.radius, m_brushParticles);
+
+    // Editing wakes the islands under the brush before anything is moved, pinned or torn
+    if ((brush.actions & (BRUSH_DRAG | BRUSH_PIN | BRUSH_CUT)) && !m_areIslandsDirty)
+    {
+        for (std::uint32_t i : m_brushParticles)
+        {
+            m_islands.Wake(i);
+        }
+
+        if (m_islands.ApplyWakes(m_particles))
+        {
+            m_areRunsDirty = true;
+        }
+    }
+
+    float* x = m_particles.GetX();
+    float* y = m_particles.GetY();
+    float* lastX = m_particles.GetLastX();
+    float* lastY = m_particles.GetLastY();
+
+    for (std::uint32_t i : m_brushParticles)
+    {
+        // Cut by an earlier brush of this step
+        if (!m_particles.IsActive(i)) continue;
+
+        // Highlight the constraints of the selected particle
+        if (brush.actions & BRUSH_SELECT)
+        {
+            for (int slot = 0; slot < 2; slot++)
+            {
+                std::uint32_t c = m_particleConstraints[2 * i + slot];
+                if (c != NO_CONSTRAINT && !m_constraints[c].IsSelected())
+                {
+                    m_constraints[c].SetIsSelected(true);
+                    m_selectedConstraints.push_back(c);
+                }
+            }
+        }
+
+        // Drag: update last position so that the Verlet step moves the particle.
+        // Movement is clamped with the cloth's elasticity factor to avoid unrealistic snapping.
+        if (brush.actions & BRUSH_DRAG)
+        {
+            const float elasticity = m_cloths[GetClothOfParticle(i)].elasticity;
+            lastX[i] = x[i] - std::clamp(brush.deltaX, -elasticity, elasticity);
+            lastY[i] = y[i] - std::clamp(brush.deltaY, -elasticity, elasticity);
+        }
+
+        // Pin: hold the particle where it is
+        if (brush.actions & BRUSH_PIN)
+        {
+            m_particles.PinInPlace(i);
+        }
+
+        // Cut: deactivate particle and destroy its constraints
+        if (brush.actions & BRUSH_CUT)
+        {
+            m_particles.Deactivate(i);
+
+            for (int slot = 0; slot < 2; slot++)
+            {
+                std::uint32_t c = m_particleConstraints[2 * i + slot];
+                if (c != NO_CONSTRAINT)
+                {
+                    m_constraints[c].DestroyConstraint();
+                }
+            }
+
+            // Shear and bending links through the particle would otherwise hold the cut together
+            for (std::uint32_t k = m_softConstraintBegin[i]; k < m_softConstraintBegin[i + 1]; k++)
+            {
+                m_constraints[m_softConstraints[k]].DestroyConstraint();
+            }
+
+            // Coarse tethers spanning the destroyed links must let go too, the springs of the
+            // implicit integrator change, and the cloth may fall apart into new islands
+            m_isHierarchyDirty = true;
+            m_isSpringPatternDirty = true;
+            m_areIslandsDirty = true;
+        }
+    }
+}
+
+const ParticleBuffer& Cloth::GetParticles() const { return m_particles; }
+
+const std::vector<Constraint>& Cloth::GetConstraints() const { return m_constraints; }
+
+std::size_t Cloth::GetStructuralConstraintCount() const
+{
+    // Structural batches come first
+    for (const ConstraintBatch& batch : m_batches)
+    {
+        if (batch.type != ConstraintType::Structural) { return batch.begin; }
+    }
+
+    return m_constraints.size();
+}
+
+const std::vector<ConstraintBatch>& Cloth::GetBatches() const { return m_batches; }
+
+std::size_t Cloth::GetClothCount() const { return m_cloths.size(); }
+
+const ClothDesc& Cloth::GetClothDesc(std::size_t cloth) const { return m_cloths[cloth]; }
+
+std::uint32_t Cloth::GetClothParticleBegin(std::size_t cloth) const { return m_clothParticleBegin[cloth]; }
+
+std::size_t Cloth::GetClothOfParticle(std::uint32_t particle) const
+{
+    // Last cloth starting at or before the particle
+    auto it = std::upper_bound(m_clothParticleBegin.begin(), m_clothParticleBegin.end(), particle);
+    return static_cast<std::size_t>(it - m_clothParticleBegin.begin()) - 1;
 }
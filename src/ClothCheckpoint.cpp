@@ -0,0 +1,491 @@
+#include "ClothCheckpoint.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Constraints are stored and restored as raw bytes
+static_assert(std::is_trivially_copyable<Constraint>::value, "Constraint must be trivially copyable");
+static_assert(std::is_trivially_copyable<ConstraintBatch>::value, "ConstraintBatch must be trivially copyable");
+static_assert(std::is_trivially_copyable<ClothDesc>::value, "ClothDesc must be trivially copyable");
+static_assert(std::is_trivially_copyable<Collider>::value, "Collider must be trivially copyable");
+
+namespace
+{
+    /// @brief File signature.
+    constexpr char MAGIC[8] = {'C', 'L', 'O', 'T', 'H', 'C', 'K', 'P'};
+
+    /// @brief Reads back differently on a machine with the other byte order.
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    /// @brief Every array starts on a multiple of this, so mapped data is aligned for SIMD loads.
+    constexpr std::uint64_t SECTION_ALIGNMENT = 64;
+
+    /// @brief Arrays stored in the file, in file order.
+    enum Section
+    {
+        SECTION_X,
+        SECTION_Y,
+        SECTION_LAST_X,
+        SECTION_LAST_Y,
+        SECTION_START_X,
+        SECTION_START_Y,
+        SECTION_PIN_X,
+        SECTION_PIN_Y,
+        SECTION_FLAGS,
+        SECTION_START_FLAGS,
+        SECTION_CONSTRAINTS,
+        SECTION_BATCHES,
+        SECTION_PARTICLE_CONSTRAINTS,
+        SECTION_CLOTHS,
+        SECTION_CLOTH_PARTICLE_BEGIN,
+        SECTION_COLLIDERS,
+        SECTION_ISLAND_RESTING_STEPS,
+        SECTION_COUNT
+    };
+
+    /// @brief Fixed-size file header.
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t headerSize;
+        std::uint32_t constraintSize;
+
+        std::uint32_t particleCount;
+        std::uint32_t constraintCount;
+        std::uint32_t batchCount;
+        std::uint32_t clothCount;
+        std::uint32_t colliderCount;
+        std::uint32_t islandCount;
+
+        float cellSize;
+        std::int32_t boundsWidth;
+        std::int32_t boundsHeight;
+
+        std::int32_t minIterations;
+        std::int32_t maxIterations;
+        float tolerance;
+        std::uint32_t norm;
+        float selfCollisionDistance;
+        float shearStiffness;
+        float bendingStiffness;
+        std::int32_t multigridLevels;
+        float sleepSpeed;
+        std::uint32_t model;
+        float structuralCompliance;
+        float shearCompliance;
+        float bendingCompliance;
+        std::uint32_t integrator;
+        float springStiffness;
+        std::int32_t cgMaxIterations;
+        float cgTolerance;
+
+        std::uint64_t sectionOffset[SECTION_COUNT];
+        std::uint64_t sectionSize[SECTION_COUNT];
+    };
+
+    std::uint64_t AlignUp(std::uint64_t value)
+    {
+        return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    /**
+     * @brief Read-only memory mapping of a whole file, unmapped on destruction.
+     */
+    class MappedFile
+    {
+    private:
+        const unsigned char* m_data = nullptr;
+        std::uint64_t m_size = 0;
+
+#ifdef _WIN32
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+        HANDLE m_mapping = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::string& path)
+        {
+#ifdef _WIN32
+            m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE) { return; }
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) { return; }
+
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_mapping) { return; }
+
+            m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data) { m_size = static_cast<std::uint64_t>(size.QuadPart); }
+#else
+            int file = open(path.c_str(), O_RDONLY);
+            if (file < 0) { return; }
+
+            struct stat status;
+            if (fstat(file, &status) == 0 && status.st_size > 0)
+            {
+                void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                if (data != MAP_FAILED)
+                {
+                    m_data = static_cast<const unsigned char*>(data);
+                    m_size = static_cast<std::uint64_t>(status.st_size);
+                }
+            }
+
+            // The mapping stays valid after the descriptor is closed
+            close(file);
+#endif
+        }
+
+        ~MappedFile()
+        {
+#ifdef _WIN32
+            if (m_data) { UnmapViewOfFile(m_data); }
+            if (m_mapping) { CloseHandle(m_mapping); }
+            if (m_file != INVALID_HANDLE_VALUE) { CloseHandle(m_file); }
+#else
+            if (m_data) { munmap(const_cast<unsigned char*>(m_data), static_cast<std::size_t>(m_size)); }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* GetData() const { return m_data; }
+        std::uint64_t GetSize() const { return m_size; }
+    };
+
+    /// @brief Replaces a vector's contents with a block of the mapped file.
+    template <typename T>
+    void Adopt(std::vector<T>& target, const unsigned char* data, const Header& header, Section section)
+    {
+        const T* begin = reinterpret_cast<const T*>(data + header.sectionOffset[section]);
+        target.assign(begin, begin + header.sectionSize[section] / sizeof(T));
+    }
+}
+
+bool ClothCheckpoint::Save(const Cloth& cloth, const std::string& path)
+{
+    const ParticleBuffer& particles = cloth.m_particles;
+    std::uint32_t particleCount = static_cast<std::uint32_t>(particles.Size());
+
+    // Highlighting is transient cursor state, so it is not saved
+    std::vector<Constraint> constraints = cloth.m_constraints;
+    for (Constraint& constraint : constraints)
+    {
+        constraint.SetIsSelected(false);
+    }
+
+    // Islands are numbered by topology, so only their resting counts need saving.
+    // Islands waiting to be rebuilt are saved as none and rebuilt after loading.
+    std::vector<std::uint32_t> restingSteps;
+    if (cloth.m_solverSettings.sleepSpeed > 0.f && !cloth.m_areIslandsDirty)
+    {
+        restingSteps.resize(cloth.m_islands.GetIslandCount());
+        for (std::uint32_t island = 0; island < restingSteps.size(); island++)
+        {
+            restingSteps[island] = cloth.m_islands.GetRestingSteps(island);
+        }
+    }
+
+    const void* sectionData[SECTION_COUNT] = {
+        particles.m_x.data(), particles.m_y.data(),
+        particles.m_lastX.data(), particles.m_lastY.data(),
+        particles.m_startX.data(), particles.m_startY.data(),
+        particles.m_pinX.data(), particles.m_pinY.data(),
+        particles.m_flags.data(),
+        particles.m_startFlags.data(),
+        constraints.data(),
+        cloth.m_batches.data(),
+        cloth.m_particleConstraints.data(),
+        cloth.m_cloths.data(),
+        cloth.m_clothParticleBegin.data(),
+        cloth.m_colliders.GetColliders().data(),
+        restingSteps.data()
+    };
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.headerSize = sizeof(Header);
+    header.constraintSize = sizeof(Constraint);
+
+    header.particleCount = particleCount;
+    header.constraintCount = static_cast<std::uint32_t>(constraints.size());
+    header.batchCount = static_cast<std::uint32_t>(cloth.m_batches.size());
+    header.clothCount = static_cast<std::uint32_t>(cloth.m_cloths.size());
+    header.colliderCount = static_cast<std::uint32_t>(cloth.m_colliders.GetColliders().size());
+    header.islandCount = static_cast<std::uint32_t>(restingSteps.size());
+    header.cellSize = cloth.m_spatialHash.GetCellSize();
+    header.boundsWidth = cloth.m_boundsWidth;
+    header.boundsHeight = cloth.m_boundsHeight;
+
+    header.minIterations = cloth.m_solverSettings.minIterations;
+    header.maxIterations = cloth.m_solverSettings.maxIterations;
+    header.tolerance = cloth.m_solverSettings.tolerance;
+    header.norm = static_cast<std::uint32_t>(cloth.m_solverSettings.norm);
+    header.selfCollisionDistance = cloth.m_solverSettings.selfCollisionDistance;
+    header.shearStiffness = cloth.m_solverSettings.shearStiffness;
+    header.bendingStiffness = cloth.m_solverSettings.bendingStiffness;
+    header.multigridLevels = cloth.m_solverSettings.multigridLevels;
+    header.sleepSpeed = cloth.m_solverSettings.sleepSpeed;
+    header.model = static_cast<std::uint32_t>(cloth.m_solverSettings.model);
+    header.structuralCompliance = cloth.m_solverSettings.structuralCompliance;
+    header.shearCompliance = cloth.m_solverSettings.shearCompliance;
+    header.bendingCompliance = cloth.m_solverSettings.bendingCompliance;
+    header.integrator = static_cast<std::uint32_t>(cloth.m_solverSettings.integrator);
+    header.springStiffness = cloth.m_solverSettings.springStiffness;
+    header.cgMaxIterations = cloth.m_solverSettings.cgMaxIterations;
+    header.cgTolerance = cloth.m_solverSettings.cgTolerance;
+
+    header.sectionSize[SECTION_X] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_Y] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_LAST_X] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_LAST_Y] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_START_X] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_START_Y] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_PIN_X] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_PIN_Y] = particleCount * sizeof(float);
+    header.sectionSize[SECTION_FLAGS] = particleCount * sizeof(std::uint8_t);
+    header.sectionSize[SECTION_START_FLAGS] = particleCount * sizeof(std::uint8_t);
+    header.sectionSize[SECTION_CONSTRAINTS] = constraints.size() * sizeof(Constraint);
+    header.sectionSize[SECTION_BATCHES] = cloth.m_batches.size() * sizeof(ConstraintBatch);
+    header.sectionSize[SECTION_PARTICLE_CONSTRAINTS] = cloth.m_particleConstraints.size() * sizeof(std::uint32_t);
+    header.sectionSize[SECTION_CLOTHS] = cloth.m_cloths.size() * sizeof(ClothDesc);
+    header.sectionSize[SECTION_CLOTH_PARTICLE_BEGIN] = cloth.m_clothParticleBegin.size() * sizeof(std::uint32_t);
+    header.sectionSize[SECTION_COLLIDERS] = header.colliderCount * sizeof(Collider);
+    header.sectionSize[SECTION_ISLAND_RESTING_STEPS] = header.islandCount * sizeof(std::uint32_t);
+
+    std::uint64_t offset = AlignUp(sizeof(Header));
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        header.sectionOffset[section] = offset;
+        offset = AlignUp(offset + header.sectionSize[section]);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) { return false; }
+
+    static const char padding[SECTION_ALIGNMENT] = {};
+    std::uint64_t written = 0;
+
+    auto writeAt = [&](std::uint64_t position, const void* data, std::uint64_t size)
+    {
+        file.write(padding, static_cast<std::streamsize>(position - written));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written = position + size;
+    };
+
+    writeAt(0, &header, sizeof(Header));
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        writeAt(header.sectionOffset[section], sectionData[section], header.sectionSize[section]);
+    }
+
+    // Pad the last array too, so the file size is a multiple of the alignment
+    file.write(padding, static_cast<std::streamsize>(offset - written));
+
+    return static_cast<bool>(file);
+}
+
+bool ClothCheckpoint::Load(Cloth& cloth, const std::string& path)
+{
+    MappedFile file(path);
+    const unsigned char* data = file.GetData();
+
+    if (!data || file.GetSize() < sizeof(Header)) { return false; }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    // Reject files from other versions, byte orders or constraint layouts
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.headerSize != sizeof(Header) ||
+        header.constraintSize != sizeof(Constraint) || !(header.cellSize > 0.f))
+    {
+        return false;
+    }
+
+    const std::uint64_t particles = header.particleCount;
+    const std::uint64_t expectedSize[SECTION_COUNT] = {
+        particles * sizeof(float), particles * sizeof(float),
+        particles * sizeof(float), particles * sizeof(float),
+        particles * sizeof(float), particles * sizeof(float),
+        particles * sizeof(float), particles * sizeof(float),
+        particles * sizeof(std::uint8_t),
+        particles * sizeof(std::uint8_t),
+        header.constraintCount * sizeof(Constraint),
+        header.batchCount * sizeof(ConstraintBatch),
+        2 * particles * sizeof(std::uint32_t),
+        header.clothCount * sizeof(ClothDesc),
+        (header.clothCount + 1ull) * sizeof(std::uint32_t),
+        header.colliderCount * sizeof(Collider),
+        header.islandCount * sizeof(std::uint32_t)
+    };
+
+    // Every array must have the size its count implies, be aligned and lie inside the file
+    for (int section = 0; section < SECTION_COUNT; section++)
+    {
+        std::uint64_t offset = header.sectionOffset[section];
+        std::uint64_t size = header.sectionSize[section];
+
+        if (size != expectedSize[section] || offset % SECTION_ALIGNMENT != 0 ||
+            offset > file.GetSize() || size > file.GetSize() - offset)
+        {
+            return false;
+        }
+    }
+
+    // Batches and the lookup table must only reference existing constraints and particles
+    const ConstraintBatch* batches = reinterpret_cast<const ConstraintBatch*>(data + header.sectionOffset[SECTION_BATCHES]);
+    for (std::uint32_t b = 0; b < header.batchCount; b++)
+    {
+        if (batches[b].begin > batches[b].end || batches[b].end > header.constraintCount) { return false; }
+    }
+
+    const Constraint* constraints = reinterpret_cast<const Constraint*>(data + header.sectionOffset[SECTION_CONSTRAINTS]);
+    for (std::uint32_t c = 0; c < header.constraintCount; c++)
+    {
+        if (constraints[c].p_1 >= particles || constraints[c].p_2 >= particles || constraints[c].GetType() > ConstraintType::Bending) { return false; }
+    }
+
+    const std::uint32_t* particleConstraints = reinterpret_cast<const std::uint32_t*>(data + header.sectionOffset[SECTION_PARTICLE_CONSTRAINTS]);
+    for (std::uint64_t i = 0; i < 2 * particles; i++)
+    {
+        if (particleConstraints[i] != Cloth::NO_CONSTRAINT && particleConstraints[i] >= header.constraintCount) { return false; }
+    }
+
+    // Each batch holds one type, and structural batches come first
+    bool isPastStructural = false;
+    for (std::uint32_t b = 0; b < header.batchCount; b++)
+    {
+        isPastStructural = isPastStructural || batches[b].type != ConstraintType::Structural;
+        if (isPastStructural && batches[b].type == ConstraintType::Structural) { return false; }
+
+        for (std::uint32_t c = batches[b].begin; c < batches[b].end; c++)
+        {
+            if (constraints[c].GetType() != batches[b].type) { return false; }
+        }
+    }
+
+    // Cloth ranges must cover the particles in order, each holding exactly its grid
+    const std::uint32_t* clothBegin = reinterpret_cast<const std::uint32_t*>(data + header.sectionOffset[SECTION_CLOTH_PARTICLE_BEGIN]);
+    if (clothBegin[0] != 0 || clothBegin[header.clothCount] != particles) { return false; }
+
+    const ClothDesc* cloths = reinterpret_cast<const ClothDesc*>(data + header.sectionOffset[SECTION_CLOTHS]);
+    for (std::uint32_t i = 0; i < header.clothCount; i++)
+    {
+        if (clothBegin[i] > clothBegin[i + 1] || cloths[i].widthCount < 0 || cloths[i].heightCount < 0) { return false; }
+
+        const std::uint64_t gridSize = (cloths[i].widthCount + 1ull) * (cloths[i].heightCount + 1ull);
+        if (gridSize != clothBegin[i + 1] - clothBegin[i]) { return false; }
+    }
+
+    const Collider* colliders = reinterpret_cast<const Collider*>(data + header.sectionOffset[SECTION_COLLIDERS]);
+    for (std::uint32_t i = 0; i < header.colliderCount; i++)
+    {
+        if (colliders[i].shape != ColliderShape::Circle && colliders[i].shape != ColliderShape::Box && colliders[i].shape != ColliderShape::Capsule) { return false; }
+    }
+
+    // Adopt the arrays
+    ParticleBuffer& buffer = cloth.m_particles;
+    Adopt(buffer.m_x, data, header, SECTION_X);
+    Adopt(buffer.m_y, data, header, SECTION_Y);
+    Adopt(buffer.m_lastX, data, header, SECTION_LAST_X);
+    Adopt(buffer.m_lastY, data, header, SECTION_LAST_Y);
+    Adopt(buffer.m_startX, data, header, SECTION_START_X);
+    Adopt(buffer.m_startY, data, header, SECTION_START_Y);
+    Adopt(buffer.m_pinX, data, header, SECTION_PIN_X);
+    Adopt(buffer.m_pinY, data, header, SECTION_PIN_Y);
+    Adopt(buffer.m_flags, data, header, SECTION_FLAGS);
+    Adopt(buffer.m_startFlags, data, header, SECTION_START_FLAGS);
+    Adopt(cloth.m_constraints, data, header, SECTION_CONSTRAINTS);
+    Adopt(cloth.m_batches, data, header, SECTION_BATCHES);
+    Adopt(cloth.m_particleConstraints, data, header, SECTION_PARTICLE_CONSTRAINTS);
+    Adopt(cloth.m_cloths, data, header, SECTION_CLOTHS);
+    Adopt(cloth.m_clothParticleBegin, data, header, SECTION_CLOTH_PARTICLE_BEGIN);
+
+    std::vector<Collider> restoredColliders;
+    Adopt(restoredColliders, data, header, SECTION_COLLIDERS);
+    cloth.SetColliders(restoredColliders);
+
+    // Nothing to interpolate from yet
+    buffer.m_previousX = buffer.m_x;
+    buffer.m_previousY = buffer.m_y;
+
+    cloth.m_boundsWidth = header.boundsWidth;
+    cloth.m_boundsHeight = header.boundsHeight;
+
+    SolverSettings settings;
+    settings.minIterations = header.minIterations;
+    settings.maxIterations = header.maxIterations;
+    settings.tolerance = header.tolerance;
+    settings.norm = header.norm == static_cast<std::uint32_t>(ResidualNorm::RMS) ? ResidualNorm::RMS : ResidualNorm::Max;
+    settings.selfCollisionDistance = header.selfCollisionDistance;
+    settings.shearStiffness = header.shearStiffness;
+    settings.bendingStiffness = header.bendingStiffness;
+    settings.multigridLevels = header.multigridLevels;
+    settings.sleepSpeed = header.sleepSpeed;
+    settings.model = header.model == static_cast<std::uint32_t>(ConstraintModel::Compliance) ? ConstraintModel::Compliance : ConstraintModel::Stiffness;
+    settings.structuralCompliance = header.structuralCompliance;
+    settings.shearCompliance = header.shearCompliance;
+    settings.bendingCompliance = header.bendingCompliance;
+    settings.integrator = header.integrator == static_cast<std::uint32_t>(IntegratorType::ImplicitEuler) ? IntegratorType::ImplicitEuler : IntegratorType::Verlet;
+    settings.springStiffness = header.springStiffness;
+    settings.cgMaxIterations = header.cgMaxIterations;
+    settings.cgTolerance = header.cgTolerance;
+
+    // Wakes every particle, so the saved sleeping flags are put back afterwards
+    cloth.SetSolverSettings(settings);
+    cloth.m_lastStats = SolverStats();
+    Adopt(buffer.m_flags, data, header, SECTION_FLAGS);
+
+    // Rebuild the islands now rather than before the next step, which would forget how long each has rested.
+    // A file whose islands do not match its constraints is treated like one saved before they were built.
+    if (header.islandCount > 0)
+    {
+        cloth.m_islands.Build(buffer, cloth.m_constraints);
+        if (cloth.m_islands.GetIslandCount() == header.islandCount)
+        {
+            const std::uint32_t* restingSteps = reinterpret_cast<const std::uint32_t*>(data + header.sectionOffset[SECTION_ISLAND_RESTING_STEPS]);
+            for (std::uint32_t island = 0; island < header.islandCount; island++)
+            {
+                cloth.m_islands.SetRestingSteps(island, restingSteps[island]);
+            }
+            cloth.m_areIslandsDirty = false;
+        }
+    }
+
+    // Derived state is rebuilt from the restored particles
+    cloth.m_spatialHash.Reset(header.cellSize, buffer.Size());
+    cloth.m_isSpatialHashFilled = false;
+    cloth.m_brushParticles.clear();
+    cloth.m_brushCommands.clear();
+    cloth.m_selectedConstraints.clear();
+    cloth.BuildSoftConstraintIndex();
+    cloth.BuildHierarchy();
+
+    if (!cloth.m_threadPool)
+    {
+        cloth.m_threadPool = std::make_shared<ThreadPool>(1);
+    }
+
+    return true;
+}
@@ -0,0 +1,208 @@
+#include "ClothRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /// @brief Marks a constraint whose colour has never been written.
+    constexpr std::uint8_t STATE_UNKNOWN = 0xFF;
+
+    /// @brief Segments per full circle of a collider outline.
+    constexpr int CIRCLE_SEGMENTS = 32;
+
+    constexpr float PI = 3.14159265f;
+
+    const sf::Color COLLIDER_COLOR{128, 128, 128};
+
+    /// @brief Appends a closed polygon as line segments.
+    void AppendOutline(const std::vector<sf::Vector2f>& points, std::vector<sf::Vertex>& vertices)
+    {
+        sf::Vertex vertex;
+        vertex.color = COLLIDER_COLOR;
+
+        for (std::size_t i = 0; i < points.size(); i++)
+        {
+            vertex.position = points[i];
+            vertices.push_back(vertex);
+            vertex.position = points[(i + 1) % points.size()];
+            vertices.push_back(vertex);
+        }
+    }
+
+    /// @brief Appends points on an arc around a center, from one angle to another (inclusive).
+    void AppendArc(float centerX, float centerY, float radius, float from, float to, int segments, std::vector<sf::Vector2f>& points)
+    {
+        for (int i = 0; i <= segments; i++)
+        {
+            float angle = from + (to - from) * static_cast<float>(i) / static_cast<float>(segments);
+            points.push_back(sf::Vector2f{centerX + radius * std::cos(angle), centerY + radius * std::sin(angle)});
+        }
+    }
+}
+
+void ClothRenderer::Reset(const Cloth& cloth)
+{
+    Reset(cloth.GetStructuralConstraintCount());
+}
+
+void ClothRenderer::Reset(std::size_t constraintCount)
+{
+    std::size_t vertexCount = 2 * constraintCount;
+
+    // Everything is written on the next render
+    m_vertices.assign(vertexCount, sf::Vertex{});
+    m_constraintStates.assign(constraintCount, STATE_UNKNOWN);
+
+    m_useVertexBuffer = sf::VertexBuffer::isAvailable() && m_vertexBuffer.create(vertexCount);
+}
+
+void ClothRenderer::SetColliders(const std::vector<Collider>& colliders)
+{
+    m_colliderVertices.clear();
+    std::vector<sf::Vector2f> points;
+
+    for (const Collider& collider : colliders)
+    {
+        points.clear();
+
+        switch (collider.shape)
+        {
+            case ColliderShape::Circle:
+                AppendArc(collider.x0, collider.y0, collider.radius, 0.f, 2.f * PI, CIRCLE_SEGMENTS - 1, points);
+                break;
+
+            case ColliderShape::Box:
+                points.push_back(sf::Vector2f{collider.x0, collider.y0});
+                points.push_back(sf::Vector2f{collider.x1, collider.y0});
+                points.push_back(sf::Vector2f{collider.x1, collider.y1});
+                points.push_back(sf::Vector2f{collider.x0, collider.y1});
+                break;
+
+            case ColliderShape::Capsule:
+            {
+                // Half circle around each end; closing the polygon draws the sides
+                float angle = std::atan2(collider.y1 - collider.y0, collider.x1 - collider.x0);
+                AppendArc(collider.x1, collider.y1, collider.radius, angle - 0.5f * PI, angle + 0.5f * PI, CIRCLE_SEGMENTS / 2, points);
+                AppendArc(collider.x0, collider.y0, collider.radius, angle + 0.5f * PI, angle + 1.5f * PI, CIRCLE_SEGMENTS / 2, points);
+                break;
+            }
+        }
+
+        AppendOutline(points, m_colliderVertices);
+    }
+}
+
+void ClothRenderer::RenderColliders(sf::RenderWindow& win)
+{
+    if (m_colliderVertices.empty()) { return; }
+
+    win.draw(m_colliderVertices.data(), m_colliderVertices.size(), sf::PrimitiveType::Lines);
+}
+
+void ClothRenderer::RenderCloth(const Cloth& cloth, sf::RenderWindow& win, float alpha)
+{
+    if (m_constraintStates.size() != cloth.GetStructuralConstraintCount())
+    {
+        Reset(cloth);
+    }
+
+    const ParticleBuffer& particles = cloth.GetParticles();
+    Draw(cloth.GetConstraints(), nullptr, particles.GetX(), particles.GetY(), particles.GetPreviousX(), particles.GetPreviousY(), win, alpha);
+}
+
+void ClothRenderer::RenderSnapshot(const ClothSnapshot& snapshot, const Cloth& cloth, sf::RenderWindow& win, float alpha)
+{
+    RenderSnapshot(snapshot, cloth.GetConstraints(), win, alpha);
+}
+
+void ClothRenderer::RenderSnapshot(const ClothSnapshot& snapshot, const std::vector<Constraint>& constraints, sf::RenderWindow& win, float alpha)
+{
+    // Nothing published yet
+    if (snapshot.step == 0) { return; }
+
+    // Shear and bending constraints are not part of the snapshot
+    if (m_constraintStates.size() != snapshot.constraintStates.size())
+    {
+        Reset(snapshot.constraintStates.size());
+    }
+
+    Draw(constraints, snapshot.constraintStates.data(), snapshot.x.data(), snapshot.y.data(), snapshot.previousX.data(), snapshot.previousY.data(), win, alpha);
+}
+
+void ClothRenderer::Draw(const std::vector<Constraint>& constraints, const std::uint8_t* states,
+                         const float* x, const float* y, const float* previousX, const float* previousY,
+                         sf::RenderWindow& win, float alpha)
+{
+    // Blend between the last two physics states
+    auto position = [&](std::uint32_t i)
+    {
+        return sf::Vector2f{previousX[i] + (x[i] - previousX[i]) * alpha, previousY[i] + (y[i] - previousY[i]) * alpha};
+    };
+
+    // Range of vertices that differ from what the GPU holds
+    std::size_t dirtyBegin = m_vertices.size();
+    std::size_t dirtyEnd = 0;
+
+    auto markDirty = [&](std::size_t vertex)
+    {
+        dirtyBegin = std::min(dirtyBegin, vertex);
+        dirtyEnd = std::max(dirtyEnd, vertex + 1);
+    };
+
+    // Only the leading structural constraints have lines; shear and bending ones are invisible
+    for (std::size_t c = 0; c < m_constraintStates.size(); c++)
+    {
+        const Constraint& constraint = constraints[c];
+        sf::Vertex* line = &m_vertices[2 * c];
+
+        std::uint8_t state = states ? states[c] : (constraint.IsActive() ? CONSTRAINT_STATE_ACTIVE : 0) | (constraint.IsSelected() ? CONSTRAINT_STATE_SELECTED : 0);
+        bool isActive = (state & CONSTRAINT_STATE_ACTIVE) != 0;
+
+        // Rewrite the colour only when the constraint is cut or its selection changes
+        if (state != m_constraintStates[c])
+        {
+            m_constraintStates[c] = state;
+
+            // Highlight selected constraints in red; cut ones become invisible
+            sf::Color color = !isActive ? sf::Color::Transparent : (state & CONSTRAINT_STATE_SELECTED) ? sf::Color::Red : sf::Color::White;
+            line[0].color = color;
+            line[1].color = color;
+            markDirty(2 * c);
+            markDirty(2 * c + 1);
+        }
+
+        // Cut constraints keep their last (invisible) position
+        if (!isActive) continue;
+
+        sf::Vector2f from = position(constraint.p_1);
+        sf::Vector2f to = position(constraint.p_2);
+
+        if (line[0].position != from)
+        {
+            line[0].position = from;
+            markDirty(2 * c);
+        }
+
+        if (line[1].position != to)
+        {
+            line[1].position = to;
+            markDirty(2 * c + 1);
+        }
+    }
+
+    if (!m_useVertexBuffer)
+    {
+        // No GPU buffer support: draw the reused CPU mesh directly
+        win.draw(m_vertices.data(), m_vertices.size(), sf::PrimitiveType::Lines);
+        return;
+    }
+
+    // Upload only the changed range, then draw the whole persistent buffer
+    if (dirtyBegin < dirtyEnd)
+    {
+        m_vertexBuffer.update(m_vertices.data() + dirtyBegin, dirtyEnd - dirtyBegin, static_cast<unsigned>(dirtyBegin));
+    }
+
+    win.draw(m_vertexBuffer);
+}
@@ -0,0 +1,172 @@
+#include "ClothScene.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    /// @brief Parses a whole string as a number; false on trailing characters.
+    bool ParseFloat(const std::string& text, float& value)
+    {
+        char* end = nullptr;
+        value = std::strtof(text.c_str(), &end);
+        return !text.empty() && *end == '\0';
+    }
+
+    bool ParsePin(const std::string& text, PinMode& pin)
+    {
+        if (text == "top-alternate") pin = PinMode::TopAlternate;
+        else if (text == "top") pin = PinMode::Top;
+        else if (text == "corners") pin = PinMode::Corners;
+        else if (text == "left") pin = PinMode::Left;
+        else if (text == "none") pin = PinMode::None;
+        else return false;
+
+        return true;
+    }
+
+    /// @brief Applies one key=value pair to a description; returns an error message or nullptr.
+    const char* ApplyKey(const std::string& key, const std::string& value, ClothDesc& desc)
+    {
+        if (key == "pin")
+        {
+            return ParsePin(value, desc.pin) ? nullptr : "unknown pin mode";
+        }
+
+        float number = 0.f;
+        if (!ParseFloat(value, number)) { return "value is not a number"; }
+
+        if (key == "width") desc.widthCount = static_cast<int>(number);
+        else if (key == "height") desc.heightCount = static_cast<int>(number);
+        else if (key == "gap") desc.gap = number;
+        else if (key == "x") desc.startX = number;
+        else if (key == "y") desc.startY = number;
+        else if (key == "gravity") desc.gravity = number;
+        else if (key == "drag") desc.drag = number;
+        else if (key == "elasticity") desc.elasticity = number;
+        else return "unknown key";
+
+        return nullptr;
+    }
+
+    /// @brief Applies one key=value pair to a collider; returns an error message or nullptr.
+    const char* ApplyColliderKey(const std::string& key, const std::string& value, Collider& collider)
+    {
+        float number = 0.f;
+        if (!ParseFloat(value, number)) { return "value is not a number"; }
+
+        if (key == "x" || key == "x0") collider.x0 = number;
+        else if (key == "y" || key == "y0") collider.y0 = number;
+        else if (key == "x1") collider.x1 = number;
+        else if (key == "y1") collider.y1 = number;
+        else if (key == "r" || key == "radius") collider.radius = number;
+        else return "unknown key";
+
+        return nullptr;
+    }
+
+    bool ParseShape(const std::string& keyword, ColliderShape& shape)
+    {
+        if (keyword == "circle") shape = ColliderShape::Circle;
+        else if (keyword == "box") shape = ColliderShape::Box;
+        else if (keyword == "capsule") shape = ColliderShape::Capsule;
+        else return false;
+
+        return true;
+    }
+}
+
+bool ClothScene::Load(const std::string& path, std::vector<ClothDesc>& cloths, std::vector<Collider>& colliders)
+{
+    cloths.clear();
+    colliders.clear();
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << path << ": could not open scene" << std::endl;
+        return false;
+    }
+
+    ClothDesc defaults;
+    std::string line;
+
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        // Strip comments
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+
+        std::istringstream words(line);
+        std::string keyword;
+        if (!(words >> keyword)) { continue; }
+
+        Collider collider;
+        if (ParseShape(keyword, collider.shape))
+        {
+            std::string pair;
+            while (words >> pair)
+            {
+                std::size_t equals = pair.find('=');
+                const char* error = equals == std::string::npos ? "expected key=value" : ApplyColliderKey(pair.substr(0, equals), pair.substr(equals + 1), collider);
+
+                if (error)
+                {
+                    std::cerr << path << ":" << lineNumber << ": " << error << " in '" << pair << "'" << std::endl;
+                    return false;
+                }
+            }
+
+            if (collider.shape != ColliderShape::Box && !(collider.radius > 0.f))
+            {
+                std::cerr << path << ":" << lineNumber << ": " << keyword << " needs a positive radius" << std::endl;
+                return false;
+            }
+
+            colliders.push_back(collider);
+            continue;
+        }
+
+        if (keyword != "cloth" && keyword != "defaults")
+        {
+            std::cerr << path << ":" << lineNumber << ": unknown directive '" << keyword << "'" << std::endl;
+            return false;
+        }
+
+        ClothDesc desc = defaults;
+        std::string pair;
+
+        while (words >> pair)
+        {
+            std::size_t equals = pair.find('=');
+            const char* error = equals == std::string::npos ? "expected key=value" : ApplyKey(pair.substr(0, equals), pair.substr(equals + 1), desc);
+
+            if (error)
+            {
+                std::cerr << path << ":" << lineNumber << ": " << error << " in '" << pair << "'" << std::endl;
+                return false;
+            }
+        }
+
+        if (keyword == "defaults")
+        {
+            defaults = desc;
+            continue;
+        }
+
+        if (desc.widthCount < 0 || desc.heightCount < 0 || !(desc.gap > 0.f))
+        {
+            std::cerr << path << ":" << lineNumber << ": cloth needs a non-negative size and a positive gap" << std::endl;
+            return false;
+        }
+
+        cloths.push_back(desc);
+    }
+
+    return true;
+}
@@ -1,4 +1,9 @@
 #include "ClothSimulation.h"
+#include "ClothCheckpoint.h"
+#include "ClothScene.h"
+#include "StateHash.h"
+
+#include <algorithm>
 
 void ClothSimulation::Begin()
 {
@@ -11,33 +16,265 @@ void ClothSimulation::Begin()
     int start_x = WIN_WIDTH * 0.5f - width_particle_count * CLOTH_GAPPING * 0.5f;
     int start_y = WIN_HEIGHT * 0.1f;
 
-    // Create a new cloth object with the calculated parameters
-    m_cloth = new Cloth(width_particle_count, height_particel_count, CLOTH_GAPPING, start_x, start_y, GRAVITY, DRAG, ELASTICITY);
+    // Build the scene's cloths in shared storage, or fall back to the single default cloth
+    std::vector<ClothDesc> cloths;
+    std::vector<Collider> colliders;
+    if (!m_scenePath.empty() && ClothScene::Load(m_scenePath, cloths, colliders))
+    {
+        m_cloth = Cloth(cloths);
+        m_cloth.SetColliders(colliders);
+    }
+    else
+    {
+        // Create a new cloth object with the calculated parameters
+        m_cloth = Cloth(width_particle_count, height_particel_count, CLOTH_GAPPING, start_x, start_y, GRAVITY, DRAG, ELASTICITY);
+    }
+
+    SolverSettings settings = m_cloth.GetSolverSettings();
+    settings.selfCollisionDistance = SELF_COLLISION_DISTANCE;
+    settings.shearStiffness = SHEAR_STIFFNESS;
+    settings.bendingStiffness = BENDING_STIFFNESS;
+    settings.multigridLevels = MULTIGRID_LEVELS;
+    settings.sleepSpeed = SLEEP_SPEED;
+    settings.model = XPBD_SOLVER ? ConstraintModel::Compliance : ConstraintModel::Stiffness;
+    settings.structuralCompliance = STRUCTURAL_COMPLIANCE;
+    settings.shearCompliance = SHEAR_COMPLIANCE;
+    settings.bendingCompliance = BENDING_COMPLIANCE;
+    settings.integrator = IMPLICIT_INTEGRATOR ? IntegratorType::ImplicitEuler : IntegratorType::Verlet;
+    settings.springStiffness = SPRING_STIFFNESS;
+    m_cloth.SetSolverSettings(settings);
+
+    // Resume a previously saved scene instead of settling the cloth again
+    if (ClothCheckpoint::Load(m_cloth, CHECKPOINT_FILE))
+    {
+        std::cout << "Resumed from " << CHECKPOINT_FILE << std::endl;
+    }
+
+    m_cloth.SetBounds(WIN_WIDTH, WIN_HEIGHT);
+
+    // One pool for everything that runs in parallel, sized to the machine
+    m_threadPool = std::make_shared<ThreadPool>(0);
+    m_cloth.SetThreadPool(m_threadPool);
+
+    // Log a lockstep session so cloth_headless can replay it step for step. The cloth
+    // restarts from its own checkpoint, so the replay begins from exactly the same state.
+    if (IsLockstep())
+    {
+        if (ClothCheckpoint::Save(m_cloth, INPUT_START_FILE) && ClothCheckpoint::Load(m_cloth, INPUT_START_FILE) &&
+            m_inputLog.Open(INPUT_LOG_FILE, 1.0f / PHYSICS_RATE, WIN_WIDTH, WIN_HEIGHT))
+        {
+            m_hashLog.open(HASH_LOG_FILE);
+            std::cout << "Logging input to " << INPUT_LOG_FILE << " and state hashes to " << HASH_LOG_FILE << std::endl;
+        }
+        else
+        {
+            std::cerr << "Could not write " << INPUT_START_FILE << " or " << INPUT_LOG_FILE << std::endl;
+        }
+    }
+
+    // Allocate the persistent line mesh once up front
+    m_renderer.Reset(m_cloth);
+
+    // Colliders never move, so their outlines are built once
+    m_renderer.SetColliders(m_cloth.GetColliders());
+
+    // Size of the circular brush used for dragging and cutting
+    m_input.cursorSize = CURSOR_SIZE;
+    m_physicsInput.cursorSize = CURSOR_SIZE;
+
+    // The solver phases run in order; what follows only reads the stepped cloth, so it runs side by side
+    m_stepGraph.Clear();
+    const TaskGraph::TaskId stepTask = m_cloth.AddStepTasks(m_stepGraph, m_stepDeltaTime, m_physicsInput);
+
+    m_stepGraph.Precede(stepTask, m_stepGraph.Add([this] {
+        if (m_hashLog.is_open())
+        {
+            m_hashLog << m_stepCount << " " << StateHash::ToHex(StateHash::Compute(m_cloth)) << "\n";
+        }
+    }));
+    m_stepGraph.Precede(stepTask, m_stepGraph.Add([this] {
+        if (m_recorder.IsOpen())
+        {
+            m_recorder.Capture(m_cloth, m_stepCount);
+        }
+    }));
+
+    // Hand the result to the render thread
+    m_stepGraph.Precede(stepTask, m_stepGraph.Add([this] {
+        if (IsPipelined())
+        {
+            m_snapshots.GetBack().Capture(m_cloth, m_stepCount);
+            m_snapshots.Publish();
+        }
+    }));
 }
 
 void ClothSimulation::FixedUpdate(float fixedDeltaTime)
 {
-    // Update the cloth physics with a fixed time step
-    m_cloth->Update(fixedDeltaTime, win, m_mousePos, m_mouseLastPos);
+    // Take the newest input forwarded by Update; the drag delta is measured from the last step's position
+    if (m_latestInput.Acquire())
+    {
+        const ClothInput& input = m_latestInput.GetFront();
+        m_physicsInput.mousePos = input.mousePos;
+        m_physicsInput.isDragging = input.isDragging;
+        m_physicsInput.isCutting = input.isCutting;
+        m_physicsInput.isPinning = input.isPinning;
+    }
+
+    // Start or stop recording as requested by the render thread
+    if (m_isRecordRequested != m_recorder.IsOpen())
+    {
+        if (m_recorder.IsOpen())
+        {
+            m_recorder.Close();
+            std::cout << "Recording saved to " << TRAJECTORY_FILE << " (" << m_recorder.GetDroppedFrames() << " frames dropped)" << std::endl;
+        }
+        else if (m_recorder.Open(TRAJECTORY_FILE, m_cloth))
+        {
+            std::cout << "Recording to " << TRAJECTORY_FILE << std::endl;
+        }
+        else
+        {
+            std::cerr << "Could not write " << TRAJECTORY_FILE << std::endl;
+            m_isRecordRequested = false;
+        }
+
+        m_isRecording = m_recorder.IsOpen();
+    }
+
+    // The render thread is showing a recording; the cloth is paused meanwhile
+    if (m_isPlaying) { return; }
+
+    // Mend and rewind the cloths in place; the topology the renderer reads stays untouched
+    const bool isReset = m_isResetRequested.exchange(false);
+    if (isReset)
+    {
+        m_cloth.Reset();
+    }
+
+    m_inputLog.Write(m_physicsInput, isReset);
+
+    // Update the cloth physics with a fixed time step; the graph reads the step number after the solver phases
+    m_stepDeltaTime = fixedDeltaTime;
+    m_stepCount++;
+    m_stepGraph.Run(*m_threadPool);
+
+    // The drag delta has been applied; further substeps hold the particles under the cursor
+    m_physicsInput.lastMousePos = m_physicsInput.mousePos;
+
+    // Saving reads the whole cloth, so it happens here on the thread that owns it
+    if (m_isSaveRequested.exchange(false))
+    {
+        if (ClothCheckpoint::Save(m_cloth, CHECKPOINT_FILE))
+        {
+            std::cout << "Checkpoint saved to " << CHECKPOINT_FILE << std::endl;
+        }
+        else
+        {
+            std::cerr << "Could not write " << CHECKPOINT_FILE << std::endl;
+        }
+    }
 }
 
 void ClothSimulation::Update(float deltaTime)
 {
-    // Save last frame's mouse position
-    m_mouseLastPos = m_mousePos;
-
     // Get current mouse position relative to the window
-    m_mousePos = sf::Mouse::getPosition(win);
+    m_input.mousePos = sf::Mouse::getPosition(win);
+
+    // Sample the buttons once here instead of once per particle inside the solver
+    m_input.isDragging = sf::Mouse::isButtonPressed(sf::Mouse::Button::Left);
+    m_input.isCutting = sf::Mouse::isButtonPressed(sf::Mouse::Button::Right);
+    m_input.isPinning = sf::Mouse::isButtonPressed(sf::Mouse::Button::Middle);
+
+    // Forward to the physics step, replacing any sample it has not taken yet
+    m_latestInput.GetBack() = m_input;
+    m_latestInput.Publish();
+
+    // Advance playback at the rate it was recorded, looping at the end
+    if (m_isPlaying)
+    {
+        const float frameTime = 1.f / PHYSICS_RATE;
+        m_playbackTime += deltaTime;
+
+        for (int frames = 0; m_playbackTime >= frameTime && frames < MAX_SUBSTEPS; frames++)
+        {
+            m_playbackTime -= frameTime;
+
+            if (!m_player.ReadFrame(m_playbackFrame))
+            {
+                m_player.Rewind();
+                m_player.ReadFrame(m_playbackFrame);
+            }
+        }
+
+        m_playbackTime = std::min(m_playbackTime, frameTime);
+    }
 }
 
-void ClothSimulation::Render()
+void ClothSimulation::Render(float alpha)
 {
+    m_renderer.RenderColliders(win);
+
     // Draw the cloth onto the window
-    m_cloth->RenderCloth(win);
+    if (m_isPlaying)
+    {
+        m_renderer.RenderSnapshot(m_playbackFrame, m_player.GetConstraints(), win, m_playbackTime * PHYSICS_RATE);
+    }
+    else if (IsPipelined())
+    {
+        // Latest complete state from the physics thread; keeps the previous one if nothing new was published
+        m_snapshots.Acquire();
+        m_renderer.RenderSnapshot(m_snapshots.GetFront(), m_cloth, win, alpha);
+    }
+    else
+    {
+        m_renderer.RenderCloth(m_cloth, win, alpha);
+    }
+}
+
+void ClothSimulation::OnKeyPressed(sf::Keyboard::Key key)
+{
+    if (key == sf::Keyboard::Key::F5)
+    {
+        m_isSaveRequested = true;
+    }
+    else if (key == sf::Keyboard::Key::F6 && !m_isPlaying)
+    {
+        m_isRecordRequested = !m_isRecordRequested;
+    }
+    else if (key == sf::Keyboard::Key::F7)
+    {
+        TogglePlayback();
+    }
+    else if (key == sf::Keyboard::Key::F8)
+    {
+        m_isResetRequested = true;
+    }
 }
 
-ClothSimulation::~ClothSimulation()
+void ClothSimulation::TogglePlayback()
 {
-    // Clean up the cloth object to free memory
-    delete m_cloth;
+    if (m_isPlaying)
+    {
+        m_isPlaying = false;
+        return;
+    }
+
+    // The file is only complete once the physics thread has closed it
+    if (m_isRecordRequested || m_isRecording)
+    {
+        std::cerr << "Stop recording (F6) before playing it back" << std::endl;
+        return;
+    }
+
+    if (!m_player.Open(TRAJECTORY_FILE) || !m_player.ReadFrame(m_playbackFrame))
+    {
+        std::cerr << "Could not play " << TRAJECTORY_FILE << std::endl;
+        return;
+    }
+
+    m_playbackTime = 0.f;
+    m_isPlaying = true;
 }
+
+void ClothSimulation::SetScenePath(const std::string& path) { m_scenePath = path; }
@@ -0,0 +1,24 @@
+#include "ClothSnapshot.h"
+
+void ClothSnapshot::Capture(const Cloth& cloth, std::uint64_t stepIndex)
+{
+    const ParticleBuffer& particles = cloth.GetParticles();
+    const std::size_t count = particles.Size();
+
+    // assign() keeps the capacity, so after the first capture nothing is allocated
+    x.assign(particles.GetX(), particles.GetX() + count);
+    y.assign(particles.GetY(), particles.GetY() + count);
+    previousX.assign(particles.GetPreviousX(), particles.GetPreviousX() + count);
+    previousY.assign(particles.GetPreviousY(), particles.GetPreviousY() + count);
+
+    // Only the structural constraints are drawn; they lead the list
+    const std::vector<Constraint>& constraints = cloth.GetConstraints();
+    constraintStates.resize(cloth.GetStructuralConstraintCount());
+
+    for (std::size_t c = 0; c < constraintStates.size(); c++)
+    {
+        constraintStates[c] = (constraints[c].IsActive() ? CONSTRAINT_STATE_ACTIVE : 0) | (constraints[c].IsSelected() ? CONSTRAINT_STATE_SELECTED : 0);
+    }
+
+    step = stepIndex;
+}
@@ -0,0 +1,304 @@
+#include "ColliderSet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/// @brief Particles sharing one hierarchy lookup.
+static constexpr std::size_t COLLIDER_BATCH = 16;
+
+/// @brief Particles each thread resolves per chunk; a multiple of COLLIDER_BATCH.
+static constexpr std::size_t COLLIDER_GRAIN = 128 * COLLIDER_BATCH;
+
+namespace
+{
+    /// @brief Axis-aligned bounds of a collider.
+    void GetBounds(const Collider& collider, float& minX, float& minY, float& maxX, float& maxY)
+    {
+        switch (collider.shape)
+        {
+            case ColliderShape::Circle:
+                minX = collider.x0 - collider.radius;
+                minY = collider.y0 - collider.radius;
+                maxX = collider.x0 + collider.radius;
+                maxY = collider.y0 + collider.radius;
+                break;
+
+            case ColliderShape::Box:
+                minX = std::min(collider.x0, collider.x1);
+                minY = std::min(collider.y0, collider.y1);
+                maxX = std::max(collider.x0, collider.x1);
+                maxY = std::max(collider.y0, collider.y1);
+                break;
+
+            case ColliderShape::Capsule:
+                minX = std::min(collider.x0, collider.x1) - collider.radius;
+                minY = std::min(collider.y0, collider.y1) - collider.radius;
+                maxX = std::max(collider.x0, collider.x1) + collider.radius;
+                maxY = std::max(collider.y0, collider.y1) + collider.radius;
+                break;
+        }
+    }
+
+    /// @brief Moves points within radius of a center onto the circle.
+    void PushOutOfCircle(float centerX, float centerY, float radius, float& x, float& y)
+    {
+        float dx = x - centerX;
+        float dy = y - centerY;
+        float distanceSquared = dx * dx + dy * dy;
+
+        if (distanceSquared >= radius * radius) { return; }
+
+        if (distanceSquared > 0.f)
+        {
+            float scale = radius / std::sqrt(distanceSquared);
+            x = centerX + dx * scale;
+            y = centerY + dy * scale;
+        }
+        else
+        {
+            // Exactly at the center: leave upwards, against gravity
+            y = centerY - radius;
+        }
+    }
+
+    /// @brief Moves one point out of a collider, onto its surface.
+    void PushOut(const Collider& collider, float lastX, float lastY, float& x, float& y)
+    {
+        switch (collider.shape)
+        {
+            case ColliderShape::Circle:
+                PushOutOfCircle(collider.x0, collider.y0, collider.radius, x, y);
+                break;
+
+            case ColliderShape::Box:
+            {
+                float minX = std::min(collider.x0, collider.x1);
+                float minY = std::min(collider.y0, collider.y1);
+                float maxX = std::max(collider.x0, collider.x1);
+                float maxY = std::max(collider.y0, collider.y1);
+
+                if (x <= minX || x >= maxX || y <= minY || y >= maxY) { return; }
+
+                // Leave through the side the point came in from, so fast points cannot cross thin boxes
+                if (lastY <= minY) { y = minY; return; }
+                if (lastY >= maxY) { y = maxY; return; }
+                if (lastX <= minX) { x = minX; return; }
+                if (lastX >= maxX) { x = maxX; return; }
+
+                // Already inside at the start of the step: leave through the nearest side
+                float left = x - minX;
+                float right = maxX - x;
+                float top = y - minY;
+                float bottom = maxY - y;
+                float nearest = std::min(std::min(left, right), std::min(top, bottom));
+
+                if (nearest == top) y = minY;
+                else if (nearest == left) x = minX;
+                else if (nearest == right) x = maxX;
+                else y = maxY;
+                break;
+            }
+
+            case ColliderShape::Capsule:
+            {
+                // Nearest point on the segment acts as the center of a circle
+                float segmentX = collider.x1 - collider.x0;
+                float segmentY = collider.y1 - collider.y0;
+                float lengthSquared = segmentX * segmentX + segmentY * segmentY;
+
+                float t = 0.f;
+                if (lengthSquared > 0.f)
+                {
+                    t = ((x - collider.x0) * segmentX + (y - collider.y0) * segmentY) / lengthSquared;
+                    t = std::min(std::max(t, 0.f), 1.f);
+                }
+
+                PushOutOfCircle(collider.x0 + segmentX * t, collider.y0 + segmentY * t, collider.radius, x, y);
+                break;
+            }
+        }
+    }
+}
+
+void ColliderSet::Clear()
+{
+    m_colliders.clear();
+    m_order.clear();
+    m_orderBounds.clear();
+    m_nodes.clear();
+}
+
+void ColliderSet::Add(const Collider& collider)
+{
+    m_colliders.push_back(collider);
+}
+
+void ColliderSet::Build()
+{
+    const std::uint32_t count = static_cast<std::uint32_t>(m_colliders.size());
+
+    m_order.resize(count);
+    m_orderBounds.clear();
+    m_nodes.clear();
+    if (count == 0) { return; }
+
+    std::vector<float> centerX(count), centerY(count);
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        float minX, minY, maxX, maxY;
+        GetBounds(m_colliders[i], minX, minY, maxX, maxY);
+
+        m_order[i] = i;
+        centerX[i] = 0.5f * (minX + maxX);
+        centerY[i] = 0.5f * (minY + maxY);
+    }
+
+    // A binary tree with LEAF_SIZE leaves has fewer than 2 * count / LEAF_SIZE + 1 nodes
+    m_nodes.reserve(2 * (count / LEAF_SIZE) + 2);
+    BuildNode(0, count, centerX, centerY);
+
+    m_orderBounds.resize(count);
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        Bounds& bounds = m_orderBounds[i];
+        GetBounds(m_colliders[m_order[i]], bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+    }
+}
+
+std::uint32_t ColliderSet::BuildNode(std::uint32_t begin, std::uint32_t end, const std::vector<float>& centerX, const std::vector<float>& centerY)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node{});
+
+    Node node{INFINITY, INFINITY, -INFINITY, -INFINITY, begin, end - begin};
+    float centerMinX = INFINITY, centerMinY = INFINITY, centerMaxX = -INFINITY, centerMaxY = -INFINITY;
+
+    for (std::uint32_t i = begin; i < end; i++)
+    {
+        float minX, minY, maxX, maxY;
+        GetBounds(m_colliders[m_order[i]], minX, minY, maxX, maxY);
+
+        node.minX = std::min(node.minX, minX);
+        node.minY = std::min(node.minY, minY);
+        node.maxX = std::max(node.maxX, maxX);
+        node.maxY = std::max(node.maxY, maxY);
+
+        centerMinX = std::min(centerMinX, centerX[m_order[i]]);
+        centerMinY = std::min(centerMinY, centerY[m_order[i]]);
+        centerMaxX = std::max(centerMaxX, centerX[m_order[i]]);
+        centerMaxY = std::max(centerMaxY, centerY[m_order[i]]);
+    }
+
+    if (end - begin > LEAF_SIZE)
+    {
+        // Split at the median center along the wider axis; ties broken by index for a stable layout
+        const std::vector<float>& key = centerMaxX - centerMinX >= centerMaxY - centerMinY ? centerX : centerY;
+        std::uint32_t middle = begin + (end - begin) / 2;
+
+        std::nth_element(m_order.begin() + begin, m_order.begin() + middle, m_order.begin() + end,
+                         [&key](std::uint32_t a, std::uint32_t b) { return key[a] < key[b] || (key[a] == key[b] && a < b); });
+
+        BuildNode(begin, middle, centerX, centerY);
+        node.first = BuildNode(middle, end, centerX, centerY);
+        node.count = 0;
+    }
+
+    m_nodes[index] = node;
+    return index;
+}
+
+void ColliderSet::Query(float minX, float minY, float maxX, float maxY, std::vector<std::uint32_t>& result) const
+{
+    result.clear();
+    if (m_nodes.empty()) { return; }
+
+    // Depth is about log2(count / LEAF_SIZE); 64 levels is far beyond any balanced tree
+    std::uint32_t stack[64];
+    int size = 0;
+    stack[size++] = 0;
+
+    while (size > 0)
+    {
+        const Node& node = m_nodes[stack[--size]];
+
+        if (node.maxX < minX || node.minX > maxX || node.maxY < minY || node.minY > maxY) { continue; }
+
+        if (node.count > 0)
+        {
+            for (std::uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                const Bounds& bounds = m_orderBounds[i];
+                if (bounds.maxX < minX || bounds.minX > maxX || bounds.maxY < minY || bounds.minY > maxY) { continue; }
+
+                result.push_back(m_order[i]);
+            }
+        }
+        else
+        {
+            // Right child first so the left one is visited next
+            std::uint32_t index = static_cast<std::uint32_t>(&node - m_nodes.data());
+            stack[size++] = node.first;
+            stack[size++] = index + 1;
+        }
+    }
+}
+
+void ColliderSet::Resolve(ParticleBuffer& particles, ThreadPool& threadPool)
+{
+    if (m_nodes.empty() || particles.Size() == 0) { return; }
+
+    const std::size_t count = particles.Size();
+    m_chunkCandidates.resize((count + COLLIDER_GRAIN - 1) / COLLIDER_GRAIN);
+
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    const float* lastX = particles.GetLastX();
+    const float* lastY = particles.GetLastY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    auto resolve = [&](std::size_t begin, std::size_t end)
+    {
+        std::vector<std::uint32_t>& candidates = m_chunkCandidates[begin / COLLIDER_GRAIN];
+
+        for (std::size_t batch = begin; batch < end; batch += COLLIDER_BATCH)
+        {
+            const std::size_t batchEnd = std::min(batch + COLLIDER_BATCH, end);
+
+            // Bounds of the movable particles in the batch
+            float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+            for (std::size_t i = batch; i < batchEnd; i++)
+            {
+                if ((flags[i] & (PARTICLE_ACTIVE | PARTICLE_PINNED | PARTICLE_SLEEPING)) != PARTICLE_ACTIVE) { continue; }
+
+                minX = std::min(minX, x[i]);
+                minY = std::min(minY, y[i]);
+                maxX = std::max(maxX, x[i]);
+                maxY = std::max(maxY, y[i]);
+            }
+
+            if (minX > maxX) { continue; }
+
+            Query(minX, minY, maxX, maxY, candidates);
+
+            // One collider against the whole batch at a time
+            for (std::uint32_t c : candidates)
+            {
+                const Collider& collider = m_colliders[c];
+
+                for (std::size_t i = batch; i < batchEnd; i++)
+                {
+                    if ((flags[i] & (PARTICLE_ACTIVE | PARTICLE_PINNED | PARTICLE_SLEEPING)) != PARTICLE_ACTIVE) { continue; }
+
+                    PushOut(collider, lastX[i], lastY[i], x[i], y[i]);
+                }
+            }
+        }
+    };
+
+    threadPool.ParallelFor(0, count, COLLIDER_GRAIN, std::cref(resolve));
+}
+
+const std::vector<Collider>& ColliderSet::GetColliders() const { return m_colliders; }
+
+bool ColliderSet::IsEmpty() const { return m_colliders.empty(); }
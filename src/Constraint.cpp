@@ -1,33 +1,42 @@
 #include "Constraint.h"
-#include "Particle.h"
 
 // Constructor: initializes the constraint between two particles and stores the rest length
-Constraint::Constraint(Particle& primary_particle, Particle& secondary_particle, float length) : p_1(primary_particle), p_2(secondary_particle), m_length(length) {}
+Constraint::Constraint(std::uint32_t primary_particle, std::uint32_t secondary_particle, float length, ConstraintType type)
+    : m_length(length), m_type(type), p_1(primary_particle), p_2(secondary_particle) {}
 
-void Constraint::Update()
+float Constraint::Update(ParticleBuffer& particles)
 {
     // Skip update if constraint is deactivated
-    if (!m_isActive) { return; }
+    if (!m_isActive) { return 0.f; }
 
-    // Get current positions of both particles
-    sf::Vector2f p_1_pos = p_1.GetPos();
-    sf::Vector2f p_2_pos = p_2.GetPos();
+    float* x = particles.GetX();
+    float* y = particles.GetY();
 
     // Calculate the vector between the two particles
-    sf::Vector2f difference = p_1_pos - p_2_pos;
+    float differenceX = x[p_1] - x[p_2];
+    float differenceY = y[p_1] - y[p_2];
 
     // Compute the actual distance between the two particles
-    float distance = difference.length();
+    float distance = std::sqrt(differenceX * differenceX + differenceY * differenceY);
+
+    // Coincident particles (e.g. both pressed into a corner) have no direction to push apart in
+    if (distance == 0.f) { return 1.f; }
 
     // Calculate how much correction is required
     float difference_factor = (m_length - distance) / distance;
 
     // Compute the offset to apply to each particle to restore the correct length
-    sf::Vector2f offset = difference * difference_factor * 0.5f;
+    float offsetX = differenceX * difference_factor * 0.5f;
+    float offsetY = differenceY * difference_factor * 0.5f;
 
     // Apply the offset in opposite directions to both particles
-    p_1.SetPos(p_1_pos.x + offset.x, p_1_pos.y + offset.y);
-    p_2.SetPos(p_2_pos.x - offset.x, p_2_pos.y - offset.y);
+    x[p_1] += offsetX;
+    y[p_1] += offsetY;
+    x[p_2] -= offsetX;
+    y[p_2] -= offsetY;
+
+    // Report how far off the rest length the constraint was
+    return std::fabs(m_length - distance) / m_length;
 }
 
 // Sets whether this constraint is currently selected (for visual highlighting)
@@ -36,8 +45,12 @@ void Constraint::SetIsSelected(bool value) { m_isSelected = value; }
 // Deactivates the constraint so it is no longer updated or rendered
 void Constraint::DestroyConstraint() { m_isActive = false; }
 
-// Returns whether this constraint is still active
-bool Constraint::IsActive() { return m_isActive; }
+// Reactivates the constraint, e.g. when a torn cloth is reset
+void Constraint::RestoreConstraint()
+{
+    m_isActive = true;
+    m_isSelected = false;
+}
 
 // Returns whether this constraint is currently selected
-bool Constraint::IsSelected() { return m_isSelected; }
\ No newline at end of file
+bool Constraint::IsSelected() const { return m_isSelected; }
\ No newline at end of file
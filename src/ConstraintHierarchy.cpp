@@ -0,0 +1,252 @@
+#include "ConstraintHierarchy.h"
+#include "ConstraintKernel.h"
+
+#include <algorithm>
+#include <functional>
+
+/// @brief Tethers each thread solves per chunk; matches the fine constraint grain.
+static constexpr std::size_t TETHER_GRAIN = 8192;
+
+/// @brief Interpolated particles each thread handles per chunk.
+static constexpr std::size_t PROLONGATION_GRAIN = 8192;
+
+void ConstraintHierarchy::Build(const std::vector<ClothDesc>& cloths, const std::vector<std::uint32_t>& clothParticleBegin,
+                                const std::vector<std::uint32_t>& particleConstraints, int levelCount)
+{
+    // Cleared rather than replaced, so a rebuild of the same size allocates nothing
+    m_tethers.clear();
+    m_tetherChildren.clear();
+    m_batches.clear();
+    m_prolongations.clear();
+    m_prolongationTethers.clear();
+    m_isProlongationIntact.clear();
+    m_levels.clear();
+
+    levelCount = std::clamp(levelCount, 0, MAX_LEVELS);
+    if (levelCount == 0) { return; }
+
+    // Level 0 links are the structural constraints; each level overwrites the entries of its own particles
+    m_linkOfParticle.assign(particleConstraints.begin(), particleConstraints.end());
+
+    for (int level = 1; level <= levelCount; level++)
+    {
+        const int stride = 1 << level;
+        const int half = stride / 2;
+
+        Level range;
+        range.batchBegin = static_cast<std::uint32_t>(m_batches.size());
+
+        // Horizontal tethers starting in even / odd coarse columns, then vertical ones in even / odd coarse rows
+        for (int slot = 0; slot < 2; slot++)
+        {
+            for (int parity = 0; parity < 2; parity++)
+            {
+                ConstraintBatch batch;
+                batch.begin = static_cast<std::uint32_t>(m_tethers.size());
+                batch.type = ConstraintType::Tether;
+
+                for (std::size_t cloth = 0; cloth < cloths.size(); cloth++)
+                {
+                    const ClothDesc& desc = cloths[cloth];
+                    const std::uint32_t first = clothParticleBegin[cloth];
+                    const std::uint32_t row = desc.widthCount + 1;
+                    const std::uint32_t step = slot == 0 ? 1 : row;
+                    const float length = stride * desc.gap;
+
+                    const int firstY = slot == 0 ? 0 : parity * stride;
+                    const int stepY = slot == 0 ? stride : 2 * stride;
+                    const int endY = slot == 0 ? desc.heightCount : desc.heightCount - stride;
+                    const int firstX = slot == 0 ? parity * stride : 0;
+                    const int stepX = slot == 0 ? 2 * stride : stride;
+                    const int endX = slot == 0 ? desc.widthCount - stride : desc.widthCount;
+
+                    for (int y = firstY; y <= endY; y += stepY)
+                    {
+                        for (int x = firstX; x <= endX; x += stepX)
+                        {
+                            // Span the two links of the level below that start here and halfway along
+                            std::uint32_t particle = first + y * row + x;
+                            std::uint32_t middle = particle + half * step;
+                            std::uint32_t tether = static_cast<std::uint32_t>(m_tethers.size());
+
+                            m_tetherChildren.push_back(m_linkOfParticle[2 * particle + slot]);
+                            m_tetherChildren.push_back(m_linkOfParticle[2 * middle + slot]);
+                            m_tethers.emplace_back(particle + stride * step, particle, length, ConstraintType::Tether);
+
+                            // Only multiples of the stride are overwritten; halfway entries are read above first
+                            m_linkOfParticle[2 * particle + slot] = tether;
+                        }
+                    }
+                }
+
+                batch.end = static_cast<std::uint32_t>(m_tethers.size());
+                m_batches.push_back(batch);
+            }
+        }
+
+        range.batchEnd = static_cast<std::uint32_t>(m_batches.size());
+        range.prolongationBegin = static_cast<std::uint32_t>(m_prolongations.size());
+
+        // Particles this level's finer neighbour adds: midpoints of tethers and centres of cells
+        for (std::size_t cloth = 0; cloth < cloths.size(); cloth++)
+        {
+            const ClothDesc& desc = cloths[cloth];
+            const std::uint32_t first = clothParticleBegin[cloth];
+            const std::uint32_t row = desc.widthCount + 1;
+
+            for (int y = 0; y + (y % stride != 0 ? half : 0) <= desc.heightCount; y += half)
+            {
+                for (int x = 0; x + (x % stride != 0 ? half : 0) <= desc.widthCount; x += half)
+                {
+                    const bool isBetweenColumns = x % stride != 0;
+                    const bool isBetweenRows = y % stride != 0;
+                    if (!isBetweenColumns && !isBetweenRows) continue;
+
+                    // Corner at the top left of the particle's coarse cell
+                    const std::uint32_t topLeft = first + (y - (isBetweenRows ? half : 0)) * row + x - (isBetweenColumns ? half : 0);
+
+                    Prolongation entry;
+                    entry.particle = first + y * row + x;
+
+                    if (isBetweenColumns && isBetweenRows)
+                    {
+                        const std::uint32_t bottomLeft = topLeft + stride * row;
+
+                        entry.corners[0] = topLeft;
+                        entry.corners[1] = topLeft + stride;
+                        entry.corners[2] = bottomLeft;
+                        entry.corners[3] = bottomLeft + stride;
+                        m_prolongationTethers.push_back(m_linkOfParticle[2 * topLeft]);
+                        m_prolongationTethers.push_back(m_linkOfParticle[2 * bottomLeft]);
+                        m_prolongationTethers.push_back(m_linkOfParticle[2 * topLeft + 1]);
+                        m_prolongationTethers.push_back(m_linkOfParticle[2 * (topLeft + stride) + 1]);
+                    }
+                    else
+                    {
+                        const std::uint32_t other = topLeft + (isBetweenColumns ? stride : stride * row);
+                        const std::uint32_t tether = m_linkOfParticle[2 * topLeft + (isBetweenColumns ? 0 : 1)];
+
+                        entry.corners[0] = topLeft;
+                        entry.corners[1] = other;
+                        entry.corners[2] = topLeft;
+                        entry.corners[3] = other;
+                        m_prolongationTethers.insert(m_prolongationTethers.end(), 4, tether);
+                    }
+
+                    m_prolongations.push_back(entry);
+                    m_isProlongationIntact.push_back(1);
+                }
+            }
+        }
+
+        range.prolongationEnd = static_cast<std::uint32_t>(m_prolongations.size());
+        m_levels.push_back(range);
+    }
+}
+
+void ConstraintHierarchy::Refresh(const std::vector<Constraint>& constraints, const ParticleBuffer& particles)
+{
+    // Levels are stored finest first, so the tethers a coarse tether spans are already up to date
+    for (std::size_t level = 0; level < m_levels.size(); level++)
+    {
+        const Level& range = m_levels[level];
+        if (range.batchBegin == range.batchEnd) continue;
+
+        const std::uint32_t begin = m_batches[range.batchBegin].begin;
+        const std::uint32_t end = m_batches[range.batchEnd - 1].end;
+
+        for (std::uint32_t t = begin; t < end; t++)
+        {
+            const std::uint32_t first = m_tetherChildren[2 * t];
+            const std::uint32_t second = m_tetherChildren[2 * t + 1];
+
+            const bool isIntact = level == 0 ? constraints[first].IsActive() && constraints[second].IsActive()
+                                             : m_tethers[first].IsActive() && m_tethers[second].IsActive();
+
+            // Intact links keep both ends in one island, so one end tells whether it sleeps
+            if (isIntact && !particles.IsSleeping(m_tethers[t].p_1))
+            {
+                m_tethers[t].RestoreConstraint();
+            }
+            else
+            {
+                m_tethers[t].DestroyConstraint();
+            }
+        }
+    }
+
+    for (std::size_t k = 0; k < m_prolongations.size(); k++)
+    {
+        const std::uint32_t* tethers = &m_prolongationTethers[4 * k];
+        m_isProlongationIntact[k] = m_tethers[tethers[0]].IsActive() && m_tethers[tethers[1]].IsActive() &&
+                                    m_tethers[tethers[2]].IsActive() && m_tethers[tethers[3]].IsActive();
+    }
+}
+
+void ConstraintHierarchy::Solve(ParticleBuffer& particles, ThreadPool& threadPool, bool isReference)
+{
+    if (m_tethers.empty()) { return; }
+
+    const std::size_t count = particles.Size();
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    // Displacements are measured from here
+    m_startX.resize(count);
+    m_startY.resize(count);
+    std::copy(x, x + count, m_startX.begin());
+    std::copy(y, y + count, m_startY.begin());
+
+    const float* startX = m_startX.data();
+    const float* startY = m_startY.data();
+    const std::uint8_t* intact = m_isProlongationIntact.data();
+
+    for (std::size_t level = m_levels.size(); level-- > 0;)
+    {
+        const Level& range = m_levels[level];
+
+        for (std::uint32_t b = range.batchBegin; b < range.batchEnd; b++)
+        {
+            auto solve = [this, &particles, isReference](std::size_t begin, std::size_t end)
+            {
+                if (isReference)
+                {
+                    ConstraintKernel::SolveScalar(ConstraintType::Tether, m_tethers.data(), begin, end, particles, 1.f, nullptr);
+                }
+                else
+                {
+                    ConstraintKernel::Solve(ConstraintType::Tether, m_tethers.data(), begin, end, particles, 1.f, nullptr);
+                }
+            };
+
+            threadPool.ParallelFor(m_batches[b].begin, m_batches[b].end, TETHER_GRAIN, std::cref(solve));
+        }
+
+        // Carry the coarse particles' total displacement so far onto the particles between them.
+        // Those have not moved yet, and only read corners, which nothing writes in this phase.
+        auto prolong = [&](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t k = begin; k < end; k++)
+            {
+                const Prolongation& entry = m_prolongations[k];
+                const std::uint32_t p = entry.particle;
+
+                if (!intact[k] || (flags[p] & (PARTICLE_ACTIVE | PARTICLE_PINNED | PARTICLE_SLEEPING)) != PARTICLE_ACTIVE) { continue; }
+
+                float deltaX = 0.f;
+                float deltaY = 0.f;
+                for (std::uint32_t corner : entry.corners)
+                {
+                    deltaX += x[corner] - startX[corner];
+                    deltaY += y[corner] - startY[corner];
+                }
+
+                x[p] += deltaX * 0.25f;
+                y[p] += deltaY * 0.25f;
+            }
+        };
+
+        threadPool.ParallelFor(range.prolongationBegin, range.prolongationEnd, PROLONGATION_GRAIN, std::cref(prolong));
+    }
+}
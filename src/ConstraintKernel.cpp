@@ -0,0 +1,466 @@
+#include "ConstraintKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CLOTH_CONSTRAINT_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace
+{
+    /// @brief Adds one structural constraint's violation to a residual.
+    inline void AddViolation(ConstraintResidual* residual, float violation)
+    {
+        residual->maxViolation = std::max(residual->maxViolation, violation);
+        residual->sumSquares += violation * violation;
+        residual->activeCount++;
+    }
+
+    /**
+     * Scalar reference for one constraint. The vector kernel below performs the
+     * same operations in the same order, so their results are bit-identical.
+     */
+    template <ConstraintType Type>
+    inline void SolveOne(const Constraint& constraint, float* x, float* y, float scale, ConstraintResidual* residual)
+    {
+        if (!constraint.IsActive()) { return; }
+
+        const std::uint32_t p1 = constraint.p_1;
+        const std::uint32_t p2 = constraint.p_2;
+        const float length = constraint.GetLength();
+
+        float differenceX = x[p1] - x[p2];
+        float differenceY = y[p1] - y[p2];
+        float distance = std::sqrt(differenceX * differenceX + differenceY * differenceY);
+
+        if (Type == ConstraintType::Structural && residual)
+        {
+            // Coincident particles count as fully violated
+            AddViolation(residual, distance == 0.f ? 1.f : std::fabs(length - distance) / length);
+        }
+
+        // Coincident particles have no direction to push apart in
+        if (distance == 0.f) { return; }
+
+        float factor = (length - distance) / distance;
+
+        // Bending links only push apart, tethers only pull together
+        if (Type == ConstraintType::Bending && !(factor > 0.f)) { return; }
+        if (Type == ConstraintType::Tether && !(factor < 0.f)) { return; }
+
+        float offsetX = differenceX * factor * scale;
+        float offsetY = differenceY * factor * scale;
+
+        x[p1] += offsetX;
+        y[p1] += offsetY;
+        x[p2] -= offsetX;
+        y[p2] -= offsetY;
+    }
+
+    /// @brief Half the correction goes to each particle; soft types scale it by their stiffness.
+    template <ConstraintType Type>
+    inline float GetScale(float stiffness)
+    {
+        return Type == ConstraintType::Structural || Type == ConstraintType::Tether ? 0.5f : 0.5f * stiffness;
+    }
+
+    /**
+     * XPBD reference for one constraint, with unit particle masses. The multiplier
+     * step is dlambda = -(C + alpha * lambda) / (2 + alpha); bending multipliers stay
+     * at or above zero (push apart only), tether multipliers at or below.
+     */
+    template <ConstraintType Type>
+    inline void SolveCompliantOne(const Constraint& constraint, float& lambda, float* x, float* y, float alpha, float denominator, ConstraintResidual* residual)
+    {
+        if (!constraint.IsActive()) { return; }
+
+        const std::uint32_t p1 = constraint.p_1;
+        const std::uint32_t p2 = constraint.p_2;
+        const float length = constraint.GetLength();
+
+        float differenceX = x[p1] - x[p2];
+        float differenceY = y[p1] - y[p2];
+        float distance = std::sqrt(differenceX * differenceX + differenceY * differenceY);
+
+        float violation = (distance - length) + alpha * lambda;
+
+        if (Type == ConstraintType::Structural && residual)
+        {
+            // Coincident particles count as fully violated
+            AddViolation(residual, distance == 0.f ? 1.f : std::fabs(violation) / length);
+        }
+
+        // Coincident particles have no direction to push apart in
+        if (distance == 0.f) { return; }
+
+        float deltaLambda = -violation / denominator;
+        float newLambda = lambda + deltaLambda;
+
+        if (Type == ConstraintType::Bending || Type == ConstraintType::Tether)
+        {
+            if (Type == ConstraintType::Bending ? !(newLambda > 0.f) : !(newLambda < 0.f)) { newLambda = 0.f; }
+            deltaLambda = newLambda - lambda;
+        }
+
+        lambda = newLambda;
+
+        float factor = deltaLambda / distance;
+        float offsetX = differenceX * factor;
+        float offsetY = differenceY * factor;
+
+        x[p1] += offsetX;
+        y[p1] += offsetY;
+        x[p2] -= offsetX;
+        y[p2] -= offsetY;
+    }
+
+    template <ConstraintType Type>
+    void SolveCompliantRangeScalar(Constraint* constraints, std::size_t begin, std::size_t end, float* x, float* y, float alpha, float* lambdas, ConstraintResidual* residual)
+    {
+        const float denominator = 2.f + alpha;
+
+        for (std::size_t c = begin; c < end; c++)
+        {
+            SolveCompliantOne<Type>(constraints[c], lambdas[c], x, y, alpha, denominator, residual);
+        }
+    }
+
+    template <ConstraintType Type>
+    void SolveRangeScalar(Constraint* constraints, std::size_t begin, std::size_t end, float* x, float* y, float stiffness, ConstraintResidual* residual)
+    {
+        const float scale = GetScale<Type>(stiffness);
+
+        for (std::size_t c = begin; c < end; c++)
+        {
+            SolveOne<Type>(constraints[c], x, y, scale, residual);
+        }
+    }
+
+#if defined(CLOTH_CONSTRAINT_SSE2)
+
+    // SSE2 has no blendv; select b where mask is set, a elsewhere
+    inline __m128 Select(__m128 a, __m128 b, __m128 mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+
+    /// @brief Lane mask for each 4-bit movemask value.
+    const __m128 MASKS[16] = {
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, 0)), _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, 0)), _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, 0)), _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, 0)), _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0)), _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(-1, 0, -1, 0)), _mm_castsi128_ps(_mm_set_epi32(-1, 0, -1, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(-1, -1, 0, 0)), _mm_castsi128_ps(_mm_set_epi32(-1, -1, 0, -1)),
+        _mm_castsi128_ps(_mm_set_epi32(-1, -1, -1, 0)), _mm_castsi128_ps(_mm_set_epi32(-1, -1, -1, -1))
+    };
+
+    template <ConstraintType Type>
+    void SolveRange(Constraint* constraints, std::size_t begin, std::size_t end, float* x, float* y, float stiffness, ConstraintResidual* residual)
+    {
+        const float scale = GetScale<Type>(stiffness);
+        const __m128 vScale = _mm_set1_ps(scale);
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vSign = _mm_set1_ps(-0.f);
+
+        std::size_t c = begin;
+        for (; c + 4 <= end; c += 4)
+        {
+            const Constraint* group = constraints + c;
+            const std::uint32_t a = group[0].p_1;
+            const std::uint32_t b = group[0].p_2;
+
+            int active = (group[0].IsActive() ? 1 : 0) | (group[1].IsActive() ? 2 : 0) | (group[2].IsActive() ? 4 : 0) | (group[3].IsActive() ? 8 : 0);
+            if (active == 0) { continue; }
+
+            // Vertical and bending links of one grid row step through both endpoints one particle at a time
+            const bool isContiguous = group[1].p_1 == a + 1 && group[2].p_1 == a + 2 && group[3].p_1 == a + 3 &&
+                                      group[1].p_2 == b + 1 && group[2].p_2 == b + 2 && group[3].p_2 == b + 3;
+
+            __m128 x1, y1, x2, y2;
+            if (isContiguous)
+            {
+                x1 = _mm_loadu_ps(x + a);
+                y1 = _mm_loadu_ps(y + a);
+                x2 = _mm_loadu_ps(x + b);
+                y2 = _mm_loadu_ps(y + b);
+            }
+            else
+            {
+                x1 = _mm_set_ps(x[group[3].p_1], x[group[2].p_1], x[group[1].p_1], x[a]);
+                y1 = _mm_set_ps(y[group[3].p_1], y[group[2].p_1], y[group[1].p_1], y[a]);
+                x2 = _mm_set_ps(x[group[3].p_2], x[group[2].p_2], x[group[1].p_2], x[b]);
+                y2 = _mm_set_ps(y[group[3].p_2], y[group[2].p_2], y[group[1].p_2], y[b]);
+            }
+
+            __m128 vLength = _mm_set_ps(group[3].GetLength(), group[2].GetLength(), group[1].GetLength(), group[0].GetLength());
+
+            __m128 dx = _mm_sub_ps(x1, x2);
+            __m128 dy = _mm_sub_ps(y1, y2);
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+            // Lanes with coincident particles are masked out below, so their division by zero is harmless
+            __m128 factor = _mm_div_ps(_mm_sub_ps(vLength, distance), distance);
+            int moving = active & ~_mm_movemask_ps(_mm_cmpeq_ps(distance, vZero));
+
+            if (Type == ConstraintType::Bending)
+            {
+                moving &= _mm_movemask_ps(_mm_cmpgt_ps(factor, vZero));
+            }
+            else if (Type == ConstraintType::Tether)
+            {
+                moving &= _mm_movemask_ps(_mm_cmplt_ps(factor, vZero));
+            }
+
+            __m128 offsetX = _mm_mul_ps(_mm_mul_ps(dx, factor), vScale);
+            __m128 offsetY = _mm_mul_ps(_mm_mul_ps(dy, factor), vScale);
+
+            if (Type == ConstraintType::Structural && residual)
+            {
+                // |length - distance| / length; accumulated lane by lane to keep the scalar order
+                alignas(16) float violation[4];
+                _mm_store_ps(violation, _mm_div_ps(_mm_andnot_ps(vSign, _mm_sub_ps(vLength, distance)), vLength));
+
+                for (int k = 0; k < 4; k++)
+                {
+                    if (!(active >> k & 1)) { continue; }
+
+                    AddViolation(residual, (moving >> k & 1) ? violation[k] : 1.f);
+                }
+            }
+
+            if (isContiguous)
+            {
+                // Lanes that do not move keep their exact old value
+                __m128 mask = MASKS[moving];
+                _mm_storeu_ps(x + a, Select(x1, _mm_add_ps(x1, offsetX), mask));
+                _mm_storeu_ps(y + a, Select(y1, _mm_add_ps(y1, offsetY), mask));
+                _mm_storeu_ps(x + b, Select(x2, _mm_sub_ps(x2, offsetX), mask));
+                _mm_storeu_ps(y + b, Select(y2, _mm_sub_ps(y2, offsetY), mask));
+                continue;
+            }
+
+            // Scatter the corrections; lanes share no particles
+            alignas(16) float ox[4], oy[4];
+            _mm_store_ps(ox, offsetX);
+            _mm_store_ps(oy, offsetY);
+
+            for (int k = 0; k < 4; k++)
+            {
+                if (!(moving >> k & 1)) { continue; }
+
+                x[group[k].p_1] += ox[k];
+                y[group[k].p_1] += oy[k];
+                x[group[k].p_2] -= ox[k];
+                y[group[k].p_2] -= oy[k];
+            }
+        }
+
+        // Remaining constraints that do not fill a whole batch
+        for (; c < end; c++)
+        {
+            SolveOne<Type>(constraints[c], x, y, scale, residual);
+        }
+    }
+
+    template <ConstraintType Type>
+    void SolveCompliantRange(Constraint* constraints, std::size_t begin, std::size_t end, float* x, float* y, float alpha, float* lambdas, ConstraintResidual* residual)
+    {
+        const float denominator = 2.f + alpha;
+        const __m128 vAlpha = _mm_set1_ps(alpha);
+        const __m128 vDenominator = _mm_set1_ps(denominator);
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vSign = _mm_set1_ps(-0.f);
+
+        std::size_t c = begin;
+        for (; c + 4 <= end; c += 4)
+        {
+            const Constraint* group = constraints + c;
+            const std::uint32_t a = group[0].p_1;
+            const std::uint32_t b = group[0].p_2;
+
+            int active = (group[0].IsActive() ? 1 : 0) | (group[1].IsActive() ? 2 : 0) | (group[2].IsActive() ? 4 : 0) | (group[3].IsActive() ? 8 : 0);
+            if (active == 0) { continue; }
+
+            const bool isContiguous = group[1].p_1 == a + 1 && group[2].p_1 == a + 2 && group[3].p_1 == a + 3 &&
+                                      group[1].p_2 == b + 1 && group[2].p_2 == b + 2 && group[3].p_2 == b + 3;
+
+            __m128 x1, y1, x2, y2;
+            if (isContiguous)
+            {
+                x1 = _mm_loadu_ps(x + a);
+                y1 = _mm_loadu_ps(y + a);
+                x2 = _mm_loadu_ps(x + b);
+                y2 = _mm_loadu_ps(y + b);
+            }
+            else
+            {
+                x1 = _mm_set_ps(x[group[3].p_1], x[group[2].p_1], x[group[1].p_1], x[a]);
+                y1 = _mm_set_ps(y[group[3].p_1], y[group[2].p_1], y[group[1].p_1], y[a]);
+                x2 = _mm_set_ps(x[group[3].p_2], x[group[2].p_2], x[group[1].p_2], x[b]);
+                y2 = _mm_set_ps(y[group[3].p_2], y[group[2].p_2], y[group[1].p_2], y[b]);
+            }
+
+            __m128 vLength = _mm_set_ps(group[3].GetLength(), group[2].GetLength(), group[1].GetLength(), group[0].GetLength());
+            __m128 lambda = _mm_loadu_ps(lambdas + c);
+
+            __m128 dx = _mm_sub_ps(x1, x2);
+            __m128 dy = _mm_sub_ps(y1, y2);
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+            __m128 violation = _mm_add_ps(_mm_sub_ps(distance, vLength), _mm_mul_ps(vAlpha, lambda));
+            __m128 deltaLambda = _mm_div_ps(_mm_xor_ps(violation, vSign), vDenominator);
+            __m128 newLambda = _mm_add_ps(lambda, deltaLambda);
+
+            if (Type == ConstraintType::Bending)
+            {
+                newLambda = Select(vZero, newLambda, _mm_cmpgt_ps(newLambda, vZero));
+                deltaLambda = _mm_sub_ps(newLambda, lambda);
+            }
+            else if (Type == ConstraintType::Tether)
+            {
+                newLambda = Select(vZero, newLambda, _mm_cmplt_ps(newLambda, vZero));
+                deltaLambda = _mm_sub_ps(newLambda, lambda);
+            }
+
+            // Lanes with coincident particles are masked out below, so their division by zero is harmless
+            __m128 factor = _mm_div_ps(deltaLambda, distance);
+            int moving = active & ~_mm_movemask_ps(_mm_cmpeq_ps(distance, vZero));
+
+            __m128 offsetX = _mm_mul_ps(dx, factor);
+            __m128 offsetY = _mm_mul_ps(dy, factor);
+
+            if (Type == ConstraintType::Structural && residual)
+            {
+                // |C + alpha * lambda| / length; accumulated lane by lane to keep the scalar order
+                alignas(16) float relative[4];
+                _mm_store_ps(relative, _mm_div_ps(_mm_andnot_ps(vSign, violation), vLength));
+
+                for (int k = 0; k < 4; k++)
+                {
+                    if (!(active >> k & 1)) { continue; }
+
+                    AddViolation(residual, (moving >> k & 1) ? relative[k] : 1.f);
+                }
+            }
+
+            // Multipliers of lanes that do not move keep their exact old value
+            __m128 mask = MASKS[moving];
+            _mm_storeu_ps(lambdas + c, Select(lambda, newLambda, mask));
+
+            if (isContiguous)
+            {
+                _mm_storeu_ps(x + a, Select(x1, _mm_add_ps(x1, offsetX), mask));
+                _mm_storeu_ps(y + a, Select(y1, _mm_add_ps(y1, offsetY), mask));
+                _mm_storeu_ps(x + b, Select(x2, _mm_sub_ps(x2, offsetX), mask));
+                _mm_storeu_ps(y + b, Select(y2, _mm_sub_ps(y2, offsetY), mask));
+                continue;
+            }
+
+            // Scatter the corrections; lanes share no particles
+            alignas(16) float ox[4], oy[4];
+            _mm_store_ps(ox, offsetX);
+            _mm_store_ps(oy, offsetY);
+
+            for (int k = 0; k < 4; k++)
+            {
+                if (!(moving >> k & 1)) { continue; }
+
+                x[group[k].p_1] += ox[k];
+                y[group[k].p_1] += oy[k];
+                x[group[k].p_2] -= ox[k];
+                y[group[k].p_2] -= oy[k];
+            }
+        }
+
+        // Remaining constraints that do not fill a whole batch
+        for (; c < end; c++)
+        {
+            SolveCompliantOne<Type>(constraints[c], lambdas[c], x, y, alpha, denominator, residual);
+        }
+    }
+
+#endif
+}
+
+void ConstraintKernel::SolveScalar(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                                   ParticleBuffer& particles, float stiffness, ConstraintResidual* residual)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+
+    switch (type)
+    {
+        case ConstraintType::Structural: SolveRangeScalar<ConstraintType::Structural>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Shear: SolveRangeScalar<ConstraintType::Shear>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Bending: SolveRangeScalar<ConstraintType::Bending>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Tether: SolveRangeScalar<ConstraintType::Tether>(constraints, begin, end, x, y, stiffness, residual); break;
+    }
+}
+
+void ConstraintKernel::SolveCompliantScalar(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                                            ParticleBuffer& particles, float alpha, float* lambdas, ConstraintResidual* residual)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+
+    switch (type)
+    {
+        case ConstraintType::Structural: SolveCompliantRangeScalar<ConstraintType::Structural>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Shear: SolveCompliantRangeScalar<ConstraintType::Shear>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Bending: SolveCompliantRangeScalar<ConstraintType::Bending>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Tether: SolveCompliantRangeScalar<ConstraintType::Tether>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+    }
+}
+
+#if defined(CLOTH_CONSTRAINT_SSE2)
+
+void ConstraintKernel::Solve(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                             ParticleBuffer& particles, float stiffness, ConstraintResidual* residual)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+
+    switch (type)
+    {
+        case ConstraintType::Structural: SolveRange<ConstraintType::Structural>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Shear: SolveRange<ConstraintType::Shear>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Bending: SolveRange<ConstraintType::Bending>(constraints, begin, end, x, y, stiffness, residual); break;
+        case ConstraintType::Tether: SolveRange<ConstraintType::Tether>(constraints, begin, end, x, y, stiffness, residual); break;
+    }
+}
+
+void ConstraintKernel::SolveCompliant(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                                      ParticleBuffer& particles, float alpha, float* lambdas, ConstraintResidual* residual)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+
+    switch (type)
+    {
+        case ConstraintType::Structural: SolveCompliantRange<ConstraintType::Structural>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Shear: SolveCompliantRange<ConstraintType::Shear>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Bending: SolveCompliantRange<ConstraintType::Bending>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+        case ConstraintType::Tether: SolveCompliantRange<ConstraintType::Tether>(constraints, begin, end, x, y, alpha, lambdas, residual); break;
+    }
+}
+
+const char* ConstraintKernel::GetKernelName() { return "SSE2"; }
+
+#else
+
+void ConstraintKernel::Solve(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                             ParticleBuffer& particles, float stiffness, ConstraintResidual* residual)
+{
+    SolveScalar(type, constraints, begin, end, particles, stiffness, residual);
+}
+
+void ConstraintKernel::SolveCompliant(ConstraintType type, Constraint* constraints, std::size_t begin, std::size_t end,
+                                      ParticleBuffer& particles, float alpha, float* lambdas, ConstraintResidual* residual)
+{
+    SolveCompliantScalar(type, constraints, begin, end, particles, alpha, lambdas, residual);
+}
+
+const char* ConstraintKernel::GetKernelName() { return "Scalar"; }
+
+#endif
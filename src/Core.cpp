@@ -1,4 +1,32 @@
 #include "Core.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    /// @brief File the profiler trace is written to (F2 and on exit).
+    const char* const TRACE_FILE = "cloth_trace.json";
+
+    /// @brief Seconds between two updates of the frame rate text.
+    constexpr float FPS_REFRESH_INTERVAL = 0.25f;
+
+    void DumpTrace()
+    {
+        if (Profiler::Get().WriteChromeTrace(TRACE_FILE))
+        {
+            std::cout << "Profiler trace written to " << TRACE_FILE << std::endl;
+        }
+        else
+        {
+            std::cerr << "Could not write " << TRACE_FILE << std::endl;
+        }
+    }
+}
 
 void Core::Run(sf::String title, unsigned int width, unsigned int height)
 {
@@ -32,8 +60,25 @@ void Core::Run(sf::String title, unsigned int width, unsigned int height)
     textFPS.setCharacterSize(15);
     textFPS.setFillColor(sf::Color::White);
 
+    // Frame rate is averaged over a short window rather than redrawn every frame
+    float fpsTime = 0.f;
+    int fpsFrames = 0;
+
+    // Per-phase timings, toggled with F1; F2 writes a Chrome trace
+    ProfilerOverlay profilerOverlay(font);
+
     // Fixed time step for consistent physics updates
-    const float FIXED_DELTA_TIME = 1.0f / 60.0f;
+    const float FIXED_DELTA_TIME = 1.0f / m_physicsRate;
+
+    // Real time not yet simulated
+    float accumulator = 0.f;
+
+    // Pipelined mode: physics keeps its own pace on a separate thread
+    if (m_isPipelined)
+    {
+        m_isPhysicsRunning = true;
+        m_physicsThread = std::thread(&Core::PhysicsLoop, this);
+    }
 
     // Main application loop
     while (win.isOpen())
@@ -42,29 +87,138 @@ void Core::Run(sf::String title, unsigned int width, unsigned int height)
         deltaTime = clock.restart().asSeconds();
 
         // Update FPS counter string
-        textFPS.setString("Frame Rate : " + std::to_string(1.f / deltaTime));
+        fpsTime += deltaTime;
+        fpsFrames++;
+        if (fpsTime >= FPS_REFRESH_INTERVAL)
+        {
+            textFPS.setString("Frame Rate : " + std::to_string(fpsFrames / fpsTime));
+            fpsTime = 0.f;
+            fpsFrames = 0;
+        }
 
         // === Event Polling ===
-        while (const std::optional event = win.pollEvent())
         {
-            // Close window if user clicks "X" or presses Escape
-            if (event->is<sf::Event::Closed>() || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Escape))
+            PROFILE_SCOPE("Events");
+
+            while (const std::optional event = win.pollEvent())
             {
-                isRunning = false;
-                win.close();
+                // Close window if user clicks "X" or presses Escape
+                if (event->is<sf::Event::Closed>() || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Escape))
+                {
+                    isRunning = false;
+                    win.close();
+                }
+                else if (const auto* key = event->getIf<sf::Event::KeyPressed>())
+                {
+                    if (key->code == sf::Keyboard::Key::F1) { profilerOverlay.Toggle(); }
+                    else if (key->code == sf::Keyboard::Key::F2) { DumpTrace(); }
+                    else { OnKeyPressed(key->code); }
+                }
             }
         }
 
         // === Logic Updates ===
-        FixedUpdate(FIXED_DELTA_TIME); // Physics or consistent logic
-        Update(deltaTime);           // Variable logic
+        {
+            PROFILE_SCOPE("Update");
+            Update(deltaTime);       // Variable logic (input is sampled here)
+        }
+
+        // Fraction of a step between the last physics state and now
+        float alpha = 1.f;
+
+        if (m_isLockstep && !m_isPipelined)
+        {
+            // Exactly one step per frame, so a session does not depend on how fast frames come
+            PROFILE_SCOPE("FixedUpdate");
+            FixedUpdate(FIXED_DELTA_TIME);
+        }
+        else if (!m_isPipelined)
+        {
+            // Run as many fixed steps as real time requires, up to the substep cap
+            accumulator += deltaTime;
+
+            int substeps = 0;
+            while (accumulator >= FIXED_DELTA_TIME && substeps < m_maxSubsteps)
+            {
+                PROFILE_SCOPE("FixedUpdate");
+                FixedUpdate(FIXED_DELTA_TIME); // Physics or consistent logic
+                accumulator -= FIXED_DELTA_TIME;
+                substeps++;
+            }
+
+            // Too far behind: drop the whole steps we could not afford, keep the phase
+            if (accumulator >= FIXED_DELTA_TIME)
+            {
+                accumulator = std::fmod(accumulator, FIXED_DELTA_TIME);
+            }
+
+            alpha = accumulator / FIXED_DELTA_TIME;
+        }
+
+        profilerOverlay.Update(deltaTime);
 
         // === Rendering ===
-        win.clear();         // Clear previous frame
-        Render();            // Custom drawing logic
-        win.draw(textFPS);   // Draw FPS counter
-        win.display();       // Present new frame
+        {
+            PROFILE_SCOPE("Render");
+            win.clear();         // Clear previous frame
+            Render(alpha);       // Custom drawing logic
+            win.draw(textFPS);   // Draw FPS counter
+            profilerOverlay.Draw(win);
+        }
+        {
+            PROFILE_SCOPE("Display");
+            win.display();       // Present new frame (waits for the frame rate limit)
+        }
+    }
+
+    // Stop the physics thread before the simulation data goes away
+    if (m_physicsThread.joinable())
+    {
+        m_isPhysicsRunning = false;
+        m_physicsThread.join();
+    }
+
+    // Keep the last few seconds of timings for offline inspection
+    DumpTrace();
+}
+
+void Core::PhysicsLoop()
+{
+    const float FIXED_DELTA_TIME = 1.0f / m_physicsRate;
+    const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_physicsRate));
+
+    auto nextStep = std::chrono::steady_clock::now();
+
+    while (m_isPhysicsRunning)
+    {
+        {
+            PROFILE_SCOPE("FixedUpdate");
+            FixedUpdate(FIXED_DELTA_TIME);
+        }
+
+        nextStep += step;
+
+        // Too far behind: drop the steps beyond the substep cap instead of racing to catch up
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextStep > step * m_maxSubsteps)
+        {
+            nextStep = now;
+        }
+
+        std::this_thread::sleep_until(nextStep);
     }
 }
 
 void Core::SetFrameRate(int framerate) { m_frameRate = framerate; /* Set the Frame Rate based on parameter input */ }
+
+void Core::SetPhysicsRate(int physicsRate) { m_physicsRate = std::max(physicsRate, 1); }
+
+void Core::SetMaxSubsteps(int maxSubsteps) { m_maxSubsteps = std::max(maxSubsteps, 1); }
+
+void Core::SetPipelined(bool pipelined) { m_isPipelined = pipelined; }
+
+bool Core::IsPipelined() const { return m_isPipelined; }
+
+void Core::SetLockstep(bool lockstep) { m_isLockstep = lockstep; }
+
+bool Core::IsLockstep() const { return m_isLockstep; }
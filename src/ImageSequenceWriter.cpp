@@ -0,0 +1,399 @@
+#include "ImageSequenceWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    /// @brief Largest payload of a stored deflate block.
+    constexpr std::size_t STORED_BLOCK_SIZE = 65535;
+
+    /// @brief Bytes Adler-32 can sum before its 32-bit accumulators must be reduced.
+    constexpr std::size_t ADLER_NMAX = 5552;
+    constexpr std::uint32_t ADLER_BASE = 65521;
+
+    /// @brief CRC-32 (PNG polynomial) tables for eight bytes at a time.
+    using CrcTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+    const CrcTables& GetCrcTables()
+    {
+        static const CrcTables tables = []
+        {
+            CrcTables t{};
+            for (std::uint32_t n = 0; n < 256; n++)
+            {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[0][n] = c;
+            }
+
+            for (std::uint32_t n = 0; n < 256; n++)
+            {
+                for (int k = 1; k < 8; k++)
+                {
+                    t[k][n] = t[0][t[k - 1][n] & 0xFF] ^ (t[k - 1][n] >> 8);
+                }
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    std::uint32_t Crc32(const std::uint8_t* data, std::size_t size)
+    {
+        const CrcTables& t = GetCrcTables();
+        std::uint32_t crc = 0xFFFFFFFFu;
+
+        // Slice-by-8: one table lookup per byte, but no dependency between the eight
+        for (; size >= 8; size -= 8, data += 8)
+        {
+            std::uint32_t low = crc ^ (static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+                                       static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24);
+            crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                  t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        }
+
+        for (; size > 0; size--, data++)
+        {
+            crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    /**
+     * @brief Running Adler-32 of the zlib stream, reduced only every ADLER_NMAX bytes.
+     */
+    struct Adler32
+    {
+        std::uint32_t a = 1, b = 0;
+
+        void Update(const std::uint8_t* data, std::size_t size)
+        {
+            while (size > 0)
+            {
+                std::size_t run = std::min(size, ADLER_NMAX);
+                size -= run;
+
+                for (; run > 0; run--)
+                {
+                    a += *data++;
+                    b += a;
+                }
+
+                a %= ADLER_BASE;
+                b %= ADLER_BASE;
+            }
+        }
+
+        std::uint32_t Get() const { return (b << 16) | a; }
+    };
+
+    void PutBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+    {
+        out.push_back(static_cast<std::uint8_t>(value >> 24));
+        out.push_back(static_cast<std::uint8_t>(value >> 16));
+        out.push_back(static_cast<std::uint8_t>(value >> 8));
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    /// @brief Starts a PNG chunk; returns where its length field is, for EndChunk.
+    std::size_t BeginChunk(std::vector<std::uint8_t>& out, const char* type)
+    {
+        std::size_t start = out.size();
+        PutBigEndian(out, 0);
+        out.insert(out.end(), type, type + 4);
+        return start;
+    }
+
+    /// @brief Fills in the length of the chunk begun at start and appends its CRC.
+    void EndChunk(std::vector<std::uint8_t>& out, std::size_t start)
+    {
+        std::uint32_t length = static_cast<std::uint32_t>(out.size() - start - 8);
+        out[start] = static_cast<std::uint8_t>(length >> 24);
+        out[start + 1] = static_cast<std::uint8_t>(length >> 16);
+        out[start + 2] = static_cast<std::uint8_t>(length >> 8);
+        out[start + 3] = static_cast<std::uint8_t>(length);
+
+        // The CRC covers the type and data but not the length
+        PutBigEndian(out, Crc32(out.data() + start + 4, out.size() - start - 4));
+    }
+
+    /**
+     * @brief Checks that a pattern formats exactly one int: %d, %Nd or %0Nd, and no other '%'.
+     */
+    bool IsValidPattern(const std::string& pattern)
+    {
+        int conversions = 0;
+
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            if (pattern[i] != '%') continue;
+
+            std::size_t j = i + 1;
+            while (j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9') j++;
+
+            if (j >= pattern.size() || pattern[j] != 'd') { return false; }
+
+            conversions++;
+            i = j;
+        }
+
+        return conversions == 1;
+    }
+
+    bool EndsWith(const std::string& text, const char* suffix)
+    {
+        std::size_t length = std::strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+}
+
+ImageSequenceWriter::~ImageSequenceWriter()
+{
+    Close();
+}
+
+bool ImageSequenceWriter::Open(const std::string& pattern, int width, int height)
+{
+    Close();
+
+    if (!IsValidPattern(pattern))
+    {
+        std::cerr << "Image sequence pattern needs exactly one %d: " << pattern << std::endl;
+        return false;
+    }
+
+    if (EndsWith(pattern, ".ppm")) { m_format = Format::Ppm; }
+    else if (EndsWith(pattern, ".png")) { m_format = Format::Png; }
+    else
+    {
+        std::cerr << "Image sequence pattern must end in .ppm or .png: " << pattern << std::endl;
+        return false;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "Invalid image size: " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    m_pattern = pattern;
+    m_nextIndex = 0;
+
+    // Size every slot up front so submitting never allocates
+    m_frames.resize(SLOT_COUNT);
+    for (std::uint32_t slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        m_frames[slot].image.Resize(width, height);
+        m_freeSlots.Push(slot);
+    }
+
+    m_droppedFrames = 0;
+    m_writtenFrames = 0;
+    m_failedFrames = 0;
+    m_isRunning = true;
+    m_thread = std::thread(&ImageSequenceWriter::WriterLoop, this);
+    return true;
+}
+
+bool ImageSequenceWriter::Submit(Image& image, bool waitForSlot)
+{
+    if (!IsOpen()) { return false; }
+
+    std::uint32_t slot;
+    while (!m_freeSlots.Pop(slot))
+    {
+        if (!waitForSlot)
+        {
+            m_droppedFrames++;
+            m_nextIndex++;
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    Frame& frame = m_frames[slot];
+    frame.index = m_nextIndex++;
+    std::swap(frame.image, image);
+
+    m_filledSlots.Push(slot);
+    m_wake.notify_one();
+    return true;
+}
+
+void ImageSequenceWriter::Close()
+{
+    if (!m_thread.joinable()) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_isRunning = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // Return every slot so the next Open starts from an empty queue
+    std::uint32_t slot;
+    while (m_freeSlots.Pop(slot)) {}
+    while (m_filledSlots.Pop(slot)) {}
+}
+
+bool ImageSequenceWriter::IsOpen() const { return m_thread.joinable(); }
+
+std::uint64_t ImageSequenceWriter::GetDroppedFrames() const { return m_droppedFrames; }
+
+std::uint64_t ImageSequenceWriter::GetWrittenFrames() const { return m_writtenFrames; }
+
+std::uint64_t ImageSequenceWriter::GetFailedFrames() const { return m_failedFrames; }
+
+void ImageSequenceWriter::WriterLoop()
+{
+    for (;;)
+    {
+        std::uint32_t slot;
+        if (m_filledSlots.Pop(slot))
+        {
+            WriteFrame(m_frames[slot]);
+            m_freeSlots.Push(slot);
+            continue;
+        }
+
+        // Queue drained: finish if closing, otherwise sleep until the next frame
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (!m_isRunning)
+        {
+            // Frames queued just before Close are still written
+            while (m_filledSlots.Pop(slot))
+            {
+                WriteFrame(m_frames[slot]);
+            }
+            break;
+        }
+
+        // The timeout covers a notification sent between the empty Pop and this wait
+        m_wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+}
+
+void ImageSequenceWriter::WriteFrame(const Frame& frame)
+{
+    if (m_format == Format::Png) { EncodePng(frame.image); }
+    else { EncodePpm(frame.image); }
+
+    char path[4096];
+    std::snprintf(path, sizeof(path), m_pattern.c_str(), static_cast<int>(frame.index));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(m_payload.data()), static_cast<std::streamsize>(m_payload.size()));
+
+    if (!file)
+    {
+        // Report the first failure only; a missing directory would fail every frame
+        if (m_failedFrames++ == 0) { std::cerr << "Failed to write " << path << std::endl; }
+        return;
+    }
+
+    m_writtenFrames++;
+}
+
+void ImageSequenceWriter::EncodePpm(const Image& image)
+{
+    char header[64];
+    int headerSize = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", image.width, image.height);
+
+    m_payload.clear();
+    m_payload.insert(m_payload.end(), header, header + headerSize);
+    m_payload.insert(m_payload.end(), image.pixels.begin(), image.pixels.end());
+}
+
+void ImageSequenceWriter::EncodePng(const Image& image)
+{
+    static const std::uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    const std::size_t rowSize = static_cast<std::size_t>(image.width) * 3;
+    const std::size_t streamSize = (rowSize + 1) * static_cast<std::size_t>(image.height);
+    const std::size_t blockCount = std::max<std::size_t>((streamSize + STORED_BLOCK_SIZE - 1) / STORED_BLOCK_SIZE, 1);
+
+    m_payload.clear();
+    m_payload.reserve(64 + streamSize + 5 * blockCount);
+    m_payload.insert(m_payload.end(), SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+
+    // 8-bit RGB, no interlacing
+    std::size_t chunk = BeginChunk(m_payload, "IHDR");
+    PutBigEndian(m_payload, static_cast<std::uint32_t>(image.width));
+    PutBigEndian(m_payload, static_cast<std::uint32_t>(image.height));
+    m_payload.insert(m_payload.end(), {8, 2, 0, 0, 0});
+    EndChunk(m_payload, chunk);
+
+    // One zlib stream of stored blocks; every row is prefixed with filter type 0 (none)
+    chunk = BeginChunk(m_payload, "IDAT");
+    m_payload.insert(m_payload.end(), {0x78, 0x01});
+
+    Adler32 adler;
+    std::size_t row = 0, column = 0;   // Position in the filtered stream; column 0 is the filter byte
+    std::size_t remaining = streamSize;
+
+    for (std::size_t block = 0; block < blockCount; block++)
+    {
+        const std::uint16_t length = static_cast<std::uint16_t>(std::min(remaining, STORED_BLOCK_SIZE));
+        const std::uint16_t inverse = static_cast<std::uint16_t>(~length);
+        remaining -= length;
+
+        m_payload.push_back(remaining == 0 ? 1 : 0);   // BFINAL, BTYPE = stored
+        m_payload.push_back(static_cast<std::uint8_t>(length));
+        m_payload.push_back(static_cast<std::uint8_t>(length >> 8));
+        m_payload.push_back(static_cast<std::uint8_t>(inverse));
+        m_payload.push_back(static_cast<std::uint8_t>(inverse >> 8));
+
+        // Copy the block in runs that end at row boundaries
+        std::size_t left = length;
+        while (left > 0)
+        {
+            if (column == 0)
+            {
+                m_payload.push_back(0);
+                column = 1;
+                left--;
+                continue;
+            }
+
+            const std::size_t run = std::min(left, rowSize + 1 - column);
+            const std::uint8_t* source = image.pixels.data() + row * rowSize + (column - 1);
+            m_payload.insert(m_payload.end(), source, source + run);
+
+            column += run;
+            left -= run;
+
+            if (column == rowSize + 1)
+            {
+                column = 0;
+                row++;
+            }
+        }
+    }
+
+    // Checksum of the uncompressed stream: the block contents, skipping their headers
+    const std::uint8_t* stream = m_payload.data() + chunk + 8 + 2;
+    for (std::size_t block = 0; block < blockCount; block++)
+    {
+        const std::size_t length = std::min(streamSize - block * STORED_BLOCK_SIZE, STORED_BLOCK_SIZE);
+        adler.Update(stream + 5, length);
+        stream += 5 + length;
+    }
+
+    PutBigEndian(m_payload, adler.Get());
+    EndChunk(m_payload, chunk);
+
+    chunk = BeginChunk(m_payload, "IEND");
+    EndChunk(m_payload, chunk);
+}
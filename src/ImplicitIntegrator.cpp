@@ -0,0 +1,438 @@
+#include "ImplicitIntegrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+    /// @brief Particles (rows) per chunk of a parallel sweep.
+    constexpr std::size_t ROW_GRAIN = 4096;
+
+    /// @brief Springs per chunk of a parallel sweep.
+    constexpr std::size_t SPRING_GRAIN = 8192;
+
+    /// @brief y += B x for a symmetric 2x2 block (xx, xy, yy).
+    inline void MultiplyAdd(const float* block, float x, float y, float& outX, float& outY)
+    {
+        outX += block[0] * x + block[1] * y;
+        outY += block[1] * x + block[2] * y;
+    }
+}
+
+void ImplicitIntegrator::Build(const ParticleBuffer& particles, const std::vector<Constraint>& constraints, const std::vector<ClothDesc>& cloths,
+                               const std::vector<std::uint32_t>& clothParticleBegin, const SolverSettings& settings)
+{
+    const std::size_t count = particles.Size();
+
+    // Shear and bending springs are as much softer than the threads as their position-solver stiffness says
+    m_springs.clear();
+    for (const Constraint& constraint : constraints)
+    {
+        if (!constraint.IsActive()) continue;
+
+        float scale = 1.f;
+        if (constraint.GetType() == ConstraintType::Shear) scale = settings.shearStiffness;
+        else if (constraint.GetType() == ConstraintType::Bending) scale = settings.bendingStiffness;
+
+        const float stiffness = settings.springStiffness * scale;
+        if (!(stiffness > 0.f)) continue;
+
+        m_springs.push_back(Spring{constraint.p_1, constraint.p_2, constraint.GetLength(), stiffness, constraint.GetType() == ConstraintType::Bending});
+    }
+
+    // Every spring appears in the rows of both its particles, in spring order
+    m_incidenceBegin.assign(count + 1, 0);
+    for (const Spring& spring : m_springs)
+    {
+        m_incidenceBegin[spring.p1 + 1]++;
+        m_incidenceBegin[spring.p2 + 1]++;
+    }
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        m_incidenceBegin[i + 1] += m_incidenceBegin[i];
+    }
+
+    m_incidences.resize(m_incidenceBegin[count]);
+    m_rowBegin.assign(count + 1, 0);
+
+    {
+        // m_rowBegin doubles as the fill cursor of each row here
+        for (std::uint32_t s = 0; s < m_springs.size(); s++)
+        {
+            const Spring& spring = m_springs[s];
+            m_incidences[m_incidenceBegin[spring.p1] + m_rowBegin[spring.p1]++] = Incidence{s, spring.p2, 0};
+            m_incidences[m_incidenceBegin[spring.p2] + m_rowBegin[spring.p2]++] = Incidence{s, spring.p1, 0};
+        }
+    }
+
+    // One off-diagonal block per distinct neighbour, in column order
+    m_columns.clear();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        Incidence* begin = m_incidences.data() + m_incidenceBegin[i];
+        Incidence* end = m_incidences.data() + m_incidenceBegin[i + 1];
+
+        std::sort(begin, end, [](const Incidence& a, const Incidence& b) { return a.other != b.other ? a.other < b.other : a.spring < b.spring; });
+
+        m_rowBegin[i] = static_cast<std::uint32_t>(m_columns.size());
+        for (Incidence* incidence = begin; incidence != end; incidence++)
+        {
+            if (m_columns.size() == m_rowBegin[i] || m_columns.back() != incidence->other)
+            {
+                m_columns.push_back(incidence->other);
+            }
+            incidence->block = static_cast<std::uint32_t>(m_columns.size() - 1);
+        }
+    }
+    m_rowBegin[count] = static_cast<std::uint32_t>(m_columns.size());
+
+    // Gravity and drag of each particle's cloth, in the units the Verlet integrator uses
+    m_gravity.resize(count);
+    m_damping.resize(count);
+    for (std::size_t cloth = 0; cloth < cloths.size(); cloth++)
+    {
+        const float damping = 1.0f - cloths[cloth].drag;
+        for (std::uint32_t i = clothParticleBegin[cloth]; i < clothParticleBegin[cloth + 1]; i++)
+        {
+            m_gravity[i] = cloths[cloth].gravity * 100.f * damping;
+            m_damping[i] = damping;
+        }
+    }
+
+    // Size everything a step touches, so stepping never allocates
+    m_springBlocks.resize(3 * m_springs.size());
+    m_springForces.resize(2 * m_springs.size());
+    m_blocks.resize(3 * m_columns.size());
+    m_diagonal.resize(3 * count);
+    m_inverseDiagonal.resize(3 * count);
+    m_isFixed.resize(count);
+
+    for (std::vector<float>* vector : {&m_velocity, &m_rhs, &m_deltaVelocity, &m_residual, &m_preconditioned, &m_direction, &m_product})
+    {
+        vector->resize(2 * count);
+    }
+
+    m_chunkSums.resize(2 * ((count + ROW_GRAIN - 1) / ROW_GRAIN));
+}
+
+void ImplicitIntegrator::SumChunks(std::size_t chunkCount, double& first, double& second) const
+{
+    first = 0.0;
+    second = 0.0;
+
+    for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        first += m_chunkSums[2 * chunk];
+        second += m_chunkSums[2 * chunk + 1];
+    }
+}
+
+void ImplicitIntegrator::Step(ParticleBuffer& particles, float deltaTime, float boundsWidth, float boundsHeight, const SolverSettings& settings, ThreadPool& pool)
+{
+    const std::size_t count = particles.Size();
+    const std::size_t chunkCount = (count + ROW_GRAIN - 1) / ROW_GRAIN;
+    const float h = deltaTime;
+    const float hSquared = h * h;
+
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    float* lastX = particles.GetLastX();
+    float* lastY = particles.GetLastY();
+    const float* pinX = particles.GetPinX();
+    const float* pinY = particles.GetPinY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    // Verlet velocities with drag applied; fixed particles do not move
+    auto velocities = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const bool isFixed = (flags[i] & (PARTICLE_ACTIVE | PARTICLE_PINNED | PARTICLE_SLEEPING)) != PARTICLE_ACTIVE;
+            m_isFixed[i] = isFixed;
+            m_velocity[2 * i] = isFixed ? 0.f : (x[i] - lastX[i]) / h * m_damping[i];
+            m_velocity[2 * i + 1] = isFixed ? 0.f : (y[i] - lastY[i]) / h * m_damping[i];
+        }
+    };
+
+    pool.ParallelFor(0, count, ROW_GRAIN, std::cref(velocities));
+
+    // Force and stiffness block of every spring: H_e = k (n n^T + max(0, 1 - L / l) (I - n n^T)).
+    // Dropping the negative transverse term under compression keeps the matrix positive definite.
+    auto springs = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t s = begin; s < end; s++)
+        {
+            const Spring& spring = m_springs[s];
+            float* block = &m_springBlocks[3 * s];
+            float* force = &m_springForces[2 * s];
+
+            const float dx = x[spring.p1] - x[spring.p2];
+            const float dy = y[spring.p1] - y[spring.p2];
+            const float distance = std::sqrt(dx * dx + dy * dy);
+
+            // Coincident particles have no direction; stretched bending links are slack
+            if (distance == 0.f || (spring.isPushOnly && distance >= spring.length))
+            {
+                block[0] = block[1] = block[2] = 0.f;
+                force[0] = force[1] = 0.f;
+                continue;
+            }
+
+            const float nx = dx / distance;
+            const float ny = dy / distance;
+            const float stretch = distance - spring.length;
+            const float transverse = std::max(0.f, stretch / distance);
+
+            block[0] = spring.stiffness * (nx * nx + transverse * (1.f - nx * nx));
+            block[1] = spring.stiffness * (nx * ny - transverse * nx * ny);
+            block[2] = spring.stiffness * (ny * ny + transverse * (1.f - ny * ny));
+
+            force[0] = -spring.stiffness * stretch * nx;
+            force[1] = -spring.stiffness * stretch * ny;
+        }
+    };
+
+    pool.ParallelFor(0, m_springs.size(), SPRING_GRAIN, std::cref(springs));
+
+    // Every row gathers its springs: A = I + h^2 H, b = h (f + g - h H v).
+    // Rows own their blocks, so rows can be assembled in parallel without conflicts.
+    auto assemble = [&](std::size_t begin, std::size_t end)
+    {
+        double rhsSquared = 0.0;
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            float* diagonal = &m_diagonal[3 * i];
+            diagonal[0] = 1.f;
+            diagonal[1] = 0.f;
+            diagonal[2] = 1.f;
+
+            std::fill(m_blocks.begin() + 3 * m_rowBegin[i], m_blocks.begin() + 3 * m_rowBegin[i + 1], 0.f);
+
+            float forceX = 0.f, forceY = 0.f;
+            float stiffnessVX = 0.f, stiffnessVY = 0.f;
+
+            for (std::uint32_t k = m_incidenceBegin[i]; k < m_incidenceBegin[i + 1]; k++)
+            {
+                const Incidence& incidence = m_incidences[k];
+                const float* block = &m_springBlocks[3 * incidence.spring];
+                const float sign = m_springs[incidence.spring].p1 == i ? 1.f : -1.f;
+
+                diagonal[0] += hSquared * block[0];
+                diagonal[1] += hSquared * block[1];
+                diagonal[2] += hSquared * block[2];
+
+                float* offDiagonal = &m_blocks[3 * incidence.block];
+                offDiagonal[0] -= hSquared * block[0];
+                offDiagonal[1] -= hSquared * block[1];
+                offDiagonal[2] -= hSquared * block[2];
+
+                forceX += sign * m_springForces[2 * incidence.spring];
+                forceY += sign * m_springForces[2 * incidence.spring + 1];
+
+                const float relativeX = m_velocity[2 * i] - m_velocity[2 * incidence.other];
+                const float relativeY = m_velocity[2 * i + 1] - m_velocity[2 * incidence.other + 1];
+                MultiplyAdd(block, relativeX, relativeY, stiffnessVX, stiffnessVY);
+            }
+
+            const float determinant = diagonal[0] * diagonal[2] - diagonal[1] * diagonal[1];
+            float* inverse = &m_inverseDiagonal[3 * i];
+            inverse[0] = diagonal[2] / determinant;
+            inverse[1] = -diagonal[1] / determinant;
+            inverse[2] = diagonal[0] / determinant;
+
+            float* rhs = &m_rhs[2 * i];
+            if (m_isFixed[i])
+            {
+                rhs[0] = rhs[1] = 0.f;
+            }
+            else
+            {
+                rhs[0] = h * (forceX - h * stiffnessVX);
+                rhs[1] = h * (forceY + m_gravity[i] - h * stiffnessVY);
+            }
+
+            rhsSquared += static_cast<double>(rhs[0]) * rhs[0] + static_cast<double>(rhs[1]) * rhs[1];
+        }
+
+        m_chunkSums[2 * (begin / ROW_GRAIN)] = rhsSquared;
+        m_chunkSums[2 * (begin / ROW_GRAIN) + 1] = 0.0;
+    };
+
+    pool.ParallelFor(0, count, ROW_GRAIN, std::cref(assemble));
+
+    double rhsSquared, unused;
+    SumChunks(chunkCount, rhsSquared, unused);
+
+    // Preconditioned conjugate gradient from dv = 0: r = b, z = P r, p = z
+    auto start = [&](std::size_t begin, std::size_t end)
+    {
+        double rz = 0.0;
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const float* inverse = &m_inverseDiagonal[3 * i];
+            const float rx = m_rhs[2 * i], ry = m_rhs[2 * i + 1];
+            float zx = 0.f, zy = 0.f;
+            MultiplyAdd(inverse, rx, ry, zx, zy);
+
+            m_deltaVelocity[2 * i] = m_deltaVelocity[2 * i + 1] = 0.f;
+            m_residual[2 * i] = rx;
+            m_residual[2 * i + 1] = ry;
+            m_preconditioned[2 * i] = m_direction[2 * i] = zx;
+            m_preconditioned[2 * i + 1] = m_direction[2 * i + 1] = zy;
+
+            rz += static_cast<double>(rx) * zx + static_cast<double>(ry) * zy;
+        }
+
+        m_chunkSums[2 * (begin / ROW_GRAIN)] = rz;
+        m_chunkSums[2 * (begin / ROW_GRAIN) + 1] = 0.0;
+    };
+
+    pool.ParallelFor(0, count, ROW_GRAIN, std::cref(start));
+
+    double rz;
+    SumChunks(chunkCount, rz, unused);
+
+    // q = A p, with fixed rows and columns filtered out
+    auto multiply = [&](std::size_t begin, std::size_t end)
+    {
+        double pq = 0.0;
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            float qx = 0.f, qy = 0.f;
+
+            if (!m_isFixed[i])
+            {
+                MultiplyAdd(&m_diagonal[3 * i], m_direction[2 * i], m_direction[2 * i + 1], qx, qy);
+
+                for (std::uint32_t b = m_rowBegin[i]; b < m_rowBegin[i + 1]; b++)
+                {
+                    const std::uint32_t j = m_columns[b];
+                    MultiplyAdd(&m_blocks[3 * b], m_direction[2 * j], m_direction[2 * j + 1], qx, qy);
+                }
+            }
+
+            m_product[2 * i] = qx;
+            m_product[2 * i + 1] = qy;
+            pq += static_cast<double>(m_direction[2 * i]) * qx + static_cast<double>(m_direction[2 * i + 1]) * qy;
+        }
+
+        m_chunkSums[2 * (begin / ROW_GRAIN)] = pq;
+        m_chunkSums[2 * (begin / ROW_GRAIN) + 1] = 0.0;
+    };
+
+    float alpha = 0.f, beta = 0.f;
+
+    // dv += alpha p, r -= alpha q, z = P r
+    auto update = [&](std::size_t begin, std::size_t end)
+    {
+        double rzNew = 0.0, rr = 0.0;
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            m_deltaVelocity[2 * i] += alpha * m_direction[2 * i];
+            m_deltaVelocity[2 * i + 1] += alpha * m_direction[2 * i + 1];
+
+            const float rx = m_residual[2 * i] -= alpha * m_product[2 * i];
+            const float ry = m_residual[2 * i + 1] -= alpha * m_product[2 * i + 1];
+
+            float zx = 0.f, zy = 0.f;
+            MultiplyAdd(&m_inverseDiagonal[3 * i], rx, ry, zx, zy);
+            m_preconditioned[2 * i] = zx;
+            m_preconditioned[2 * i + 1] = zy;
+
+            rzNew += static_cast<double>(rx) * zx + static_cast<double>(ry) * zy;
+            rr += static_cast<double>(rx) * rx + static_cast<double>(ry) * ry;
+        }
+
+        m_chunkSums[2 * (begin / ROW_GRAIN)] = rzNew;
+        m_chunkSums[2 * (begin / ROW_GRAIN) + 1] = rr;
+    };
+
+    // p = z + beta p
+    auto advance = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = 2 * begin; i < 2 * end; i++)
+        {
+            m_direction[i] = m_preconditioned[i] + beta * m_direction[i];
+        }
+    };
+
+    const double toleranceSquared = static_cast<double>(settings.cgTolerance) * settings.cgTolerance * rhsSquared;
+    double residualSquared = rhsSquared;
+    m_lastIterations = 0;
+
+    while (m_lastIterations < settings.cgMaxIterations && residualSquared > toleranceSquared)
+    {
+        pool.ParallelFor(0, count, ROW_GRAIN, std::cref(multiply));
+
+        double pq;
+        SumChunks(chunkCount, pq, unused);
+
+        // Only reached with a non-positive curvature through round-off; stop at the current iterate
+        if (!(pq > 0.0)) { break; }
+
+        alpha = static_cast<float>(rz / pq);
+        pool.ParallelFor(0, count, ROW_GRAIN, std::cref(update));
+
+        double rzNew;
+        SumChunks(chunkCount, rzNew, residualSquared);
+        m_lastIterations++;
+
+        beta = static_cast<float>(rzNew / rz);
+        rz = rzNew;
+        pool.ParallelFor(0, count, ROW_GRAIN, std::cref(advance));
+    }
+
+    m_lastResidual = rhsSquared > 0.0 ? static_cast<float>(std::sqrt(residualSquared / rhsSquared)) : 0.f;
+
+    // x += h (v + dv), keeping Verlet's last position as the velocity and its bounds handling
+    auto move = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; i++)
+        {
+            if (!(flags[i] & PARTICLE_ACTIVE) || (flags[i] & PARTICLE_SLEEPING)) continue;
+
+            if (flags[i] & PARTICLE_PINNED)
+            {
+                x[i] = pinX[i];
+                y[i] = pinY[i];
+                continue;
+            }
+
+            const float newX = x[i] + h * (m_velocity[2 * i] + m_deltaVelocity[2 * i]);
+            const float newY = y[i] + h * (m_velocity[2 * i + 1] + m_deltaVelocity[2 * i + 1]);
+
+            lastX[i] = x[i];
+            lastY[i] = y[i];
+            x[i] = newX;
+            y[i] = newY;
+
+            if (x[i] > boundsWidth)
+            {
+                x[i] = boundsWidth;
+                lastX[i] = x[i];
+            }
+            else if (x[i] < 0)
+            {
+                x[i] = 0;
+            }
+
+            if (y[i] > boundsHeight)
+            {
+                y[i] = boundsHeight;
+                lastY[i] = y[i];
+            }
+            else if (y[i] < 0)
+            {
+                y[i] = 0;
+            }
+        }
+    };
+
+    pool.ParallelFor(0, count, ROW_GRAIN, std::cref(move));
+}
@@ -0,0 +1,113 @@
+#include "InputLog.h"
+
+#include <cstring>
+
+bool InputLogWriter::Open(const std::string& path, float deltaTime, int boundsWidth, int boundsHeight)
+{
+    Close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) { return false; }
+
+    InputLogFormat::Header header{};
+    std::memcpy(header.magic, InputLogFormat::MAGIC, sizeof(header.magic));
+    header.version = InputLogFormat::VERSION;
+    header.deltaTime = deltaTime;
+    header.boundsWidth = boundsWidth;
+    header.boundsHeight = boundsHeight;
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!m_file)
+    {
+        m_file.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool InputLogWriter::IsOpen() const { return m_file.is_open(); }
+
+void InputLogWriter::Write(const ClothInput& input, bool isReset)
+{
+    if (!IsOpen()) { return; }
+
+    InputLogFormat::Record record;
+    record.mouseX = input.mousePos.x;
+    record.mouseY = input.mousePos.y;
+    record.lastMouseX = input.lastMousePos.x;
+    record.lastMouseY = input.lastMousePos.y;
+    record.cursorSize = input.cursorSize;
+    record.bits = (input.isDragging ? InputLogFormat::INPUT_DRAGGING : 0u) |
+                  (input.isCutting ? InputLogFormat::INPUT_CUTTING : 0u) |
+                  (input.isPinning ? InputLogFormat::INPUT_PINNING : 0u) |
+                  (isReset ? InputLogFormat::INPUT_RESET : 0u);
+
+    m_file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+void InputLogWriter::Close()
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+    m_file.clear();
+}
+
+bool InputLogReader::Open(const std::string& path)
+{
+    m_file.close();
+    m_file.clear();
+    m_stepCount = 0;
+
+    m_file.open(path, std::ios::binary | std::ios::ate);
+    if (!m_file) { return false; }
+
+    const std::streamoff fileSize = m_file.tellg();
+    m_file.seekg(0);
+
+    InputLogFormat::Header header;
+    m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!m_file || std::memcmp(header.magic, InputLogFormat::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != InputLogFormat::VERSION || !(header.deltaTime > 0.f) ||
+        header.boundsWidth <= 0 || header.boundsHeight <= 0)
+    {
+        m_file.close();
+        return false;
+    }
+
+    // A record cut short by a crash is ignored
+    m_deltaTime = header.deltaTime;
+    m_boundsWidth = header.boundsWidth;
+    m_boundsHeight = header.boundsHeight;
+    m_stepCount = static_cast<std::uint64_t>(fileSize - static_cast<std::streamoff>(sizeof(header))) / sizeof(InputLogFormat::Record);
+    return true;
+}
+
+bool InputLogReader::Read(ClothInput& input, bool& isReset)
+{
+    if (!m_file.is_open()) { return false; }
+
+    InputLogFormat::Record record;
+    m_file.read(reinterpret_cast<char*>(&record), sizeof(record));
+    if (!m_file) { return false; }
+
+    input.mousePos = {record.mouseX, record.mouseY};
+    input.lastMousePos = {record.lastMouseX, record.lastMouseY};
+    input.cursorSize = record.cursorSize;
+    input.isDragging = (record.bits & InputLogFormat::INPUT_DRAGGING) != 0;
+    input.isCutting = (record.bits & InputLogFormat::INPUT_CUTTING) != 0;
+    input.isPinning = (record.bits & InputLogFormat::INPUT_PINNING) != 0;
+    isReset = (record.bits & InputLogFormat::INPUT_RESET) != 0;
+    return true;
+}
+
+float InputLogReader::GetDeltaTime() const { return m_deltaTime; }
+
+int InputLogReader::GetBoundsWidth() const { return m_boundsWidth; }
+
+int InputLogReader::GetBoundsHeight() const { return m_boundsHeight; }
+
+std::uint64_t InputLogReader::GetStepCount() const { return m_stepCount; }
@@ -0,0 +1,188 @@
+#include "IslandSet.h"
+
+#include <algorithm>
+#include <numeric>
+
+std::uint32_t IslandSet::Find(std::uint32_t particle)
+{
+    while (m_parent[particle] != particle)
+    {
+        m_parent[particle] = m_parent[m_parent[particle]];
+        particle = m_parent[particle];
+    }
+
+    return particle;
+}
+
+void IslandSet::Build(ParticleBuffer& particles, const std::vector<Constraint>& constraints)
+{
+    const std::size_t count = particles.Size();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    m_parent.resize(count);
+    std::iota(m_parent.begin(), m_parent.end(), 0u);
+
+    // Every active link joins two sets; the lower root wins, so a root precedes all its members
+    for (const Constraint& constraint : constraints)
+    {
+        if (!constraint.IsActive() || !particles.IsActive(constraint.p_1) || !particles.IsActive(constraint.p_2)) continue;
+
+        std::uint32_t first = Find(constraint.p_1);
+        std::uint32_t second = Find(constraint.p_2);
+        if (first == second) continue;
+
+        m_parent[std::max(first, second)] = std::min(first, second);
+    }
+
+    // Number the islands in particle order; an island sleeps only if all its particles do
+    m_islandOfParticle.resize(count);
+    m_islands.clear();
+    m_isWakePending = false;
+
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        if (!(flags[i] & PARTICLE_ACTIVE))
+        {
+            m_islandOfParticle[i] = NO_ISLAND;
+            continue;
+        }
+
+        const std::uint32_t root = Find(i);
+        if (root == i)
+        {
+            m_islandOfParticle[i] = static_cast<std::uint32_t>(m_islands.size());
+            m_islands.emplace_back();
+            m_islands.back().isSleeping = true;
+        }
+        else
+        {
+            m_islandOfParticle[i] = m_islandOfParticle[root];
+        }
+
+        if (!(flags[i] & PARTICLE_SLEEPING))
+        {
+            m_islands[m_islandOfParticle[i]].isSleeping = false;
+        }
+    }
+
+    UpdateFlags(particles);
+}
+
+bool IslandSet::Update(ParticleBuffer& particles, const std::vector<ParticleRun>& runs, float sleepSpeed, std::uint32_t sleepSteps)
+{
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+    const float* previousX = particles.GetPreviousX();
+    const float* previousY = particles.GetPreviousY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    for (Island& island : m_islands)
+    {
+        island.maxSpeedSquared = 0.f;
+    }
+
+    // Pinned particles never move, so only free ones tell whether an island rests.
+    // Islands mostly cover long stretches of particles, so the maximum is kept locally until the island changes.
+    for (const ParticleRun& run : runs)
+    {
+        std::uint32_t current = NO_ISLAND;
+        float maxSpeedSquared = 0.f;
+
+        for (std::uint32_t i = run.begin; i < run.end; i++)
+        {
+            if ((flags[i] & (PARTICLE_ACTIVE | PARTICLE_PINNED | PARTICLE_SLEEPING)) != PARTICLE_ACTIVE) continue;
+
+            if (m_islandOfParticle[i] != current)
+            {
+                if (current != NO_ISLAND)
+                {
+                    m_islands[current].maxSpeedSquared = std::max(m_islands[current].maxSpeedSquared, maxSpeedSquared);
+                }
+                current = m_islandOfParticle[i];
+                maxSpeedSquared = 0.f;
+            }
+
+            const float deltaX = x[i] - previousX[i];
+            const float deltaY = y[i] - previousY[i];
+            maxSpeedSquared = std::max(maxSpeedSquared, deltaX * deltaX + deltaY * deltaY);
+        }
+
+        if (current != NO_ISLAND)
+        {
+            m_islands[current].maxSpeedSquared = std::max(m_islands[current].maxSpeedSquared, maxSpeedSquared);
+        }
+    }
+
+    bool hasFallenAsleep = false;
+    const float sleepSpeedSquared = sleepSpeed * sleepSpeed;
+
+    for (Island& island : m_islands)
+    {
+        if (island.isSleeping) continue;
+
+        island.restingSteps = island.maxSpeedSquared < sleepSpeedSquared ? island.restingSteps + 1 : 0;
+
+        if (island.restingSteps >= sleepSteps)
+        {
+            island.isSleeping = true;
+            hasFallenAsleep = true;
+        }
+    }
+
+    if (hasFallenAsleep)
+    {
+        UpdateFlags(particles);
+    }
+
+    return hasFallenAsleep;
+}
+
+void IslandSet::Wake(std::uint32_t particle)
+{
+    const std::uint32_t island = m_islandOfParticle[particle];
+    if (island == NO_ISLAND || !m_islands[island].isSleeping) { return; }
+
+    m_islands[island].isWakeRequested = true;
+    m_isWakePending = true;
+}
+
+bool IslandSet::ApplyWakes(ParticleBuffer& particles)
+{
+    if (!m_isWakePending) { return false; }
+
+    for (Island& island : m_islands)
+    {
+        if (!island.isWakeRequested) continue;
+
+        island.isWakeRequested = false;
+        island.isSleeping = false;
+        island.restingSteps = 0;
+    }
+
+    m_isWakePending = false;
+    UpdateFlags(particles);
+    return true;
+}
+
+std::size_t IslandSet::GetSleepingCount() const
+{
+    return static_cast<std::size_t>(std::count_if(m_islands.begin(), m_islands.end(), [](const Island& island) { return island.isSleeping; }));
+}
+
+void IslandSet::UpdateFlags(ParticleBuffer& particles) const
+{
+    for (std::uint32_t i = 0; i < m_islandOfParticle.size(); i++)
+    {
+        const std::uint32_t island = m_islandOfParticle[i];
+        const bool isSleeping = island != NO_ISLAND && m_islands[island].isSleeping;
+
+        if (isSleeping && !particles.IsSleeping(i))
+        {
+            particles.Sleep(i);
+        }
+        else if (!isSleeping && particles.IsSleeping(i))
+        {
+            particles.Wake(i);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include "ParticleBuffer.h"
+
+#include <algorithm>
+
+void ParticleBuffer::Reserve(std::size_t count)
+{
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_lastX.reserve(count);
+    m_lastY.reserve(count);
+    m_previousX.reserve(count);
+    m_previousY.reserve(count);
+    m_startX.reserve(count);
+    m_startY.reserve(count);
+    m_pinX.reserve(count);
+    m_pinY.reserve(count);
+    m_flags.reserve(count);
+    m_startFlags.reserve(count);
+}
+
+std::uint32_t ParticleBuffer::Add(float x, float y)
+{
+    // Position, last, previous, start position and pin anchor all begin at the same point
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_lastX.push_back(x);
+    m_lastY.push_back(y);
+    m_previousX.push_back(x);
+    m_previousY.push_back(y);
+    m_startX.push_back(x);
+    m_startY.push_back(y);
+    m_pinX.push_back(x);
+    m_pinY.push_back(y);
+    m_flags.push_back(PARTICLE_ACTIVE);
+    m_startFlags.push_back(PARTICLE_ACTIVE);
+
+    return static_cast<std::uint32_t>(m_x.size() - 1);
+}
+
+void ParticleBuffer::Clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_lastX.clear();
+    m_lastY.clear();
+    m_previousX.clear();
+    m_previousY.clear();
+    m_startX.clear();
+    m_startY.clear();
+    m_pinX.clear();
+    m_pinY.clear();
+    m_flags.clear();
+    m_startFlags.clear();
+}
+
+void ParticleBuffer::ResetToStart()
+{
+    std::copy(m_startX.begin(), m_startX.end(), m_x.begin());
+    std::copy(m_startY.begin(), m_startY.end(), m_y.begin());
+    std::copy(m_startX.begin(), m_startX.end(), m_lastX.begin());
+    std::copy(m_startY.begin(), m_startY.end(), m_lastY.begin());
+    std::copy(m_startX.begin(), m_startX.end(), m_previousX.begin());
+    std::copy(m_startY.begin(), m_startY.end(), m_previousY.begin());
+    std::copy(m_startX.begin(), m_startX.end(), m_pinX.begin());
+    std::copy(m_startY.begin(), m_startY.end(), m_pinY.begin());
+    std::copy(m_startFlags.begin(), m_startFlags.end(), m_flags.begin());
+}
+
+std::size_t ParticleBuffer::Size() const { return m_x.size(); }
+
+void ParticleBuffer::StorePreviousPositions()
+{
+    std::copy(m_x.begin(), m_x.end(), m_previousX.begin());
+    std::copy(m_y.begin(), m_y.end(), m_previousY.begin());
+}
+
+// Pins the particle to its start position (it will not move), also after a reset
+void ParticleBuffer::Pin(std::uint32_t index)
+{
+    m_flags[index] |= PARTICLE_PINNED;
+    m_startFlags[index] |= PARTICLE_PINNED;
+}
+
+// Holds the particle at its current position until the next reset
+void ParticleBuffer::PinInPlace(std::uint32_t index)
+{
+    m_flags[index] |= PARTICLE_PINNED;
+    m_pinX[index] = m_x[index];
+    m_pinY[index] = m_y[index];
+    m_lastX[index] = m_x[index];
+    m_lastY[index] = m_y[index];
+}
+
+// Takes the particle out of the simulation; it is no longer integrated
+void ParticleBuffer::Deactivate(std::uint32_t index) { m_flags[index] &= ~PARTICLE_ACTIVE; }
+
+bool ParticleBuffer::IsActive(std::uint32_t index) const { return (m_flags[index] & PARTICLE_ACTIVE) != 0; }
+
+bool ParticleBuffer::IsPinned(std::uint32_t index) const { return (m_flags[index] & PARTICLE_PINNED) != 0; }
+
+// Stops the particle where it is; it keeps its position until woken
+void ParticleBuffer::Sleep(std::uint32_t index)
+{
+    m_flags[index] |= PARTICLE_SLEEPING;
+    m_lastX[index] = m_x[index];
+    m_lastY[index] = m_y[index];
+}
+
+void ParticleBuffer::Wake(std::uint32_t index) { m_flags[index] &= ~PARTICLE_SLEEPING; }
+
+void ParticleBuffer::WakeAll()
+{
+    for (std::uint8_t& flags : m_flags)
+    {
+        flags &= ~PARTICLE_SLEEPING;
+    }
+}
+
+bool ParticleBuffer::IsSleeping(std::uint32_t index) const { return (m_flags[index] & PARTICLE_SLEEPING) != 0; }
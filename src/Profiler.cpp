@@ -0,0 +1,165 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+    // Small, stable per-thread ids make traces easier to read than native thread ids
+    std::atomic<std::uint32_t> nextThreadId{0};
+    thread_local std::uint32_t threadId = nextThreadId.fetch_add(1);
+}
+
+Profiler::Profiler() : m_slots(new Slot[CAPACITY]), m_epoch(std::chrono::steady_clock::now()) {}
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+std::int64_t Profiler::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void Profiler::SetEnabled(bool enabled) { m_isEnabled.store(enabled, std::memory_order_relaxed); }
+
+bool Profiler::IsEnabled() const { return m_isEnabled.load(std::memory_order_relaxed); }
+
+void Profiler::Record(const char* name, std::int64_t startNs, std::int64_t endNs)
+{
+    std::uint64_t index = m_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = m_slots[index & (CAPACITY - 1)];
+
+    // Mark the slot as being written, then fill it and stamp it with its index
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.thread.store(threadId, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::CopyEvents(std::vector<ProfileEvent>& events) const
+{
+    events.clear();
+
+    std::uint64_t head = m_head.load(std::memory_order_acquire);
+    std::uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+    events.reserve(static_cast<std::size_t>(head - first));
+
+    for (std::uint64_t index = first; index < head; index++)
+    {
+        const Slot& slot = m_slots[index & (CAPACITY - 1)];
+
+        std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != index + 1) { continue; }
+
+        ProfileEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+        event.startNs = slot.startNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+
+        // Discard the copy if a writer reused the slot meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) { continue; }
+
+        events.push_back(event);
+    }
+}
+
+void Profiler::ComputeStats(std::vector<PhaseStats>& stats, std::size_t samplesPerPhase) const
+{
+    stats.clear();
+
+    std::vector<ProfileEvent> events;
+    CopyEvents(events);
+
+    // Group durations by phase, newest first, keeping at most samplesPerPhase each
+    std::vector<std::vector<double>> durations;
+
+    for (auto it = events.rbegin(); it != events.rend(); ++it)
+    {
+        std::size_t phase = 0;
+        while (phase < stats.size() && std::strcmp(stats[phase].name, it->name) != 0) { phase++; }
+
+        if (phase == stats.size())
+        {
+            stats.push_back(PhaseStats{it->name});
+            durations.emplace_back();
+        }
+
+        if (durations[phase].size() < samplesPerPhase)
+        {
+            durations[phase].push_back(it->durationNs * 1e-6);
+        }
+    }
+
+    for (std::size_t phase = 0; phase < stats.size(); phase++)
+    {
+        std::vector<double>& samples = durations[phase];
+
+        auto percentile = [&samples](double p)
+        {
+            std::size_t rank = std::min(samples.size() - 1, static_cast<std::size_t>(p * samples.size()));
+            std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+            return samples[rank];
+        };
+
+        stats[phase].samples = samples.size();
+        stats[phase].p50Ms = percentile(0.50);
+        stats[phase].p99Ms = percentile(0.99);
+    }
+
+    // Built newest first; report in order of first appearance
+    std::reverse(stats.begin(), stats.end());
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) const
+{
+    std::vector<ProfileEvent> events;
+    CopyEvents(events);
+
+    std::ofstream file(path);
+    if (!file) { return false; }
+
+    // Complete ("X") events with microsecond timestamps
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+    for (std::size_t i = 0; i < events.size(); i++)
+    {
+        const ProfileEvent& event = events[i];
+        file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+             << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}"
+             << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+
+    file << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(file);
+}
+
+ProfileScope::ProfileScope(const char* name) : m_name(name), m_startNs(-1)
+{
+    Profiler& profiler = Profiler::Get();
+    if (profiler.IsEnabled())
+    {
+        m_startNs = profiler.Now();
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    // Scopes that started while recording was off are not recorded
+    if (m_startNs >= 0)
+    {
+        Profiler& profiler = Profiler::Get();
+        profiler.Record(m_name, m_startNs, profiler.Now());
+    }
+}
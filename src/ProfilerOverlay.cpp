@@ -0,0 +1,51 @@
+#include "ProfilerOverlay.h"
+
+#include <cstdio>
+#include <string>
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font) : m_text(font)
+{
+    m_text.setCharacterSize(13);
+    m_text.setFillColor(sf::Color::Yellow);
+    m_text.setPosition({0.f, 20.f});
+}
+
+void ProfilerOverlay::Toggle()
+{
+    m_isVisible = !m_isVisible;
+
+    // Refresh on the next update instead of showing stale numbers
+    m_sinceRefresh = REFRESH_INTERVAL;
+}
+
+bool ProfilerOverlay::IsVisible() const { return m_isVisible; }
+
+void ProfilerOverlay::Update(float deltaTime)
+{
+    if (!m_isVisible) { return; }
+
+    m_sinceRefresh += deltaTime;
+    if (m_sinceRefresh < REFRESH_INTERVAL) { return; }
+    m_sinceRefresh = 0.f;
+
+    Profiler::Get().ComputeStats(m_stats, SAMPLE_WINDOW);
+
+    std::string text = "Phase            p50 ms   p99 ms\n";
+    char line[96];
+
+    for (const PhaseStats& stats : m_stats)
+    {
+        std::snprintf(line, sizeof(line), "%-14s %8.3f %8.3f\n", stats.name, stats.p50Ms, stats.p99Ms);
+        text += line;
+    }
+
+    m_text.setString(text);
+}
+
+void ProfilerOverlay::Draw(sf::RenderWindow& win) const
+{
+    if (m_isVisible)
+    {
+        win.draw(m_text);
+    }
+}
@@ -0,0 +1,303 @@
+#include "SelfCollision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+/// @brief Particles each thread resolves per chunk.
+static constexpr std::size_t COLLISION_GRAIN = 4096;
+
+/// @brief Grid cells per particle the cell size aims for once cells are larger than the distance.
+static constexpr float CELLS_PER_PARTICLE = 2.f;
+
+void SelfCollision::ResizeGrid(const ParticleBuffer& particles, float minDistance, ThreadPool& threadPool)
+{
+    const std::size_t count = particles.Size();
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    // Bounding box of the active particles, one per chunk; min and max do not depend on the order they are combined in
+    m_chunkBounds.resize(4 * ((count + COLLISION_GRAIN - 1) / COLLISION_GRAIN));
+    float* chunkBounds = m_chunkBounds.data();
+
+    auto bound = [=](std::size_t begin, std::size_t end)
+    {
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+
+        // Selects rather than an early continue and std::min: the compiler keeps the four bounds in separate registers
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const bool isActive = (flags[i] & PARTICLE_ACTIVE) != 0;
+            const float px = x[i];
+            const float py = y[i];
+
+            minX = isActive && px < minX ? px : minX;
+            minY = isActive && py < minY ? py : minY;
+            maxX = isActive && px > maxX ? px : maxX;
+            maxY = isActive && py > maxY ? py : maxY;
+        }
+
+        float* out = chunkBounds + 4 * (begin / COLLISION_GRAIN);
+        out[0] = minX;
+        out[1] = minY;
+        out[2] = maxX;
+        out[3] = maxY;
+    };
+
+    threadPool.ParallelFor(0, count, COLLISION_GRAIN, std::cref(bound));
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max();
+    float maxY = -std::numeric_limits<float>::max();
+    for (std::size_t chunk = 0; chunk < m_chunkBounds.size(); chunk += 4)
+    {
+        minX = std::min(minX, m_chunkBounds[chunk]);
+        minY = std::min(minY, m_chunkBounds[chunk + 1]);
+        maxX = std::max(maxX, m_chunkBounds[chunk + 2]);
+        maxY = std::max(maxY, m_chunkBounds[chunk + 3]);
+    }
+
+    // No active particles: one empty cell
+    if (minX > maxX)
+    {
+        minX = maxX = minY = maxY = 0.f;
+    }
+
+    const float width = maxX - minX;
+    const float height = maxY - minY;
+
+    // Cells at least as large as the distance keep the neighbourhood a particle searches small.
+    // A spread-out cloth would leave most cells empty, and every cell is cleared and summed
+    // each step, so the cells grow to keep their count near the budget; the second term
+    // bounds it for long, thin boxes too.
+    const float cellBudget = CELLS_PER_PARTICLE * static_cast<float>(std::max<std::size_t>(count, 1));
+    m_cellSize = std::max({minDistance, std::sqrt(width * height / cellBudget), (width + height) / cellBudget});
+    m_inverseCellSize = 1.f / m_cellSize;
+    m_originX = minX;
+    m_originY = minY;
+    m_columns = static_cast<int>(width * m_inverseCellSize) + 1;
+    m_rows = static_cast<int>(height * m_inverseCellSize) + 1;
+}
+
+void SelfCollision::BuildGrid(const ParticleBuffer& particles)
+{
+    const std::size_t count = particles.Size();
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    const std::size_t cellCount = static_cast<std::size_t>(m_columns) * m_rows;
+    m_cellStart.assign(cellCount + 1, 0);
+    m_cellOfParticle.resize(count);
+
+    // Raw pointers and locals, as the stores below could otherwise alias the members
+    std::uint32_t* cellStart = m_cellStart.data();
+    std::uint32_t* cellOfParticle = m_cellOfParticle.data();
+    const float inverseCellSize = m_inverseCellSize;
+    const float originX = m_originX;
+    const float originY = m_originY;
+    const int columns = m_columns;
+    const int rows = m_rows;
+
+    // Count particles per cell; rounding can put the farthest ones one cell out, so they are clamped
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if ((flags[i] & PARTICLE_ACTIVE) == 0)
+        {
+            cellOfParticle[i] = NOT_STORED;
+            continue;
+        }
+
+        int column = std::min(std::max(static_cast<int>((x[i] - originX) * inverseCellSize), 0), columns - 1);
+        int row = std::min(std::max(static_cast<int>((y[i] - originY) * inverseCellSize), 0), rows - 1);
+
+        std::uint32_t cell = static_cast<std::uint32_t>(row) * columns + column;
+        cellOfParticle[i] = cell;
+        cellStart[cell + 1]++;
+    }
+
+    // Prefix sum turns counts into start offsets
+    for (std::size_t cell = 0; cell < cellCount; cell++)
+    {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+
+    const std::uint32_t stored = cellStart[cellCount];
+    m_sorted.resize(stored);
+    m_sortedX.resize(stored);
+    m_sortedY.resize(stored);
+    m_sortedSleeping.resize(stored);
+
+    // Scatter in index order, so each cell lists its particles in ascending order
+    m_cellCursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+
+    std::uint32_t* cellCursor = m_cellCursor.data();
+    std::uint32_t* sorted = m_sorted.data();
+    float* sortedX = m_sortedX.data();
+    float* sortedY = m_sortedY.data();
+    std::uint8_t* sortedSleeping = m_sortedSleeping.data();
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::uint32_t cell = cellOfParticle[i];
+        if (cell == NOT_STORED) { continue; }
+
+        std::uint32_t slot = cellCursor[cell]++;
+        sorted[slot] = static_cast<std::uint32_t>(i);
+        sortedX[slot] = x[i];
+        sortedY[slot] = y[i];
+        sortedSleeping[slot] = (flags[i] & PARTICLE_SLEEPING) ? 1 : 0;
+    }
+}
+
+void SelfCollision::Solve(ParticleBuffer& particles, float minDistance, ThreadPool& threadPool)
+{
+    m_lastContactCount = 0;
+    m_sleepingContacts.clear();
+    if (minDistance <= 0.f || particles.Size() == 0) { return; }
+
+    ResizeGrid(particles, minDistance, threadPool);
+    BuildGrid(particles);
+
+    const std::size_t stored = m_sorted.size();
+    const std::size_t chunkCount = (stored + COLLISION_GRAIN - 1) / COLLISION_GRAIN;
+    m_sleeperOf.resize(stored);
+    m_chunkContacts.assign(chunkCount, 0);
+    m_chunkSleepingContacts.assign(chunkCount, 0);
+
+    const float minDistanceSquared = minDistance * minDistance;
+    const float inverseCellSize = m_inverseCellSize;
+    const float originX = m_originX;
+    const float originY = m_originY;
+    const int columns = m_columns;
+    const int rows = m_rows;
+
+    // Raw pointers keep the hot loop free of reloads through this
+    const std::uint32_t* cellStart = m_cellStart.data();
+    const float* sortedX = m_sortedX.data();
+    const float* sortedY = m_sortedY.data();
+    const std::uint8_t* sortedSleeping = m_sortedSleeping.data();
+    const std::uint32_t* sorted = m_sorted.data();
+    const std::uint8_t* flags = particles.GetFlags();
+    std::uint32_t* sleeperOf = m_sleeperOf.data();
+    std::uint32_t* chunkContacts = m_chunkContacts.data();
+    std::uint32_t* chunkSleepingContacts = m_chunkSleepingContacts.data();
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+
+    // The narrowphase only reads the sorted copies, so every particle can move itself as soon as its sum is known
+    auto resolve = [=](std::size_t begin, std::size_t end)
+    {
+        std::uint32_t contacts = 0;
+        std::uint32_t sleepingContacts = 0;
+
+        for (std::size_t k = begin; k < end; k++)
+        {
+            // Sleeping particles are not moved, and their awake neighbours count the contacts
+            sleeperOf[k] = NOT_STORED;
+            if (sortedSleeping[k]) { continue; }
+
+            const float px = sortedX[k];
+            const float py = sortedY[k];
+
+            // Only the cells the distance reaches into; with cells wider than the distance often one or two per axis
+            const int firstColumn = std::max(static_cast<int>((px - minDistance - originX) * inverseCellSize), 0);
+            const int lastColumn = std::min(static_cast<int>((px + minDistance - originX) * inverseCellSize), columns - 1);
+            const int firstRow = std::max(static_cast<int>((py - minDistance - originY) * inverseCellSize), 0);
+            const int lastRow = std::min(static_cast<int>((py + minDistance - originY) * inverseCellSize), rows - 1);
+
+            float deltaX = 0.f;
+            float deltaY = 0.f;
+            std::uint32_t sleeper = NOT_STORED;
+
+            for (int r = firstRow; r <= lastRow; r++)
+            {
+                // Cells of one grid row are adjacent in the sorted order, so the columns are one contiguous range
+                const std::size_t rowStart = static_cast<std::size_t>(r) * columns;
+                const std::uint32_t first = cellStart[rowStart + firstColumn];
+                const std::uint32_t last = cellStart[rowStart + lastColumn + 1];
+
+                for (std::uint32_t j = first; j < last; j++)
+                {
+                    float dx = px - sortedX[j];
+                    float dy = py - sortedY[j];
+                    float distanceSquared = dx * dx + dy * dy;
+
+                    if (distanceSquared >= minDistanceSquared || j == k) { continue; }
+
+                    if (sortedSleeping[j] && sleeper == NOT_STORED)
+                    {
+                        sleeper = sorted[j];
+                    }
+
+                    if (distanceSquared > 0.f)
+                    {
+                        // Each particle of the pair moves half the overlap away from the other
+                        float distance = std::sqrt(distanceSquared);
+                        float push = 0.5f * (minDistance - distance) / distance;
+                        deltaX += dx * push;
+                        deltaY += dy * push;
+                    }
+                    else
+                    {
+                        // Coincident particles: separate along x, lower index to the left
+                        deltaX += (k < j ? -0.5f : 0.5f) * minDistance;
+                    }
+
+                    // Count each pair once
+                    contacts += k < j || sortedSleeping[j] ? 1 : 0;
+                }
+            }
+
+            // Every particle appears once in the sorted order, so this is its only writer
+            const std::uint32_t particle = sorted[k];
+            if (flags[particle] & PARTICLE_PINNED) { continue; }
+
+            x[particle] += deltaX;
+            y[particle] += deltaY;
+
+            if (sleeper != NOT_STORED)
+            {
+                sleeperOf[k] = sleeper;
+                sleepingContacts++;
+            }
+        }
+
+        chunkContacts[begin / COLLISION_GRAIN] = contacts;
+        chunkSleepingContacts[begin / COLLISION_GRAIN] = sleepingContacts;
+    };
+
+    threadPool.ParallelFor(0, stored, COLLISION_GRAIN, std::cref(resolve));
+
+    // Report contacts with sleepers in sorted order, visiting only the chunks that found any
+    for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        m_lastContactCount += m_chunkContacts[chunk];
+        if (m_chunkSleepingContacts[chunk] == 0) { continue; }
+
+        const std::size_t end = std::min(stored, (chunk + 1) * COLLISION_GRAIN);
+        for (std::size_t k = chunk * COLLISION_GRAIN; k < end; k++)
+        {
+            if (m_sleeperOf[k] != NOT_STORED)
+            {
+                m_sleepingContacts.push_back(SleepingContact{m_sorted[k], m_sleeperOf[k]});
+            }
+        }
+    }
+}
+
+void SelfCollision::Clear()
+{
+    m_lastContactCount = 0;
+    m_sleepingContacts.clear();
+}
+
+std::uint32_t SelfCollision::GetLastContactCount() const { return m_lastContactCount; }
+
+const std::vector<SelfCollision::SleepingContact>& SelfCollision::GetSleepingContacts() const { return m_sleepingContacts; }
@@ -0,0 +1,334 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace
+{
+    /// @brief Number of segments each thread transforms and bins per chunk.
+    constexpr std::size_t SEGMENT_GRAIN = 4096;
+
+    /// @brief Segments per full circle of a collider outline (as in ClothRenderer).
+    constexpr int CIRCLE_SEGMENTS = 32;
+
+    constexpr float PI = 3.14159265f;
+
+    /// @brief Palette entries of Segment::color.
+    enum SegmentColor : std::uint32_t
+    {
+        COLOR_THREAD,
+        COLOR_SELECTED,
+        COLOR_COLLIDER,
+        COLOR_HIDDEN = 0xFFFFFFFFu
+    };
+
+    constexpr std::uint8_t PALETTE[3][3] = {
+        {255, 255, 255},
+        {255, 0, 0},
+        {128, 128, 128}
+    };
+
+    /// @brief Appends points on an arc around a center, from one angle to another (inclusive).
+    void AppendArc(float centerX, float centerY, float radius, float from, float to, int segments, std::vector<float>& points)
+    {
+        for (int i = 0; i <= segments; i++)
+        {
+            float angle = from + (to - from) * static_cast<float>(i) / static_cast<float>(segments);
+            points.push_back(centerX + radius * std::cos(angle));
+            points.push_back(centerY + radius * std::sin(angle));
+        }
+    }
+
+    /// @brief Blends a color into one pixel with the given coverage.
+    inline void Plot(Image& image, int x, int y, float coverage, const std::uint8_t* color)
+    {
+        const int alpha = static_cast<int>(coverage * 256.f + 0.5f);
+        std::uint8_t* pixel = &image.pixels[(static_cast<std::size_t>(y) * image.width + x) * 3];
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            pixel[channel] = static_cast<std::uint8_t>((pixel[channel] * (256 - alpha) + color[channel] * alpha) >> 8);
+        }
+    }
+
+    /**
+     * Draws the part of an anti-aliased line inside the rectangle [left, right) x [top, bottom).
+     * Steps one pixel along the major axis and splits each step's coverage between the two
+     * pixels straddling the line. Pixel centers sit at half-integer coordinates.
+     */
+    void DrawLine(float x0, float y0, float x1, float y1, int left, int top, int right, int bottom, const std::uint8_t* color, Image& image)
+    {
+        const bool isSteep = std::fabs(y1 - y0) > std::fabs(x1 - x0);
+
+        // Walk along x; steep lines are walked along y with the axes swapped
+        if (isSteep)
+        {
+            std::swap(x0, y0);
+            std::swap(x1, y1);
+            std::swap(left, top);
+            std::swap(right, bottom);
+        }
+
+        if (x0 > x1)
+        {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+
+        // Shorter than a pixel step (or a point): nothing to walk along
+        if (!(x1 > x0)) { return; }
+
+        const float gradient = (y1 - y0) / (x1 - x0);
+        const int first = static_cast<int>(std::max(std::ceil(x0 - 0.5f), static_cast<float>(left)));
+        const int last = static_cast<int>(std::min(std::floor(x1 - 0.5f), static_cast<float>(right - 1)));
+
+        for (int major = first; major <= last; major++)
+        {
+            const float minor = y0 + (static_cast<float>(major) + 0.5f - x0) * gradient - 0.5f;
+            const float below = std::floor(minor);
+            const float fraction = minor - below;
+            const int row = static_cast<int>(below);
+
+            // The two pixels straddling the line, each kept only inside the rectangle
+            for (int k = 0; k < 2; k++)
+            {
+                const int minorPixel = row + k;
+                if (minorPixel < top || minorPixel >= bottom) continue;
+
+                const float coverage = k == 0 ? 1.f - fraction : fraction;
+                if (isSteep) { Plot(image, minorPixel, major, coverage, color); }
+                else { Plot(image, major, minorPixel, coverage, color); }
+            }
+        }
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer()
+{
+    // Draw on the calling thread until told otherwise
+    m_threadPool = std::make_shared<ThreadPool>(1);
+}
+
+void SoftwareRenderer::SetThreadCount(unsigned threadCount)
+{
+    m_threadPool = std::make_shared<ThreadPool>(threadCount);
+}
+
+void SoftwareRenderer::SetThreadPool(std::shared_ptr<ThreadPool> threadPool)
+{
+    m_threadPool = threadPool ? std::move(threadPool) : std::make_shared<ThreadPool>(1);
+}
+
+void SoftwareRenderer::SetColliders(const std::vector<Collider>& colliders)
+{
+    m_colliderLines.clear();
+    std::vector<float> points;
+
+    for (const Collider& collider : colliders)
+    {
+        points.clear();
+
+        switch (collider.shape)
+        {
+            case ColliderShape::Circle:
+                AppendArc(collider.x0, collider.y0, collider.radius, 0.f, 2.f * PI, CIRCLE_SEGMENTS - 1, points);
+                break;
+
+            case ColliderShape::Box:
+                points.insert(points.end(), {collider.x0, collider.y0, collider.x1, collider.y0, collider.x1, collider.y1, collider.x0, collider.y1});
+                break;
+
+            case ColliderShape::Capsule:
+            {
+                // Half circle around each end; closing the polygon draws the sides
+                float angle = std::atan2(collider.y1 - collider.y0, collider.x1 - collider.x0);
+                AppendArc(collider.x1, collider.y1, collider.radius, angle - 0.5f * PI, angle + 0.5f * PI, CIRCLE_SEGMENTS / 2, points);
+                AppendArc(collider.x0, collider.y0, collider.radius, angle + 0.5f * PI, angle + 1.5f * PI, CIRCLE_SEGMENTS / 2, points);
+                break;
+            }
+        }
+
+        // Closed polygon: one line from every point to the next
+        const std::size_t pointCount = points.size() / 2;
+        for (std::size_t i = 0; i < pointCount; i++)
+        {
+            const std::size_t next = (i + 1) % pointCount;
+            m_colliderLines.insert(m_colliderLines.end(), {points[2 * i], points[2 * i + 1], points[2 * next], points[2 * next + 1]});
+        }
+    }
+}
+
+bool SoftwareRenderer::GetTileRange(const Segment& segment, int& tileX0, int& tileY0, int& tileX1, int& tileY1) const
+{
+    // Anti-aliasing spills up to a pixel past the line
+    const float minX = std::min(segment.x0, segment.x1) - 1.f;
+    const float maxX = std::max(segment.x0, segment.x1) + 1.f;
+    const float minY = std::min(segment.y0, segment.y1) - 1.f;
+    const float maxY = std::max(segment.y0, segment.y1) + 1.f;
+
+    const float width = static_cast<float>(m_tileCountX * TILE_SIZE);
+    const float height = static_cast<float>(m_tileCountY * TILE_SIZE);
+
+    // Also rejects NaN coordinates
+    if (!(maxX >= 0.f && minX < width && maxY >= 0.f && minY < height)) { return false; }
+
+    tileX0 = static_cast<int>(std::max(minX, 0.f)) / TILE_SIZE;
+    tileY0 = static_cast<int>(std::max(minY, 0.f)) / TILE_SIZE;
+    tileX1 = static_cast<int>(std::min(maxX, width - 1.f)) / TILE_SIZE;
+    tileY1 = static_cast<int>(std::min(maxY, height - 1.f)) / TILE_SIZE;
+    return true;
+}
+
+void SoftwareRenderer::Render(const Cloth& cloth, Image& image)
+{
+    if (image.width <= 0 || image.height <= 0) { return; }
+
+    m_tileCountX = (image.width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tileCountY = (image.height + TILE_SIZE - 1) / TILE_SIZE;
+    const std::size_t tileCount = static_cast<std::size_t>(m_tileCountX) * m_tileCountY;
+
+    // Fit the simulation bounds into the image, centered
+    const float boundsWidth = static_cast<float>(std::max(cloth.GetBoundsWidth(), 1));
+    const float boundsHeight = static_cast<float>(std::max(cloth.GetBoundsHeight(), 1));
+    const float scale = std::min(image.width / boundsWidth, image.height / boundsHeight);
+    const float offsetX = 0.5f * (image.width - boundsWidth * scale);
+    const float offsetY = 0.5f * (image.height - boundsHeight * scale);
+
+    // Colliders first, so the cloth is drawn over them
+    const std::size_t colliderCount = m_colliderLines.size() / 4;
+    const std::size_t segmentCount = colliderCount + cloth.GetStructuralConstraintCount();
+    const std::size_t chunkCount = (segmentCount + SEGMENT_GRAIN - 1) / SEGMENT_GRAIN;
+
+    m_segments.resize(segmentCount);
+    m_chunkTileCounts.assign(chunkCount * tileCount, 0);
+
+    const Constraint* constraints = cloth.GetConstraints().data();
+    const float* x = cloth.GetParticles().GetX();
+    const float* y = cloth.GetParticles().GetY();
+    const float* lines = m_colliderLines.data();
+
+    // Transform every segment and count how many fall into each tile, per chunk
+    auto count = [&](std::size_t begin, std::size_t end)
+    {
+        std::uint32_t* counts = &m_chunkTileCounts[(begin / SEGMENT_GRAIN) * tileCount];
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            Segment& segment = m_segments[i];
+
+            if (i < colliderCount)
+            {
+                const float* line = lines + 4 * i;
+                segment = Segment{line[0] * scale + offsetX, line[1] * scale + offsetY, line[2] * scale + offsetX, line[3] * scale + offsetY, COLOR_COLLIDER};
+            }
+            else
+            {
+                const Constraint& constraint = constraints[i - colliderCount];
+                if (!constraint.IsActive())
+                {
+                    segment.color = COLOR_HIDDEN;
+                    continue;
+                }
+
+                segment = Segment{x[constraint.p_1] * scale + offsetX, y[constraint.p_1] * scale + offsetY,
+                                  x[constraint.p_2] * scale + offsetX, y[constraint.p_2] * scale + offsetY,
+                                  constraint.IsSelected() ? COLOR_SELECTED : COLOR_THREAD};
+            }
+
+            int tileX0, tileY0, tileX1, tileY1;
+            if (!GetTileRange(segment, tileX0, tileY0, tileX1, tileY1))
+            {
+                segment.color = COLOR_HIDDEN;
+                continue;
+            }
+
+            for (int tileY = tileY0; tileY <= tileY1; tileY++)
+            {
+                for (int tileX = tileX0; tileX <= tileX1; tileX++)
+                {
+                    counts[tileY * m_tileCountX + tileX]++;
+                }
+            }
+        }
+    };
+
+    m_threadPool->ParallelFor(0, segmentCount, SEGMENT_GRAIN, std::cref(count));
+
+    // Turn counts into write offsets: tile by tile, and chunk by chunk within a tile,
+    // so every tile lists its segments in segment order
+    m_tileBegin.resize(tileCount + 1);
+    std::uint32_t total = 0;
+
+    for (std::size_t tile = 0; tile < tileCount; tile++)
+    {
+        m_tileBegin[tile] = total;
+
+        for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            std::uint32_t& slot = m_chunkTileCounts[chunk * tileCount + tile];
+            const std::uint32_t segments = slot;
+            slot = total;
+            total += segments;
+        }
+    }
+
+    m_tileBegin[tileCount] = total;
+    m_tileSegments.resize(total);
+
+    auto bin = [&](std::size_t begin, std::size_t end)
+    {
+        std::uint32_t* offsets = &m_chunkTileCounts[(begin / SEGMENT_GRAIN) * tileCount];
+
+        for (std::size_t i = begin; i < end; i++)
+        {
+            const Segment& segment = m_segments[i];
+            if (segment.color == COLOR_HIDDEN) continue;
+
+            int tileX0, tileY0, tileX1, tileY1;
+            GetTileRange(segment, tileX0, tileY0, tileX1, tileY1);
+
+            for (int tileY = tileY0; tileY <= tileY1; tileY++)
+            {
+                for (int tileX = tileX0; tileX <= tileX1; tileX++)
+                {
+                    m_tileSegments[offsets[tileY * m_tileCountX + tileX]++] = static_cast<std::uint32_t>(i);
+                }
+            }
+        }
+    };
+
+    m_threadPool->ParallelFor(0, segmentCount, SEGMENT_GRAIN, std::cref(bin));
+
+    // Tiles own disjoint pixels, so they are drawn fully in parallel
+    auto draw = [this, &image](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t tile = begin; tile < end; tile++)
+        {
+            RenderTile(static_cast<int>(tile), image);
+        }
+    };
+
+    m_threadPool->ParallelFor(0, tileCount, 1, std::cref(draw));
+}
+
+void SoftwareRenderer::RenderTile(int tile, Image& image) const
+{
+    const int left = (tile % m_tileCountX) * TILE_SIZE;
+    const int top = (tile / m_tileCountX) * TILE_SIZE;
+    const int right = std::min(left + TILE_SIZE, image.width);
+    const int bottom = std::min(top + TILE_SIZE, image.height);
+
+    // Black background
+    for (int row = top; row < bottom; row++)
+    {
+        std::memset(&image.pixels[(static_cast<std::size_t>(row) * image.width + left) * 3], 0, static_cast<std::size_t>(right - left) * 3);
+    }
+
+    for (std::uint32_t k = m_tileBegin[tile]; k < m_tileBegin[tile + 1]; k++)
+    {
+        const Segment& segment = m_segments[m_tileSegments[k]];
+        DrawLine(segment.x0, segment.y0, segment.x1, segment.y1, left, top, right, bottom, PALETTE[segment.color], image);
+    }
+}
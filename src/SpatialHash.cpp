@@ -0,0 +1,187 @@
+#include "SpatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/// @brief Particles each thread checks per chunk of a parallel update.
+static constexpr std::size_t UPDATE_GRAIN = 8192;
+
+std::uint32_t SpatialHash::BucketOfCell(std::int32_t cellX, std::int32_t cellY) const
+{
+    // Mix the integer cell coordinates with two large primes
+    std::uint32_t hash = static_cast<std::uint32_t>(cellX) * 73856093u ^ static_cast<std::uint32_t>(cellY) * 19349663u;
+    return hash & m_mask;
+}
+
+/**
+ * @brief Rounds down to an integer like casting std::floor, without its range checks and float round trip.
+ *
+ * BucketOf runs for every awake particle each step, where this is a third faster.
+ */
+static std::int32_t FloorToCell(float value)
+{
+    std::int32_t truncated = static_cast<std::int32_t>(value);
+    return truncated - (static_cast<float>(truncated) > value ? 1 : 0);
+}
+
+std::uint32_t SpatialHash::BucketOf(float x, float y) const
+{
+    return BucketOfCell(FloorToCell(x * m_inverseCellSize), FloorToCell(y * m_inverseCellSize));
+}
+
+void SpatialHash::Insert(std::uint32_t particle, std::uint32_t bucket)
+{
+    m_bucketOf[particle] = bucket;
+    m_slotOf[particle] = static_cast<std::uint32_t>(m_buckets[bucket].size());
+    m_buckets[bucket].push_back(particle);
+}
+
+void SpatialHash::Remove(std::uint32_t particle)
+{
+    std::vector<std::uint32_t>& bucket = m_buckets[m_bucketOf[particle]];
+    std::uint32_t slot = m_slotOf[particle];
+
+    // Move the last entry into the hole
+    std::uint32_t moved = bucket.back();
+    bucket[slot] = moved;
+    m_slotOf[moved] = slot;
+    bucket.pop_back();
+
+    m_bucketOf[particle] = NOT_STORED;
+}
+
+void SpatialHash::Reset(float cellSize, std::size_t particleCount)
+{
+    m_inverseCellSize = 1.f / cellSize;
+
+    // At least as many buckets as particles keeps collisions rare
+    std::size_t bucketCount = 64;
+    while (bucketCount < particleCount) { bucketCount *= 2; }
+    m_mask = static_cast<std::uint32_t>(bucketCount - 1);
+
+    // Keep the buckets' storage so resetting a cloth of the same size allocates nothing
+    m_buckets.resize(bucketCount);
+    m_bucketOf.resize(particleCount);
+    m_slotOf.resize(particleCount);
+    m_nextBucketOf.resize(particleCount);
+    Clear();
+}
+
+void SpatialHash::Clear()
+{
+    for (std::vector<std::uint32_t>& bucket : m_buckets)
+    {
+        bucket.clear();
+    }
+
+    std::fill(m_bucketOf.begin(), m_bucketOf.end(), NOT_STORED);
+    std::fill(m_slotOf.begin(), m_slotOf.end(), 0);
+}
+
+void SpatialHash::Update(const ParticleBuffer& particles)
+{
+    Update(particles, 0, static_cast<std::uint32_t>(particles.Size()));
+}
+
+void SpatialHash::Update(const ParticleBuffer& particles, std::uint32_t begin, std::uint32_t end)
+{
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+
+    for (std::uint32_t i = begin; i < end; i++)
+    {
+        std::uint32_t bucket = particles.IsActive(i) ? BucketOf(x[i], y[i]) : NOT_STORED;
+
+        // Most particles stay in their cell from one step to the next
+        if (bucket == m_bucketOf[i]) { continue; }
+
+        if (m_bucketOf[i] != NOT_STORED) { Remove(i); }
+        if (bucket != NOT_STORED) { Insert(i, bucket); }
+    }
+}
+
+void SpatialHash::Update(const ParticleBuffer& particles, std::uint32_t begin, std::uint32_t end, ThreadPool& threadPool)
+{
+    if (begin >= end) { return; }
+
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    const std::size_t chunkCount = (end - begin + UPDATE_GRAIN - 1) / UPDATE_GRAIN;
+    m_chunkMoves.assign(chunkCount, 0);
+
+    const std::uint32_t* bucketOf = m_bucketOf.data();
+    std::uint32_t* nextBucketOf = m_nextBucketOf.data();
+    std::uint32_t* chunkMoves = m_chunkMoves.data();
+
+    // Reading the positions is the expensive part, and touches nothing shared
+    auto scan = [=](std::size_t chunkBegin, std::size_t chunkEnd)
+    {
+        std::uint32_t moves = 0;
+        for (std::size_t i = chunkBegin; i < chunkEnd; i++)
+        {
+            nextBucketOf[i] = (flags[i] & PARTICLE_ACTIVE) ? BucketOf(x[i], y[i]) : NOT_STORED;
+            moves += nextBucketOf[i] != bucketOf[i] ? 1 : 0;
+        }
+        chunkMoves[(chunkBegin - begin) / UPDATE_GRAIN] = moves;
+    };
+
+    threadPool.ParallelFor(begin, end, UPDATE_GRAIN, std::cref(scan));
+
+    // Relinking edits shared buckets, so it stays serial, skipping chunks where nothing changed cell
+    for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        if (m_chunkMoves[chunk] == 0) { continue; }
+
+        const std::uint32_t chunkBegin = begin + static_cast<std::uint32_t>(chunk * UPDATE_GRAIN);
+        const std::uint32_t chunkEnd = std::min(end, static_cast<std::uint32_t>(chunkBegin + UPDATE_GRAIN));
+        for (std::uint32_t i = chunkBegin; i < chunkEnd; i++)
+        {
+            if (m_nextBucketOf[i] == m_bucketOf[i]) { continue; }
+
+            if (m_bucketOf[i] != NOT_STORED) { Remove(i); }
+            if (m_nextBucketOf[i] != NOT_STORED) { Insert(i, m_nextBucketOf[i]); }
+        }
+    }
+}
+
+void SpatialHash::Query(const ParticleBuffer& particles, float x, float y, float radius, std::vector<std::uint32_t>& result)
+{
+    result.clear();
+    m_visited.clear();
+
+    const float* px = particles.GetX();
+    const float* py = particles.GetY();
+    const float radiusSquared = radius * radius;
+
+    // Cells overlapped by the circle's bounding box
+    std::int32_t minX = static_cast<std::int32_t>(std::floor((x - radius) * m_inverseCellSize));
+    std::int32_t maxX = static_cast<std::int32_t>(std::floor((x + radius) * m_inverseCellSize));
+    std::int32_t minY = static_cast<std::int32_t>(std::floor((y - radius) * m_inverseCellSize));
+    std::int32_t maxY = static_cast<std::int32_t>(std::floor((y + radius) * m_inverseCellSize));
+
+    for (std::int32_t cellY = minY; cellY <= maxY; cellY++)
+    {
+        for (std::int32_t cellX = minX; cellX <= maxX; cellX++)
+        {
+            std::uint32_t bucket = BucketOfCell(cellX, cellY);
+
+            // Two cells may hash to the same bucket; scan it only once
+            if (std::find(m_visited.begin(), m_visited.end(), bucket) != m_visited.end()) { continue; }
+            m_visited.push_back(bucket);
+
+            // Buckets can also hold particles from far-away cells, so always test the distance
+            for (std::uint32_t i : m_buckets[bucket])
+            {
+                float dx = px[i] - x;
+                float dy = py[i] - y;
+                if (dx * dx + dy * dy < radiusSquared)
+                {
+                    result.push_back(i);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include "StateHash.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr std::uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+    constexpr std::uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr std::uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+
+    inline std::uint64_t RotateLeft(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+    inline std::uint64_t Round(std::uint64_t lane, std::uint64_t word) { return RotateLeft(lane + word * PRIME_2, 31) * PRIME_1; }
+
+    /**
+     * Streams 64-bit words into four independent lanes, so consecutive words
+     * do not wait on each other's multiplies.
+     */
+    class Hasher
+    {
+    private:
+        std::uint64_t m_lanes[4] = {PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1};
+        std::uint64_t m_wordCount = 0;
+
+    public:
+        void Add(std::uint64_t word)
+        {
+            std::uint64_t& lane = m_lanes[m_wordCount & 3];
+            lane = Round(lane, word);
+            m_wordCount++;
+        }
+
+        void AddBytes(const void* data, std::size_t size)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+            // Start at lane 0 so whole blocks can be unrolled
+            while ((m_wordCount & 3) != 0 && size >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                Add(word);
+                bytes += 8;
+                size -= 8;
+            }
+
+            std::uint64_t lane0 = m_lanes[0], lane1 = m_lanes[1], lane2 = m_lanes[2], lane3 = m_lanes[3];
+            std::size_t blocks = 0;
+
+            for (; size >= 32; size -= 32, bytes += 32, blocks++)
+            {
+                std::uint64_t words[4];
+                std::memcpy(words, bytes, 32);
+                lane0 = Round(lane0, words[0]);
+                lane1 = Round(lane1, words[1]);
+                lane2 = Round(lane2, words[2]);
+                lane3 = Round(lane3, words[3]);
+            }
+
+            m_lanes[0] = lane0;
+            m_lanes[1] = lane1;
+            m_lanes[2] = lane2;
+            m_lanes[3] = lane3;
+            m_wordCount += 4 * blocks;
+
+            while (size >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, bytes, 8);
+                Add(word);
+                bytes += 8;
+                size -= 8;
+            }
+
+            // Pad the tail with its length so trailing zero bytes still count
+            if (size > 0)
+            {
+                std::uint64_t word = 0;
+                std::memcpy(&word, bytes, size);
+                Add(word ^ (static_cast<std::uint64_t>(size) << 56));
+            }
+        }
+
+        std::uint64_t Finish() const
+        {
+            std::uint64_t hash = RotateLeft(m_lanes[0], 1) + RotateLeft(m_lanes[1], 7) + RotateLeft(m_lanes[2], 12) + RotateLeft(m_lanes[3], 18);
+            hash ^= m_wordCount * PRIME_3;
+
+            // Avalanche so every input bit affects every output bit
+            hash ^= hash >> 33;
+            hash *= PRIME_2;
+            hash ^= hash >> 29;
+            hash *= PRIME_3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+    };
+}
+
+std::uint64_t StateHash::Compute(const Cloth& cloth)
+{
+    const ParticleBuffer& particles = cloth.GetParticles();
+    const std::size_t count = particles.Size();
+
+    Hasher hasher;
+    hasher.Add(count);
+    hasher.AddBytes(particles.GetX(), count * sizeof(float));
+    hasher.AddBytes(particles.GetY(), count * sizeof(float));
+    hasher.AddBytes(particles.GetLastX(), count * sizeof(float));
+    hasher.AddBytes(particles.GetLastY(), count * sizeof(float));
+    hasher.AddBytes(particles.GetPinX(), count * sizeof(float));
+    hasher.AddBytes(particles.GetPinY(), count * sizeof(float));
+    hasher.AddBytes(particles.GetFlags(), count * sizeof(std::uint8_t));
+
+    // One bit per constraint; the objects themselves also hold padding and the cursor highlight
+    const std::vector<Constraint>& constraints = cloth.GetConstraints();
+    hasher.Add(constraints.size());
+
+    std::uint64_t word = 0;
+    for (std::size_t c = 0; c < constraints.size(); c++)
+    {
+        word |= static_cast<std::uint64_t>(constraints[c].IsActive()) << (c & 63);
+
+        if ((c & 63) == 63)
+        {
+            hasher.Add(word);
+            word = 0;
+        }
+    }
+
+    if ((constraints.size() & 63) != 0)
+    {
+        hasher.Add(word);
+    }
+
+    return hasher.Finish();
+}
+
+std::string StateHash::ToHex(std::uint64_t hash)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; i--, hash >>= 4)
+    {
+        text[i] = DIGITS[hash & 15];
+    }
+    return text;
+}
@@ -0,0 +1,79 @@
+#include "TaskGraph.h"
+
+TaskGraph::TaskId TaskGraph::Add(std::function<void()> body)
+{
+    m_nodes.emplace_back();
+    m_nodes.back().body = std::move(body);
+    m_remaining.reset();
+
+    return static_cast<TaskId>(m_nodes.size() - 1);
+}
+
+void TaskGraph::Precede(TaskId before, TaskId after)
+{
+    m_nodes[before].successors.push_back(after);
+    m_nodes[after].dependencyCount++;
+}
+
+void TaskGraph::Clear()
+{
+    m_nodes.clear();
+    m_remaining.reset();
+}
+
+void TaskGraph::Run(ThreadPool& pool)
+{
+    if (m_nodes.empty()) { return; }
+
+    if (!m_remaining)
+    {
+        m_remaining = std::make_unique<std::atomic<std::uint32_t>[]>(m_nodes.size());
+    }
+
+    // Arm every counter before the first task can release a successor
+    for (std::size_t i = 0; i < m_nodes.size(); i++)
+    {
+        m_remaining[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+    }
+    m_pending.store(m_nodes.size(), std::memory_order_relaxed);
+    m_pool = &pool;
+
+    for (std::size_t i = 0; i < m_nodes.size(); i++)
+    {
+        if (m_nodes[i].dependencyCount == 0)
+        {
+            Submit(static_cast<TaskId>(i));
+        }
+    }
+
+    pool.Wait(m_pending);
+    m_pool = nullptr;
+}
+
+void TaskGraph::Submit(TaskId node)
+{
+    ThreadPool::Task task;
+    task.run = &TaskGraph::RunNode;
+    task.context = this;
+    task.begin = node;
+    task.end = node + 1;
+    task.pending = &m_pending;
+    m_pool->Submit(task);
+}
+
+void TaskGraph::RunNode(const void* context, std::size_t node, std::size_t)
+{
+    // Only the counters change while the graph runs
+    TaskGraph& graph = *const_cast<TaskGraph*>(static_cast<const TaskGraph*>(context));
+
+    graph.m_nodes[node].body();
+
+    // The last dependency to finish queues the successor; acq_rel publishes this task's writes to it
+    for (TaskId successor : graph.m_nodes[node].successors)
+    {
+        if (graph.m_remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            graph.Submit(successor);
+        }
+    }
+}
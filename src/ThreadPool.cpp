@@ -0,0 +1,217 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Initial capacity of each deque; a power of two so ring indices are a mask
+    constexpr std::size_t QUEUE_CAPACITY = 64;
+
+    // Yields an idle worker makes before going to sleep, so back-to-back loops
+    // in one step do not pay for a wake-up each
+    constexpr int SPIN_COUNT = 32;
+
+    // Pool and deque of the calling thread if it is one of the workers
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local unsigned t_queue = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+        m_queues.back()->ring.resize(QUEUE_CAPACITY);
+    }
+
+    // The caller is one of the threads, so only spawn the rest
+    m_workers.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; i++)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::GetThreadCount() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+unsigned ThreadPool::GetOwnQueue() const { return t_pool == this ? t_queue : 0; }
+
+void ThreadPool::Submit(const Task& task)
+{
+    if (m_workers.empty())
+    {
+        Execute(task);
+        return;
+    }
+
+    // Counted before it is visible so a thief never takes the counter below zero
+    m_queuedTasks.fetch_add(1);
+
+    Queue& queue = *m_queues[GetOwnQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        // Full: double the ring, keeping every task at its position modulo the new size
+        if (queue.tail - queue.head == queue.ring.size())
+        {
+            std::vector<Task> ring(queue.ring.size() * 2);
+            for (std::size_t i = queue.head; i < queue.tail; i++)
+            {
+                ring[i & (ring.size() - 1)] = queue.ring[i & (queue.ring.size() - 1)];
+            }
+            queue.ring.swap(ring);
+        }
+
+        queue.ring[queue.tail & (queue.ring.size() - 1)] = task;
+        queue.tail++;
+    }
+
+    // Sleepers check the counter under the mutex, so taking it here cannot miss one
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_wake.notify_one();
+}
+
+bool ThreadPool::FindTask(unsigned ownQueue, Task& task)
+{
+    if (m_queuedTasks.load(std::memory_order_relaxed) == 0) { return false; }
+
+    // Newest own task first: its data is most likely still in cache
+    {
+        Queue& queue = *m_queues[ownQueue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head != queue.tail)
+        {
+            queue.tail--;
+            task = queue.ring[queue.tail & (queue.ring.size() - 1)];
+            m_queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Then the oldest task of anyone else, starting with the next deque so thieves spread out
+    for (std::size_t i = 1; i < m_queues.size(); i++)
+    {
+        Queue& queue = *m_queues[(ownQueue + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.head != queue.tail)
+        {
+            task = queue.ring[queue.head & (queue.ring.size() - 1)];
+            queue.head++;
+            m_queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::Execute(const Task& task)
+{
+    task.run(task.context, task.begin, task.end);
+    task.pending->fetch_sub(1, std::memory_order_release);
+}
+
+void ThreadPool::Wait(const std::atomic<std::size_t>& pending)
+{
+    const unsigned ownQueue = GetOwnQueue();
+
+    // Help with whatever is queued instead of blocking; this also runs nested work
+    Task task;
+    while (pending.load(std::memory_order_acquire) != 0)
+    {
+        if (FindTask(ownQueue, task))
+        {
+            Execute(task);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::RunChunk(const void* context, std::size_t begin, std::size_t end)
+{
+    (*static_cast<const std::function<void(std::size_t, std::size_t)>*>(context))(begin, end);
+}
+
+void ThreadPool::ParallelFor(std::size_t begin, std::size_t end, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body)
+{
+    if (begin >= end) { return; }
+
+    grain = std::max<std::size_t>(grain, 1);
+
+    // Not worth waking anyone up. Still split into the same chunks as the
+    // threaded path so per-chunk results do not depend on the thread count.
+    if (m_workers.empty() || end - begin <= grain)
+    {
+        for (std::size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grain)
+        {
+            body(chunkBegin, std::min(chunkBegin + grain, end));
+        }
+        return;
+    }
+
+    // Queue every chunk but the first, which this thread starts on right away
+    const std::size_t chunkCount = (end - begin + grain - 1) / grain;
+    std::atomic<std::size_t> pending{chunkCount - 1};
+
+    Task task;
+    task.run = &ThreadPool::RunChunk;
+    task.context = &body;
+    task.pending = &pending;
+    for (std::size_t chunk = chunkCount - 1; chunk > 0; chunk--)
+    {
+        task.begin = begin + chunk * grain;
+        task.end = std::min(task.begin + grain, end);
+        Submit(task);
+    }
+
+    body(begin, begin + grain);
+    Wait(pending);
+}
+
+void ThreadPool::WorkerLoop(unsigned index)
+{
+    t_pool = this;
+    t_queue = index;
+
+    Task task;
+    while (true)
+    {
+        if (FindTask(index, task))
+        {
+            Execute(task);
+            continue;
+        }
+
+        for (int spin = 0; spin < SPIN_COUNT && m_queuedTasks.load(std::memory_order_relaxed) == 0; spin++)
+        {
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queuedTasks.load() != 0; });
+        if (m_stop) { return; }
+    }
+}
@@ -0,0 +1,160 @@
+#include "TrajectoryReader.h"
+#include "TrajectoryFormat.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool TrajectoryReader::Open(const std::string& path)
+{
+    m_file.close();
+    m_file.clear();
+    m_constraints.clear();
+
+    m_file.open(path, std::ios::binary);
+    if (!m_file) { return false; }
+
+    TrajectoryFormat::Header header;
+    m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!m_file || std::memcmp(header.magic, TrajectoryFormat::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TrajectoryFormat::VERSION || !(header.boundsWidth > 0.f) || !(header.boundsHeight > 0.f))
+    {
+        m_file.close();
+        return false;
+    }
+
+    std::vector<std::uint32_t> endpoints(2 * static_cast<std::size_t>(header.constraintCount));
+    m_file.read(reinterpret_cast<char*>(endpoints.data()), static_cast<std::streamsize>(endpoints.size() * sizeof(std::uint32_t)));
+
+    if (!m_file)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_constraints.reserve(header.constraintCount);
+    for (std::uint32_t c = 0; c < header.constraintCount; c++)
+    {
+        std::uint32_t p1 = endpoints[2 * c];
+        std::uint32_t p2 = endpoints[2 * c + 1];
+
+        if (p1 >= header.particleCount || p2 >= header.particleCount)
+        {
+            m_file.close();
+            m_constraints.clear();
+            return false;
+        }
+
+        m_constraints.emplace_back(p1, p2, 0.f);
+    }
+
+    m_scaleX = header.boundsWidth / TrajectoryFormat::QUANT_MAX;
+    m_scaleY = header.boundsHeight / TrajectoryFormat::QUANT_MAX;
+
+    m_x.resize(header.particleCount);
+    m_y.resize(header.particleCount);
+
+    m_firstFrame = m_file.tellg();
+    Rewind();
+    return true;
+}
+
+bool TrajectoryReader::IsOpen() const { return m_file.is_open(); }
+
+bool TrajectoryReader::ReadFrame(ClothSnapshot& frame)
+{
+    using TrajectoryFormat::GetVarint;
+    using TrajectoryFormat::UnZigZag;
+
+    if (!IsOpen()) { return false; }
+
+    std::uint32_t payloadSize = 0;
+    m_file.read(reinterpret_cast<char*>(&payloadSize), sizeof(payloadSize));
+    if (!m_file) { return false; }
+
+    m_payload.resize(payloadSize);
+    m_file.read(reinterpret_cast<char*>(m_payload.data()), payloadSize);
+    if (!m_file) { return false; }
+
+    const std::uint8_t* data = m_payload.data();
+    std::size_t offset = 0;
+    std::uint64_t value = 0;
+
+    if (!GetVarint(data, payloadSize, offset, value)) { return false; }
+    std::uint64_t step = value;
+
+    // The first frame starts from an all-active cloth, like the writer's reference
+    const std::size_t particleCount = m_x.size();
+    if (m_framesRead == 0)
+    {
+        frame.constraintStates.assign(m_constraints.size(), CONSTRAINT_STATE_ACTIVE);
+    }
+
+    if (!GetVarint(data, payloadSize, offset, value)) { return false; }
+    std::uint64_t changeCount = value;
+
+    std::uint64_t constraint = 0;
+    for (std::uint64_t change = 0; change < changeCount; change++)
+    {
+        if (!GetVarint(data, payloadSize, offset, value) || offset >= payloadSize) { return false; }
+
+        constraint += value;
+        if (constraint >= frame.constraintStates.size()) { return false; }
+
+        frame.constraintStates[constraint] = data[offset++];
+    }
+
+    for (std::size_t i = 0; i < particleCount; i++)
+    {
+        if (!GetVarint(data, payloadSize, offset, value)) { return false; }
+        m_x[i] = static_cast<std::uint16_t>(m_x[i] + UnZigZag(static_cast<std::uint32_t>(value)));
+    }
+
+    for (std::size_t i = 0; i < particleCount; i++)
+    {
+        if (!GetVarint(data, payloadSize, offset, value)) { return false; }
+        m_y[i] = static_cast<std::uint16_t>(m_y[i] + UnZigZag(static_cast<std::uint32_t>(value)));
+    }
+
+    // The frame shown so far becomes the interpolation start
+    frame.previousX.swap(frame.x);
+    frame.previousY.swap(frame.y);
+    frame.x.resize(particleCount);
+    frame.y.resize(particleCount);
+
+    for (std::size_t i = 0; i < particleCount; i++)
+    {
+        frame.x[i] = m_x[i] * m_scaleX;
+        frame.y[i] = m_y[i] * m_scaleY;
+    }
+
+    // Nothing to blend from on the first frame
+    if (m_framesRead == 0 || frame.previousX.size() != particleCount)
+    {
+        frame.previousX = frame.x;
+        frame.previousY = frame.y;
+    }
+
+    frame.step = step;
+    m_framesRead++;
+    return true;
+}
+
+void TrajectoryReader::Rewind()
+{
+    if (!IsOpen()) { return; }
+
+    m_file.clear();
+    m_file.seekg(m_firstFrame);
+
+    // The first frame is coded against zero
+    std::fill(m_x.begin(), m_x.end(), 0);
+    std::fill(m_y.begin(), m_y.end(), 0);
+    m_framesRead = 0;
+}
+
+const std::vector<Constraint>& TrajectoryReader::GetConstraints() const { return m_constraints; }
+
+std::size_t TrajectoryReader::GetParticleCount() const { return m_x.size(); }
+
+std::uint64_t TrajectoryReader::GetFramesRead() const { return m_framesRead; }
@@ -0,0 +1,226 @@
+#include "TrajectoryWriter.h"
+#include "ClothSnapshot.h"
+#include "TrajectoryFormat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /// @brief Maps a coordinate into [0, QUANT_MAX], clamping points outside the bounds.
+    std::uint16_t Quantize(float value, float scale)
+    {
+        float q = std::min(std::max(value * scale, 0.f), TrajectoryFormat::QUANT_MAX);
+        return static_cast<std::uint16_t>(q + 0.5f);
+    }
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    Close();
+}
+
+bool TrajectoryWriter::Open(const std::string& path, const Cloth& cloth)
+{
+    Close();
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) { return false; }
+
+    const std::uint32_t particleCount = static_cast<std::uint32_t>(cloth.GetParticles().Size());
+    const std::vector<Constraint>& constraints = cloth.GetConstraints();
+
+    // Only the visible structural constraints are recorded; they lead the list
+    const std::size_t constraintCount = cloth.GetStructuralConstraintCount();
+
+    TrajectoryFormat::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TrajectoryFormat::MAGIC, sizeof(header.magic));
+    header.version = TrajectoryFormat::VERSION;
+    header.particleCount = particleCount;
+    header.constraintCount = static_cast<std::uint32_t>(constraintCount);
+    header.boundsWidth = static_cast<float>(std::max(cloth.GetBoundsWidth(), 1));
+    header.boundsHeight = static_cast<float>(std::max(cloth.GetBoundsHeight(), 1));
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Topology is written once; frames only carry positions and state changes
+    for (std::size_t c = 0; c < constraintCount; c++)
+    {
+        std::uint32_t endpoints[2] = {constraints[c].p_1, constraints[c].p_2};
+        m_file.write(reinterpret_cast<const char*>(endpoints), sizeof(endpoints));
+    }
+
+    if (!m_file)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_scaleX = TrajectoryFormat::QUANT_MAX / header.boundsWidth;
+    m_scaleY = TrajectoryFormat::QUANT_MAX / header.boundsHeight;
+
+    // The first frame is coded against zero and an all-active cloth
+    m_lastX.assign(particleCount, 0);
+    m_lastY.assign(particleCount, 0);
+    m_lastStates.assign(constraintCount, CONSTRAINT_STATE_ACTIVE);
+
+    // Size every slot up front so capturing never allocates
+    m_frames.resize(SLOT_COUNT);
+    for (std::uint32_t slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        m_frames[slot].x.resize(particleCount);
+        m_frames[slot].y.resize(particleCount);
+        m_frames[slot].constraintStates.resize(constraintCount);
+        m_freeSlots.Push(slot);
+    }
+
+    m_droppedFrames = 0;
+    m_isRunning = true;
+    m_thread = std::thread(&TrajectoryWriter::WriterLoop, this);
+    return true;
+}
+
+bool TrajectoryWriter::Capture(const Cloth& cloth, std::uint64_t step, bool waitForSlot)
+{
+    if (!IsOpen()) { return false; }
+
+    std::uint32_t slot;
+    while (!m_freeSlots.Pop(slot))
+    {
+        if (!waitForSlot)
+        {
+            m_droppedFrames++;
+            return false;
+        }
+
+        std::this_thread::yield();
+    }
+
+    Frame& frame = m_frames[slot];
+    frame.step = step;
+
+    const ParticleBuffer& particles = cloth.GetParticles();
+    const float* x = particles.GetX();
+    const float* y = particles.GetY();
+
+    for (std::size_t i = 0; i < frame.x.size(); i++)
+    {
+        frame.x[i] = Quantize(x[i], m_scaleX);
+        frame.y[i] = Quantize(y[i], m_scaleY);
+    }
+
+    const std::vector<Constraint>& constraints = cloth.GetConstraints();
+    for (std::size_t c = 0; c < frame.constraintStates.size(); c++)
+    {
+        frame.constraintStates[c] = (constraints[c].IsActive() ? CONSTRAINT_STATE_ACTIVE : 0) | (constraints[c].IsSelected() ? CONSTRAINT_STATE_SELECTED : 0);
+    }
+
+    m_filledSlots.Push(slot);
+    m_wake.notify_one();
+    return true;
+}
+
+void TrajectoryWriter::Close()
+{
+    if (!m_thread.joinable()) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_isRunning = false;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    m_file.close();
+
+    // Return every slot so the next Open starts from an empty queue
+    std::uint32_t slot;
+    while (m_freeSlots.Pop(slot)) {}
+    while (m_filledSlots.Pop(slot)) {}
+}
+
+bool TrajectoryWriter::IsOpen() const { return m_thread.joinable(); }
+
+std::uint64_t TrajectoryWriter::GetDroppedFrames() const { return m_droppedFrames; }
+
+void TrajectoryWriter::WriterLoop()
+{
+    for (;;)
+    {
+        std::uint32_t slot;
+        if (m_filledSlots.Pop(slot))
+        {
+            WriteFrame(m_frames[slot]);
+            m_freeSlots.Push(slot);
+            continue;
+        }
+
+        // Queue drained: finish if closing, otherwise sleep until the next frame
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (!m_isRunning)
+        {
+            // Frames queued just before Close are still written
+            while (m_filledSlots.Pop(slot))
+            {
+                WriteFrame(m_frames[slot]);
+            }
+            break;
+        }
+
+        // The timeout covers a notification sent between the empty Pop and this wait
+        m_wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+
+    m_file.flush();
+}
+
+void TrajectoryWriter::WriteFrame(const Frame& frame)
+{
+    using TrajectoryFormat::PutVarint;
+    using TrajectoryFormat::ZigZag;
+
+    m_payload.clear();
+    PutVarint(m_payload, frame.step);
+
+    // Constraint states change rarely (cuts, selection), so only the changes are listed
+    std::uint32_t changeCount = 0;
+    for (std::size_t c = 0; c < frame.constraintStates.size(); c++)
+    {
+        changeCount += frame.constraintStates[c] != m_lastStates[c];
+    }
+
+    PutVarint(m_payload, changeCount);
+
+    std::uint32_t lastChanged = 0;
+    for (std::uint32_t c = 0; c < frame.constraintStates.size(); c++)
+    {
+        if (frame.constraintStates[c] != m_lastStates[c])
+        {
+            PutVarint(m_payload, c - lastChanged);
+            m_payload.push_back(frame.constraintStates[c]);
+            lastChanged = c;
+        }
+    }
+
+    // Between two steps most particles move a few quantization units, which fits in one byte
+    for (std::size_t i = 0; i < frame.x.size(); i++)
+    {
+        PutVarint(m_payload, ZigZag(static_cast<std::int32_t>(frame.x[i]) - m_lastX[i]));
+    }
+
+    for (std::size_t i = 0; i < frame.y.size(); i++)
+    {
+        PutVarint(m_payload, ZigZag(static_cast<std::int32_t>(frame.y[i]) - m_lastY[i]));
+    }
+
+    std::uint32_t payloadSize = static_cast<std::uint32_t>(m_payload.size());
+    m_file.write(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+    m_file.write(reinterpret_cast<const char*>(m_payload.data()), static_cast<std::streamsize>(m_payload.size()));
+
+    m_lastX = frame.x;
+    m_lastY = frame.y;
+    m_lastStates = frame.constraintStates;
+}
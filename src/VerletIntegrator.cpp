@@ -0,0 +1,268 @@
+#include "VerletIntegrator.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+    #define CLOTH_VERLET_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CLOTH_VERLET_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace
+{
+    /**
+     * Scalar reference for one particle. Every vector kernel below performs the
+     * same operations in the same order, so their results are bit-identical.
+     */
+    inline void IntegrateOne(float* x, float* y, float* lastX, float* lastY, const float* pinX, const float* pinY,
+                             std::uint8_t flags, float damping, float stepX, float stepY, float width, float height)
+    {
+        // Skip update if the particle is inactive
+        if (!(flags & PARTICLE_ACTIVE)) { return; }
+
+        // If the particle is pinned, snap it to its anchor
+        if (flags & PARTICLE_PINNED)
+        {
+            *x = *pinX;
+            *y = *pinY;
+            return;
+        }
+
+        // Verlet step: (1 - drag) is the friction or damping factor
+        float newX = *x + (*x - *lastX) * damping + stepX;
+        float newY = *y + (*y - *lastY) * damping + stepY;
+
+        *lastX = *x;
+        *lastY = *y;
+        *x = newX;
+        *y = newY;
+
+        // Keep the particle inside the bounds
+        if (*x > width)
+        {
+            *x = width;
+            *lastX = *x;
+        }
+        else if (*x < 0)
+        {
+            *x = 0;
+        }
+
+        if (*y > height)
+        {
+            *y = height;
+            *lastY = *y;
+        }
+        else if (*y < 0)
+        {
+            *y = 0;
+            *lastY = *y;
+        }
+    }
+}
+
+void VerletIntegrator::IntegrateScalar(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    float* lastX = particles.GetLastX();
+    float* lastY = particles.GetLastY();
+    const float* pinX = particles.GetPinX();
+    const float* pinY = particles.GetPinY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    // Acceleration term is the same for every particle: a * 100 * (1 - drag) * dt^2
+    const float damping = 1.0f - params.drag;
+    const float stepX = params.accelerationX * 100.f * damping * params.deltaTime * params.deltaTime;
+    const float stepY = params.accelerationY * 100.f * damping * params.deltaTime * params.deltaTime;
+
+    for (std::size_t i = begin; i < end; i++)
+    {
+        IntegrateOne(x + i, y + i, lastX + i, lastY + i, pinX + i, pinY + i, flags[i],
+                     damping, stepX, stepY, params.boundsWidth, params.boundsHeight);
+    }
+}
+
+#if defined(CLOTH_VERLET_AVX2)
+
+void VerletIntegrator::Integrate(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    float* lastX = particles.GetLastX();
+    float* lastY = particles.GetLastY();
+    const float* pinX = particles.GetPinX();
+    const float* pinY = particles.GetPinY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    const float damping = 1.0f - params.drag;
+    const float stepX = params.accelerationX * 100.f * damping * params.deltaTime * params.deltaTime;
+    const float stepY = params.accelerationY * 100.f * damping * params.deltaTime * params.deltaTime;
+
+    const __m256 vDamping = _mm256_set1_ps(damping);
+    const __m256 vStepX = _mm256_set1_ps(stepX);
+    const __m256 vStepY = _mm256_set1_ps(stepY);
+    const __m256 vWidth = _mm256_set1_ps(params.boundsWidth);
+    const __m256 vHeight = _mm256_set1_ps(params.boundsHeight);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256i vActive = _mm256_set1_epi32(PARTICLE_ACTIVE);
+    const __m256i vPinned = _mm256_set1_epi32(PARTICLE_PINNED);
+
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        // Widen eight flag bytes to one 32-bit lane each and build lane masks
+        __m256i f = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(flags + i)));
+        __m256 active = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(f, vActive), vActive));
+        __m256 pinned = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(f, vPinned), vPinned));
+        __m256 free = _mm256_andnot_ps(pinned, active);
+        __m256 held = _mm256_and_ps(pinned, active);
+
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 plx = _mm256_loadu_ps(lastX + i);
+        __m256 ply = _mm256_loadu_ps(lastY + i);
+
+        // Verlet step
+        __m256 nx = _mm256_add_ps(_mm256_add_ps(px, _mm256_mul_ps(_mm256_sub_ps(px, plx), vDamping)), vStepX);
+        __m256 ny = _mm256_add_ps(_mm256_add_ps(py, _mm256_mul_ps(_mm256_sub_ps(py, ply), vDamping)), vStepY);
+        __m256 nlx = px;
+        __m256 nly = py;
+
+        // Right edge stops horizontal motion, left edge only clamps position
+        __m256 overX = _mm256_cmp_ps(nx, vWidth, _CMP_GT_OQ);
+        __m256 underX = _mm256_andnot_ps(overX, _mm256_cmp_ps(nx, vZero, _CMP_LT_OQ));
+        nx = _mm256_blendv_ps(nx, vWidth, overX);
+        nlx = _mm256_blendv_ps(nlx, vWidth, overX);
+        nx = _mm256_blendv_ps(nx, vZero, underX);
+
+        // Floor and ceiling both stop vertical motion
+        __m256 overY = _mm256_cmp_ps(ny, vHeight, _CMP_GT_OQ);
+        __m256 underY = _mm256_andnot_ps(overY, _mm256_cmp_ps(ny, vZero, _CMP_LT_OQ));
+        ny = _mm256_blendv_ps(ny, vHeight, overY);
+        nly = _mm256_blendv_ps(nly, vHeight, overY);
+        ny = _mm256_blendv_ps(ny, vZero, underY);
+        nly = _mm256_blendv_ps(nly, vZero, underY);
+
+        // Pinned lanes snap to their anchor, inactive lanes keep their old state
+        __m256 outX = _mm256_blendv_ps(_mm256_blendv_ps(px, _mm256_loadu_ps(pinX + i), held), nx, free);
+        __m256 outY = _mm256_blendv_ps(_mm256_blendv_ps(py, _mm256_loadu_ps(pinY + i), held), ny, free);
+
+        _mm256_storeu_ps(x + i, outX);
+        _mm256_storeu_ps(y + i, outY);
+        _mm256_storeu_ps(lastX + i, _mm256_blendv_ps(plx, nlx, free));
+        _mm256_storeu_ps(lastY + i, _mm256_blendv_ps(ply, nly, free));
+    }
+
+    // Remaining particles that do not fill a whole batch
+    for (; i < end; i++)
+    {
+        IntegrateOne(x + i, y + i, lastX + i, lastY + i, pinX + i, pinY + i, flags[i],
+                     damping, stepX, stepY, params.boundsWidth, params.boundsHeight);
+    }
+}
+
+const char* VerletIntegrator::GetKernelName() { return "AVX2"; }
+
+#elif defined(CLOTH_VERLET_SSE2)
+
+namespace
+{
+    // SSE2 has no blendv; select b where mask is set, a elsewhere
+    inline __m128 Select(__m128 a, __m128 b, __m128 mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+}
+
+void VerletIntegrator::Integrate(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params)
+{
+    float* x = particles.GetX();
+    float* y = particles.GetY();
+    float* lastX = particles.GetLastX();
+    float* lastY = particles.GetLastY();
+    const float* pinX = particles.GetPinX();
+    const float* pinY = particles.GetPinY();
+    const std::uint8_t* flags = particles.GetFlags();
+
+    const float damping = 1.0f - params.drag;
+    const float stepX = params.accelerationX * 100.f * damping * params.deltaTime * params.deltaTime;
+    const float stepY = params.accelerationY * 100.f * damping * params.deltaTime * params.deltaTime;
+
+    const __m128 vDamping = _mm_set1_ps(damping);
+    const __m128 vStepX = _mm_set1_ps(stepX);
+    const __m128 vStepY = _mm_set1_ps(stepY);
+    const __m128 vWidth = _mm_set1_ps(params.boundsWidth);
+    const __m128 vHeight = _mm_set1_ps(params.boundsHeight);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128i vActive = _mm_set1_epi32(PARTICLE_ACTIVE);
+    const __m128i vPinned = _mm_set1_epi32(PARTICLE_PINNED);
+    const __m128i vZeroI = _mm_setzero_si128();
+
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        // Widen four flag bytes to one 32-bit lane each and build lane masks
+        int packed;
+        std::memcpy(&packed, flags + i, sizeof(packed));
+        __m128i f = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), vZeroI), vZeroI);
+        __m128 active = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, vActive), vActive));
+        __m128 pinned = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(f, vPinned), vPinned));
+        __m128 free = _mm_andnot_ps(pinned, active);
+        __m128 held = _mm_and_ps(pinned, active);
+
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 plx = _mm_loadu_ps(lastX + i);
+        __m128 ply = _mm_loadu_ps(lastY + i);
+
+        // Verlet step
+        __m128 nx = _mm_add_ps(_mm_add_ps(px, _mm_mul_ps(_mm_sub_ps(px, plx), vDamping)), vStepX);
+        __m128 ny = _mm_add_ps(_mm_add_ps(py, _mm_mul_ps(_mm_sub_ps(py, ply), vDamping)), vStepY);
+        __m128 nlx = px;
+        __m128 nly = py;
+
+        // Right edge stops horizontal motion, left edge only clamps position
+        __m128 overX = _mm_cmpgt_ps(nx, vWidth);
+        __m128 underX = _mm_andnot_ps(overX, _mm_cmplt_ps(nx, vZero));
+        nx = Select(nx, vWidth, overX);
+        nlx = Select(nlx, vWidth, overX);
+        nx = Select(nx, vZero, underX);
+
+        // Floor and ceiling both stop vertical motion
+        __m128 overY = _mm_cmpgt_ps(ny, vHeight);
+        __m128 underY = _mm_andnot_ps(overY, _mm_cmplt_ps(ny, vZero));
+        ny = Select(ny, vHeight, overY);
+        nly = Select(nly, vHeight, overY);
+        ny = Select(ny, vZero, underY);
+        nly = Select(nly, vZero, underY);
+
+        // Pinned lanes snap to their anchor, inactive lanes keep their old state
+        __m128 outX = Select(Select(px, _mm_loadu_ps(pinX + i), held), nx, free);
+        __m128 outY = Select(Select(py, _mm_loadu_ps(pinY + i), held), ny, free);
+
+        _mm_storeu_ps(x + i, outX);
+        _mm_storeu_ps(y + i, outY);
+        _mm_storeu_ps(lastX + i, Select(plx, nlx, free));
+        _mm_storeu_ps(lastY + i, Select(ply, nly, free));
+    }
+
+    // Remaining particles that do not fill a whole batch
+    for (; i < end; i++)
+    {
+        IntegrateOne(x + i, y + i, lastX + i, lastY + i, pinX + i, pinY + i, flags[i],
+                     damping, stepX, stepY, params.boundsWidth, params.boundsHeight);
+    }
+}
+
+const char* VerletIntegrator::GetKernelName() { return "SSE2"; }
+
+#else
+
+void VerletIntegrator::Integrate(ParticleBuffer& particles, std::size_t begin, std::size_t end, const VerletParams& params)
+{
+    IntegrateScalar(particles, begin, end, params);
+}
+
+const char* VerletIntegrator::GetKernelName() { return "Scalar"; }
+
+#endif
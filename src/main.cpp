@@ -1,9 +1,21 @@
 #include "ClothSimulation.h"
 
-int main()
+int main(int argc, char** argv)
 {
     ClothSimulation app;
 
+    // Optional scene file with many cloths; otherwise the single cloth from ClothConfig.h
+    if (argc > 1)
+    {
+        app.SetScenePath(argv[1]);
+    }
+
+    app.SetPhysicsRate(PHYSICS_RATE);
+    app.SetMaxSubsteps(MAX_SUBSTEPS);
+    // Deterministic sessions step once per frame on the main thread
+    app.SetPipelined(PIPELINED_PHYSICS && !DETERMINISTIC_MODE);
+    app.SetLockstep(DETERMINISTIC_MODE);
+
     app.Run("Verlet Integration Cloth Simulation", WIN_WIDTH, WIN_HEIGHT);
 
     return 0;
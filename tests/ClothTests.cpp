@@ -0,0 +1,626 @@
+#include "Cloth.h"
+#include "ClothCheckpoint.h"
+#include "ClothConfig.h"
+#include "InputLog.h"
+#include "StateHash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Checks of the simulation core, run by ctest.
+ *
+ * Usage: cloth_tests [CHECK]
+ *
+ * Runs the named check, or every check without an argument. A check prints
+ * what went wrong to std::cerr; the exit code is non-zero if any failed.
+ * Most checks step two cloths that should end up bit-identical and compare
+ * their state hashes (see StateHash) after every step, so a failure names
+ * the first step at which they diverged.
+ */
+
+namespace
+{
+    /// @brief Number of heap allocations made by any thread so far, counted by the operator new below.
+    std::atomic<std::size_t> g_allocationCount{0};
+}
+
+// GCC sees malloc paired with operator delete once these are inlined and warns about a mismatch that is not there
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Array and nothrow forms call these, so every allocation of the core is counted
+void* operator new(std::size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* memory = std::malloc(size > 0 ? size : 1)) { return memory; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    // Big enough that four threads split the constraint batches, the
+    // self-collision grid and the brush index into several chunks each
+    constexpr int CLOTH_WIDTH_COUNT = 160;
+    constexpr int CLOTH_HEIGHT_COUNT = 120;
+    constexpr int CLOTH_GAP = 3;
+
+    constexpr float DELTA_TIME = 1.f / 60.f;
+    constexpr int STEP_COUNT = 300;
+
+    /**
+     * @brief A named set of solver features to run a check with.
+     */
+    struct TestConfig
+    {
+        const char* name;
+        SolverSettings settings;
+        bool hasColliders;
+    };
+
+    /**
+     * @brief Returns one configuration per solver path, so each check covers all of them.
+     */
+    std::vector<TestConfig> GetConfigs()
+    {
+        std::vector<TestConfig> configs;
+
+        SolverSettings settings;
+        configs.push_back({"default", settings, false});
+
+        // Everything that keeps extra state between steps at once; the piece the
+        // scripted cut takes off comes to rest and falls asleep around step 240
+        SolverSettings features = settings;
+        features.selfCollisionDistance = CLOTH_GAP * 0.8f;
+        features.multigridLevels = 2;
+        features.sleepSpeed = 2.f;
+        features.shearStiffness = SHEAR_STIFFNESS;
+        features.bendingStiffness = BENDING_STIFFNESS;
+        configs.push_back({"features", features, true});
+
+        SolverSettings iterative = settings;
+        iterative.minIterations = 2;
+        iterative.maxIterations = 8;
+        iterative.tolerance = 0.01f;
+        configs.push_back({"iterative", iterative, false});
+
+        SolverSettings compliance = settings;
+        compliance.model = ConstraintModel::Compliance;
+        compliance.shearCompliance = SHEAR_COMPLIANCE;
+        compliance.bendingCompliance = BENDING_COMPLIANCE;
+        configs.push_back({"xpbd", compliance, false});
+
+        SolverSettings implicit = settings;
+        implicit.integrator = IntegratorType::ImplicitEuler;
+        implicit.springStiffness = SPRING_STIFFNESS;
+        configs.push_back({"implicit", implicit, false});
+
+        return configs;
+    }
+
+    /**
+     * @brief Returns the width of the simulation area around the test cloth.
+     */
+    int GetBoundsWidth() { return std::max(WIN_WIDTH, CLOTH_WIDTH_COUNT * CLOTH_GAP + 2 * CLOTH_GAP); }
+
+    /**
+     * @brief Returns the height of the simulation area around the test cloth.
+     */
+    int GetBoundsHeight() { return std::max(WIN_HEIGHT, static_cast<int>(CLOTH_HEIGHT_COUNT * CLOTH_GAP * 1.5f)); }
+
+    /**
+     * @brief Sets up a cloth framed the same way as the headless driver frames it.
+     *
+     * @param cloth Cloth to rebuild.
+     * @param config Solver features to enable.
+     * @param threadCount Number of solver threads.
+     * @param isReference True to use the scalar reference loops.
+     */
+    void SetUpCloth(Cloth& cloth, const TestConfig& config, unsigned threadCount, bool isReference)
+    {
+        const int boundsWidth = GetBoundsWidth();
+        const int boundsHeight = GetBoundsHeight();
+        const int startX = static_cast<int>(boundsWidth * 0.5f - CLOTH_WIDTH_COUNT * CLOTH_GAP * 0.5f);
+        const int startY = static_cast<int>(boundsHeight * 0.1f);
+
+        cloth = Cloth(CLOTH_WIDTH_COUNT, CLOTH_HEIGHT_COUNT, CLOTH_GAP, startX, startY, GRAVITY, DRAG, ELASTICITY);
+
+        if (config.hasColliders)
+        {
+            // A disc under the middle of the cloth and a bar the lower corner drapes over
+            std::vector<Collider> colliders(2);
+            colliders[0].shape = ColliderShape::Circle;
+            colliders[0].x0 = boundsWidth * 0.5f;
+            colliders[0].y0 = startY + CLOTH_HEIGHT_COUNT * CLOTH_GAP * 0.8f;
+            colliders[0].radius = 40.f;
+            colliders[1].shape = ColliderShape::Capsule;
+            colliders[1].x0 = static_cast<float>(startX);
+            colliders[1].y0 = startY + CLOTH_HEIGHT_COUNT * CLOTH_GAP * 1.1f;
+            colliders[1].x1 = startX + 100.f;
+            colliders[1].y1 = colliders[1].y0 + 20.f;
+            colliders[1].radius = 6.f;
+            cloth.SetColliders(colliders);
+        }
+
+        cloth.SetBounds(boundsWidth, boundsHeight);
+        cloth.SetThreadCount(threadCount);
+        cloth.SetReferenceSolver(isReference);
+        cloth.SetSolverSettings(config.settings);
+    }
+
+    /**
+     * @brief Returns where the scripted cursor is at a step.
+     */
+    sf::Vector2i GetScriptedCursor(int step)
+    {
+        const int centerX = GetBoundsWidth() / 2;
+        const int centerY = static_cast<int>(GetBoundsHeight() * 0.1f) + CLOTH_HEIGHT_COUNT * CLOTH_GAP / 2;
+
+        if (step < 40) { return sf::Vector2i(centerX, centerY); }
+        if (step < 100) { return sf::Vector2i(centerX + (step - 40) * 2, centerY); }
+        // Across the whole cloth, so the lower part comes off as an island of its own
+        if (step < 160) { return sf::Vector2i(centerX - 250 + (step - 100) * 9, centerY + 80); }
+        if (step < 170) { return sf::Vector2i(centerX + 60, centerY - 60); }
+
+        // Off the cloth, so the rest of the run can settle and fall asleep
+        return sf::Vector2i(-100, -100);
+    }
+
+    /**
+     * @brief Returns the scripted input of a step: hover, drag, cut, pin, then let go.
+     */
+    ClothInput GetScriptedInput(int step)
+    {
+        ClothInput input;
+        input.mousePos = GetScriptedCursor(step);
+        input.lastMousePos = GetScriptedCursor(std::max(step - 1, 0));
+        input.cursorSize = 20.f;
+        input.isDragging = step >= 40 && step < 100;
+        input.isCutting = step >= 100 && step < 160;
+        input.isPinning = step >= 160 && step < 170;
+        return input;
+    }
+
+    /**
+     * @brief Steps a cloth with the scripted input and returns its state hash after each step.
+     */
+    std::vector<std::uint64_t> RunHashes(Cloth& cloth, int firstStep, int stepCount)
+    {
+        std::vector<std::uint64_t> hashes;
+        hashes.reserve(stepCount);
+        for (int step = firstStep; step < firstStep + stepCount; step++)
+        {
+            cloth.Update(DELTA_TIME, GetScriptedInput(step));
+            hashes.push_back(StateHash::Compute(cloth));
+        }
+        return hashes;
+    }
+
+    /**
+     * @brief Runs a fresh cloth with the scripted input and returns its state hash after each step.
+     */
+    std::vector<std::uint64_t> RunHashes(const TestConfig& config, unsigned threadCount, bool isReference)
+    {
+        Cloth cloth;
+        SetUpCloth(cloth, config, threadCount, isReference);
+        return RunHashes(cloth, 0, STEP_COUNT);
+    }
+
+    /**
+     * @brief Compares two runs step by step and reports the first step at which they differ.
+     *
+     * @param what Description of the two runs for the failure message.
+     * @return True if both runs have the same hash after every step.
+     */
+    bool CompareHashes(const std::string& what, const std::vector<std::uint64_t>& expected, const std::vector<std::uint64_t>& actual)
+    {
+        const std::size_t stepCount = std::min(expected.size(), actual.size());
+        for (std::size_t step = 0; step < stepCount; step++)
+        {
+            if (expected[step] != actual[step])
+            {
+                std::cerr << what << ": diverged at step " << step + 1 << ": expected " << StateHash::ToHex(expected[step]) << ", got "
+                          << StateHash::ToHex(actual[step]) << std::endl;
+                return false;
+            }
+        }
+
+        if (expected.size() != actual.size())
+        {
+            std::cerr << what << ": ran " << actual.size() << " steps instead of " << expected.size() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief A step must not depend on the thread count or on whether the SIMD kernels are used.
+     */
+    bool CheckDeterminism()
+    {
+        bool isPassed = true;
+        for (const TestConfig& config : GetConfigs())
+        {
+            const std::vector<std::uint64_t> serial = RunHashes(config, 1, false);
+            isPassed &= CompareHashes(std::string(config.name) + ", 1 vs 4 threads", serial, RunHashes(config, 4, false));
+            isPassed &= CompareHashes(std::string(config.name) + ", kernels vs reference", serial, RunHashes(config, 1, true));
+        }
+        return isPassed;
+    }
+
+    /**
+     * @brief Replaying an input log must reproduce the run it was recorded from.
+     */
+    bool CheckReplay()
+    {
+        const std::string path = "cloth_tests_input.bin";
+        constexpr int RESET_STEP = 260;
+
+        bool isPassed = true;
+        for (const TestConfig& config : GetConfigs())
+        {
+            // Record a run with a reset near the end, as the viewer records one
+            Cloth cloth;
+            SetUpCloth(cloth, config, 4, false);
+
+            InputLogWriter writer;
+            if (!writer.Open(path, DELTA_TIME, cloth.GetBoundsWidth(), cloth.GetBoundsHeight()))
+            {
+                std::cerr << "Could not write " << path << std::endl;
+                return false;
+            }
+
+            std::vector<std::uint64_t> recorded;
+            for (int step = 0; step < STEP_COUNT; step++)
+            {
+                const bool isReset = step == RESET_STEP;
+                if (isReset)
+                {
+                    cloth.Reset();
+                }
+
+                const ClothInput input = GetScriptedInput(step);
+                writer.Write(input, isReset);
+                cloth.Update(DELTA_TIME, input);
+                recorded.push_back(StateHash::Compute(cloth));
+            }
+            writer.Close();
+
+            InputLogReader reader;
+            if (!reader.Open(path) || reader.GetStepCount() != STEP_COUNT)
+            {
+                std::cerr << config.name << ": could not read back " << path << std::endl;
+                return false;
+            }
+
+            // Replay it into a fresh cloth that only knows what the log holds
+            Cloth replayed;
+            SetUpCloth(replayed, config, 1, false);
+            replayed.SetBounds(reader.GetBoundsWidth(), reader.GetBoundsHeight());
+
+            std::vector<std::uint64_t> replayedHashes;
+            ClothInput input;
+            bool isReset = false;
+            while (reader.Read(input, isReset))
+            {
+                if (isReset)
+                {
+                    replayed.Reset();
+                }
+
+                replayed.Update(reader.GetDeltaTime(), input);
+                replayedHashes.push_back(StateHash::Compute(replayed));
+            }
+
+            isPassed &= CompareHashes(std::string(config.name) + ", recorded vs replayed", recorded, replayedHashes);
+        }
+
+        std::remove(path.c_str());
+        return isPassed;
+    }
+
+    /**
+     * @brief Reads a whole file into memory.
+     */
+    std::vector<char> ReadFile(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * @brief Writes a block of memory to a file, replacing it.
+     */
+    void WriteFile(const std::string& path, const std::vector<char>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    /**
+     * @brief A cloth restored from a checkpoint must step exactly like the one that was saved.
+     */
+    bool CheckCheckpointRoundTrip()
+    {
+        const std::string path = "cloth_tests.checkpoint";
+
+        // Both after the cursor has left the cloth: once while the piece cut off
+        // rests but is still awake, so how long it has rested must carry over,
+        // and once after it has fallen asleep
+        const int saveSteps[] = {200, 250};
+
+        bool isPassed = true;
+        for (const TestConfig& config : GetConfigs())
+        {
+            for (const int saveStep : saveSteps)
+            {
+                Cloth cloth;
+                SetUpCloth(cloth, config, 4, false);
+                RunHashes(cloth, 0, saveStep);
+
+                if (!ClothCheckpoint::Save(cloth, path))
+                {
+                    std::cerr << "Could not write " << path << std::endl;
+                    return false;
+                }
+
+                // Nothing but the file and the thread count carries over
+                Cloth restored;
+                restored.SetThreadCount(4);
+                if (!ClothCheckpoint::Load(restored, path))
+                {
+                    std::cerr << config.name << ": could not load " << path << std::endl;
+                    isPassed = false;
+                    continue;
+                }
+
+                const std::string what = std::string(config.name) + ", saved vs restored at step " + std::to_string(saveStep);
+                isPassed &= CompareHashes(what, {StateHash::Compute(cloth)}, {StateHash::Compute(restored)});
+                isPassed &= CompareHashes(what, RunHashes(cloth, saveStep, STEP_COUNT - saveStep), RunHashes(restored, saveStep, STEP_COUNT - saveStep));
+
+                if (config.settings.sleepSpeed > 0.f && cloth.GetSleepingIslandCount() == 0)
+                {
+                    std::cerr << config.name << ": nothing fell asleep, so sleep is not covered" << std::endl;
+                    isPassed = false;
+                }
+            }
+        }
+
+        std::remove(path.c_str());
+        return isPassed;
+    }
+
+    /**
+     * @brief Load must reject a damaged file and leave the cloth as it was.
+     */
+    bool CheckCheckpointRejection()
+    {
+        const std::string path = "cloth_tests.checkpoint";
+        const std::string damagedPath = "cloth_tests_damaged.checkpoint";
+
+        const TestConfig config = GetConfigs()[1];
+        Cloth cloth;
+        SetUpCloth(cloth, config, 1, false);
+        RunHashes(cloth, 0, 120);
+        if (!ClothCheckpoint::Save(cloth, path))
+        {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
+        }
+
+        const std::vector<char> saved = ReadFile(path);
+
+        // Header offsets, see ClothCheckpoint.cpp
+        constexpr std::size_t MAGIC_OFFSET = 0;
+        constexpr std::size_t VERSION_OFFSET = 8;
+        constexpr std::size_t PARTICLE_COUNT_OFFSET = 24;
+        constexpr std::size_t CONSTRAINT_COUNT_OFFSET = 28;
+
+        struct Damage
+        {
+            const char* name;
+            std::vector<char> bytes;
+        };
+
+        std::vector<Damage> damages;
+        damages.push_back({"empty file", {}});
+        damages.push_back({"truncated header", std::vector<char>(saved.begin(), saved.begin() + 16)});
+        damages.push_back({"truncated arrays", std::vector<char>(saved.begin(), saved.begin() + saved.size() / 2)});
+        // Arrays are padded to 64 bytes, so this cuts into the last one
+        damages.push_back({"last array cut short", std::vector<char>(saved.begin(), saved.end() - 64)});
+
+        auto corrupt = [&](const char* name, std::size_t offset, std::uint32_t value)
+        {
+            Damage damage{name, saved};
+            std::memcpy(damage.bytes.data() + offset, &value, sizeof(value));
+            damages.push_back(damage);
+        };
+
+        std::uint32_t word;
+        corrupt("bad magic", MAGIC_OFFSET, 0);
+        std::memcpy(&word, saved.data() + VERSION_OFFSET, sizeof(word));
+        corrupt("other version", VERSION_OFFSET, word + 1);
+        std::memcpy(&word, saved.data() + PARTICLE_COUNT_OFFSET, sizeof(word));
+        corrupt("particle count too small", PARTICLE_COUNT_OFFSET, word - 1);
+        corrupt("particle count too large", PARTICLE_COUNT_OFFSET, word + 1000);
+        std::memcpy(&word, saved.data() + CONSTRAINT_COUNT_OFFSET, sizeof(word));
+        corrupt("constraint count changed", CONSTRAINT_COUNT_OFFSET, word / 2);
+
+        // A cloth that has seen different input, so a partial load would show in its hash
+        Cloth target;
+        SetUpCloth(target, config, 1, false);
+        RunHashes(target, 30, 90);
+        const std::uint64_t targetHash = StateHash::Compute(target);
+
+        bool isPassed = true;
+        for (const Damage& damage : damages)
+        {
+            WriteFile(damagedPath, damage.bytes);
+            if (ClothCheckpoint::Load(target, damagedPath))
+            {
+                std::cerr << "Loaded a checkpoint with " << damage.name << std::endl;
+                isPassed = false;
+            }
+            else if (StateHash::Compute(target) != targetHash)
+            {
+                std::cerr << "Failed load of a checkpoint with " << damage.name << " changed the cloth" << std::endl;
+                isPassed = false;
+            }
+        }
+
+        // The same bytes, undamaged, must still load
+        WriteFile(damagedPath, saved);
+        if (!ClothCheckpoint::Load(target, damagedPath) || StateHash::Compute(target) != StateHash::Compute(cloth))
+        {
+            std::cerr << "Could not load an undamaged copy of the checkpoint" << std::endl;
+            isPassed = false;
+        }
+
+        if (ClothCheckpoint::Load(target, "cloth_tests_missing.checkpoint"))
+        {
+            std::cerr << "Loaded a checkpoint that does not exist" << std::endl;
+            isPassed = false;
+        }
+
+        std::remove(path.c_str());
+        std::remove(damagedPath.c_str());
+        return isPassed;
+    }
+
+    /**
+     * @brief Runs a function and returns how many heap allocations it made.
+     */
+    template <typename Function>
+    std::size_t CountAllocations(Function&& function)
+    {
+        const std::size_t before = g_allocationCount.load();
+        function();
+        return g_allocationCount.load() - before;
+    }
+
+    /**
+     * @brief Reset, Rebuild to the same or a smaller size, and stepping once warmed up must not allocate.
+     */
+    bool CheckAllocations()
+    {
+        bool isPassed = true;
+        for (const TestConfig& config : GetConfigs())
+        {
+            for (const unsigned threadCount : {1u, 4u})
+            {
+                // Building the cloth has to allocate, so this also shows the counter works
+                Cloth cloth;
+                if (CountAllocations([&] { SetUpCloth(cloth, config, threadCount, false); }) == 0)
+                {
+                    std::cerr << "Allocations are not counted" << std::endl;
+                    return false;
+                }
+
+                std::vector<ClothDesc> cloths;
+                for (std::size_t i = 0; i < cloth.GetClothCount(); i++)
+                {
+                    cloths.push_back(cloth.GetClothDesc(i));
+                }
+
+                std::vector<ClothDesc> smallerCloths = cloths;
+                smallerCloths[0].widthCount /= 2;
+                smallerCloths[0].heightCount /= 2;
+
+                // Grow every buffer to what the scripted run needs, then do it all again from a reset
+                RunHashes(cloth, 0, STEP_COUNT);
+                cloth.Reset();
+                RunHashes(cloth, 0, STEP_COUNT);
+
+                auto runSteps = [&cloth]
+                {
+                    for (int step = 0; step < STEP_COUNT; step++)
+                    {
+                        cloth.Update(DELTA_TIME, GetScriptedInput(step));
+                    }
+                };
+
+                const std::string what = std::string(config.name) + " on " + std::to_string(threadCount) + (threadCount == 1 ? " thread" : " threads");
+                auto expectNone = [&](const char* operation, std::size_t allocationCount)
+                {
+                    if (allocationCount > 0)
+                    {
+                        std::cerr << what << ": " << operation << " made " << allocationCount << " allocations" << std::endl;
+                        isPassed = false;
+                    }
+                };
+
+                expectNone("Reset", CountAllocations([&cloth] { cloth.Reset(); }));
+                expectNone("stepping after Reset", CountAllocations(runSteps));
+                expectNone("Rebuild to the same size", CountAllocations([&] { cloth.Rebuild(cloths); }));
+                expectNone("stepping after Rebuild", CountAllocations(runSteps));
+                expectNone("Rebuild to a smaller size", CountAllocations([&] { cloth.Rebuild(smallerCloths); }));
+                expectNone("Rebuild back to the full size", CountAllocations([&] { cloth.Rebuild(cloths); }));
+            }
+        }
+        return isPassed;
+    }
+
+    /**
+     * @brief A check the command line can name.
+     */
+    struct Check
+    {
+        const char* name;
+        bool (*run)();
+    };
+
+    const Check CHECKS[] = {
+        {"determinism", &CheckDeterminism},
+        {"replay", &CheckReplay},
+        {"checkpoint", &CheckCheckpointRoundTrip},
+        {"checkpoint_damage", &CheckCheckpointRejection},
+        {"allocations", &CheckAllocations},
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    const char* only = argc > 1 ? argv[1] : nullptr;
+
+    bool isPassed = true;
+    bool isFound = false;
+    for (const Check& check : CHECKS)
+    {
+        if (only != nullptr && std::strcmp(only, check.name) != 0) { continue; }
+
+        isFound = true;
+        const bool isCheckPassed = check.run();
+        std::cout << check.name << ": " << (isCheckPassed ? "passed" : "FAILED") << std::endl;
+        isPassed &= isCheckPassed;
+    }
+
+    if (!isFound)
+    {
+        std::cerr << "Unknown check " << only << std::endl;
+        return 1;
+    }
+
+    return isPassed ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+#include "Cloth.h"
+#include "ClothConfig.h"
+#include "ClothSnapshot.h"
+#include "ConstraintKernel.h"
+#include "VerletIntegrator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Benchmark for the simulation core: builds cloths of several sizes and times
+ * the integration, constraint and render hand-off (snapshot) phases separately.
+ *
+ * Usage: cloth_bench [--sizes 24x19,100x100,...] [--steps N] [--warmup N] [--reps N]
+ *                    [--threads T] [--iterations N] [--shear S] [--bending B] [--json FILE]
+ *
+ * Sizes are particle cells (like CLOTH_WIDTH / CLOTH_GAPPING). Each repetition
+ * runs the given number of steps; the reported figures are the median over
+ * repetitions, so one noisy repetition does not skew the result. Shear and
+ * bending stiffness default to the viewer's; constraints of a type with zero
+ * stiffness are skipped by the solver and not counted.
+ */
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchSize
+    {
+        int width;
+        int height;
+    };
+
+    struct BenchResult
+    {
+        BenchSize size;
+        std::size_t particles = 0;
+        std::size_t constraints = 0;
+        double integrateNsPerParticle = 0.0;
+        double solveNsPerConstraint = 0.0;
+        double snapshotNsPerParticle = 0.0;
+        double stepsPerSecond = 0.0;
+    };
+
+    double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        std::size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+    }
+
+    double Nanoseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::nano>(duration).count();
+    }
+
+    std::vector<BenchSize> ParseSizes(const char* text)
+    {
+        std::vector<BenchSize> sizes;
+        std::stringstream stream(text);
+        std::string item;
+
+        while (std::getline(stream, item, ','))
+        {
+            BenchSize size{0, 0};
+            if (std::sscanf(item.c_str(), "%dx%d", &size.width, &size.height) == 2 && size.width > 0 && size.height > 0)
+            {
+                sizes.push_back(size);
+            }
+        }
+
+        return sizes;
+    }
+
+    BenchResult RunSize(BenchSize size, int steps, int warmup, int reps, unsigned threads, int iterations, float shear, float bending)
+    {
+        const int gap = CLOTH_GAPPING;
+        const float deltaTime = 1.0f / 60.0f;
+
+        // Frame the cloth like the viewer does, with room to fall
+        int boundsWidth = std::max(WIN_WIDTH, (size.width + 2) * gap);
+        int boundsHeight = std::max(WIN_HEIGHT, static_cast<int>(size.height * gap * 1.5f));
+        int start_x = boundsWidth * 0.5f - size.width * gap * 0.5f;
+        int start_y = boundsHeight * 0.1f;
+
+        Cloth cloth(size.width, size.height, gap, start_x, start_y, GRAVITY, DRAG, ELASTICITY);
+        cloth.SetBounds(boundsWidth, boundsHeight);
+        cloth.SetThreadCount(threads);
+
+        SolverSettings solver;
+        solver.minIterations = iterations;
+        solver.maxIterations = iterations;
+        solver.shearStiffness = shear;
+        solver.bendingStiffness = bending;
+        cloth.SetSolverSettings(solver);
+
+        ClothInput input;
+        ClothSnapshot snapshot;
+
+        for (int i = 0; i < warmup; i++)
+        {
+            cloth.Update(deltaTime, input);
+            snapshot.Capture(cloth, i + 1);
+        }
+
+        std::vector<double> integrate, solve, capture, total;
+
+        for (int rep = 0; rep < reps; rep++)
+        {
+            Clock::duration integrateTime{}, solveTime{}, captureTime{};
+
+            for (int i = 0; i < steps; i++)
+            {
+                auto t0 = Clock::now();
+                cloth.IntegrateParticles(deltaTime, input);
+                auto t1 = Clock::now();
+                cloth.SolveConstraints(deltaTime);
+                auto t2 = Clock::now();
+                snapshot.Capture(cloth, i + 1);
+                auto t3 = Clock::now();
+
+                integrateTime += t1 - t0;
+                solveTime += t2 - t1;
+                captureTime += t3 - t2;
+            }
+
+            integrate.push_back(Nanoseconds(integrateTime) / steps);
+            solve.push_back(Nanoseconds(solveTime) / steps);
+            capture.push_back(Nanoseconds(captureTime) / steps);
+            total.push_back(Nanoseconds(integrateTime + solveTime) / steps);
+        }
+
+        BenchResult result;
+        result.size = size;
+        result.particles = cloth.GetParticles().Size();
+        // Only batches the solver actually visits
+        for (const ConstraintBatch& batch : cloth.GetBatches())
+        {
+            bool isSolved = batch.type == ConstraintType::Structural || (batch.type == ConstraintType::Shear ? shear : bending) > 0.f;
+            result.constraints += isSolved ? batch.end - batch.begin : 0;
+        }
+        result.integrateNsPerParticle = Median(integrate) / result.particles;
+        result.solveNsPerConstraint = Median(solve) / (result.constraints * static_cast<double>(iterations));
+        result.snapshotNsPerParticle = Median(capture) / result.particles;
+        result.stepsPerSecond = 1e9 / Median(total);
+        return result;
+    }
+
+    void WriteJson(std::ostream& out, const std::vector<BenchResult>& results, int steps, int warmup, int reps, unsigned threads, int iterations)
+    {
+        out << "{\n"
+            << "  \"kernel\": \"" << VerletIntegrator::GetKernelName() << "\",\n"
+            << "  \"constraint_kernel\": \"" << ConstraintKernel::GetKernelName() << "\",\n"
+            << "  \"threads\": " << threads << ",\n"
+            << "  \"iterations\": " << iterations << ",\n"
+            << "  \"steps\": " << steps << ",\n"
+            << "  \"warmup\": " << warmup << ",\n"
+            << "  \"reps\": " << reps << ",\n"
+            << "  \"results\": [\n";
+
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult& r = results[i];
+            out << "    {\"width\": " << r.size.width
+                << ", \"height\": " << r.size.height
+                << ", \"particles\": " << r.particles
+                << ", \"constraints\": " << r.constraints
+                << ", \"integrate_ns_per_particle\": " << r.integrateNsPerParticle
+                << ", \"solve_ns_per_constraint\": " << r.solveNsPerConstraint
+                << ", \"snapshot_ns_per_particle\": " << r.snapshotNsPerParticle
+                << ", \"steps_per_sec\": " << r.stepsPerSecond
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<BenchSize> sizes = {{CLOTH_WIDTH / CLOTH_GAPPING, CLOTH_HEIGHT / CLOTH_GAPPING}, {100, 100}, {250, 250}, {500, 500}, {1000, 1000}};
+    int steps = 20;
+    int warmup = 5;
+    int reps = 5;
+    unsigned threads = 1;
+    int iterations = 1;
+    float shear = SHEAR_STIFFNESS;
+    float bending = BENDING_STIFFNESS;
+    std::string jsonPath;
+
+    // Parse "--name value" pairs
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+
+        if (std::strcmp(name, "--sizes") == 0) sizes = ParseSizes(value);
+        else if (std::strcmp(name, "--steps") == 0) steps = std::atoi(value);
+        else if (std::strcmp(name, "--warmup") == 0) warmup = std::atoi(value);
+        else if (std::strcmp(name, "--reps") == 0) reps = std::atoi(value);
+        else if (std::strcmp(name, "--threads") == 0) threads = static_cast<unsigned>(std::atoi(value));
+        else if (std::strcmp(name, "--iterations") == 0) iterations = std::atoi(value);
+        else if (std::strcmp(name, "--shear") == 0) shear = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--bending") == 0) bending = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--json") == 0) jsonPath = value;
+        else
+        {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+
+    if (sizes.empty() || steps <= 0 || warmup < 0 || reps <= 0 || iterations <= 0)
+    {
+        std::cerr << "Usage: cloth_bench [--sizes 24x19,100x100,...] [--steps N] [--warmup N] [--reps N]\n"
+                  << "                   [--threads T] [--iterations N] [--shear S] [--bending B] [--json FILE]" << std::endl;
+        return 1;
+    }
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::printf("kernel %s/%s, %u thread(s), %d iteration(s), %d steps x %d reps (+%d warmup)\n",
+                VerletIntegrator::GetKernelName(), ConstraintKernel::GetKernelName(), threads, iterations, steps, reps, warmup);
+    std::printf("%-11s %10s %12s %14s %15s %14s %12s\n", "size", "particles", "constraints", "integrate ns/p", "solve ns/c", "snapshot ns/p", "steps/sec");
+
+    std::vector<BenchResult> results;
+
+    for (const BenchSize& size : sizes)
+    {
+        BenchResult r = RunSize(size, steps, warmup, reps, threads, iterations, shear, bending);
+        results.push_back(r);
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", size.width, size.height);
+        std::printf("%-11s %10zu %12zu %14.3f %15.3f %14.3f %12.1f\n", label, r.particles, r.constraints,
+                    r.integrateNsPerParticle, r.solveNsPerConstraint, r.snapshotNsPerParticle, r.stepsPerSecond);
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream file(jsonPath);
+        if (!file)
+        {
+            std::cerr << "Could not open " << jsonPath << std::endl;
+            return 1;
+        }
+
+        WriteJson(file, results, steps, warmup, reps, threads, iterations);
+    }
+
+    return 0;
+}
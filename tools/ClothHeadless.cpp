@@ -0,0 +1,445 @@
+#include "Cloth.h"
+#include "ClothCheckpoint.h"
+#include "ClothScene.h"
+#include "ClothConfig.h"
+#include "ConstraintKernel.h"
+#include "ImageSequenceWriter.h"
+#include "InputLog.h"
+#include "Profiler.h"
+#include "SoftwareRenderer.h"
+#include "StateHash.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TrajectoryWriter.h"
+#include "VerletIntegrator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/**
+ * Headless driver: steps a Cloth as fast as the CPU allows, without a window.
+ *
+ * Usage: cloth_headless [--steps N] [--width W] [--height H] [--gap G] [--dt SECONDS] [--threads T]
+ *                       [--min-iterations N] [--max-iterations N] [--tolerance T] [--norm max|rms] [--report 0|1]
+ *                       [--self-collision DISTANCE] [--shear STIFFNESS] [--bending STIFFNESS] [--multigrid LEVELS]
+ *                       [--trace FILE] [--load FILE] [--save FILE] [--record FILE]
+ *                       [--scene FILE] [--reset-every N] [--sleep SPEED]
+ *                       [--replay FILE] [--hash-log FILE] [--verify FILE] [--reference 0|1]
+ *                       [--frames PATTERN] [--frame-size WxH] [--frame-every N]
+ *                       [--xpbd 0|1] [--structural-compliance C] [--shear-compliance C] [--bending-compliance C]
+ *                       [--implicit 0|1] [--spring-stiffness K] [--cg-iterations N] [--cg-tolerance T]
+ *
+ * Width and height are given in simulation units like CLOTH_WIDTH/CLOTH_HEIGHT,
+ * so running without arguments simulates the same scene as the viewer.
+ * --threads sizes the one work-stealing pool shared by the solver, the renderer and
+ * the step's task graph (zero uses every hardware thread); after each update, hashing,
+ * recording and drawing the frame run side by side.
+ * --trace writes the profiler's most recent phase timings as a Chrome trace.
+ * --load resumes from a checkpoint instead of the initial grid, and --save writes
+ * one after the last step, e.g. to settle a large cloth once and resume it in the viewer.
+ * --record streams every step to a trajectory file that the viewer can play back.
+ * --shear and --bending default to the viewer's SHEAR_STIFFNESS and BENDING_STIFFNESS.
+ * --multigrid solves that many coarse grid levels before the passes of each step.
+ * --scene builds the cloths of a scene file (see ClothScene) instead of one cloth,
+ * inside the viewer's default window area.
+ * --reset-every returns the cloths to their initial state every N steps, as a kiosk
+ * loop would; resets happen in place and allocate nothing.
+ * --sleep puts pieces of cloth to sleep once none of their particles moves faster
+ * than SPEED pixels per step for a second (see IslandSet); it defaults to the viewer's
+ * SLEEP_SPEED, and 0 keeps every piece awake.
+ * --replay steps the cloth with the input the viewer logged in DETERMINISTIC_MODE,
+ * using the logged time step and bounds; combine it with --load INPUT_START_FILE.
+ * It runs every logged step unless --steps is given.
+ * --hash-log writes the state hash after every step ("step hash" per line, as the
+ * viewer's HASH_LOG_FILE), and --verify compares against such a log and stops at
+ * the first step that differs.
+ * --reference solves with the scalar reference loops instead of the SIMD kernels.
+ * --frames draws the cloth on the CPU every --frame-every steps (default 1) and
+ * writes the pictures as numbered images, e.g. "frames/cloth_%05d.png" (or .ppm),
+ * at --frame-size pixels (default 1920x1080), on the same pool as the solver.
+ * --xpbd 1 solves with compliances (defaulting to the viewer's *_COMPLIANCE) instead
+ * of stiffness fractions, so changing --dt or the iteration count keeps the material.
+ * --implicit 1 replaces Verlet and the passes by a backward Euler step with springs of
+ * --spring-stiffness (default SPRING_STIFFNESS), solved by conjugate gradient within
+ * --cg-iterations and --cg-tolerance; "iterations" then counts its iterations.
+ */
+int main(int argc, char** argv)
+{
+    long long steps = 1000;
+    int clothWidth = CLOTH_WIDTH;
+    int clothHeight = CLOTH_HEIGHT;
+    int gap = CLOTH_GAPPING;
+    float deltaTime = 1.0f / 60.0f;
+    unsigned threads = 1;
+    SolverSettings solver;
+    solver.shearStiffness = SHEAR_STIFFNESS;
+    solver.bendingStiffness = BENDING_STIFFNESS;
+    solver.structuralCompliance = STRUCTURAL_COMPLIANCE;
+    solver.shearCompliance = SHEAR_COMPLIANCE;
+    solver.bendingCompliance = BENDING_COMPLIANCE;
+    solver.springStiffness = SPRING_STIFFNESS;
+    solver.sleepSpeed = SLEEP_SPEED;
+    bool report = false;
+    std::string tracePath;
+    std::string loadPath;
+    std::string savePath;
+    std::string recordPath;
+    std::string scenePath;
+    long long resetEvery = 0;
+    bool isStepsSet = false;
+    bool isReference = false;
+    std::string replayPath;
+    std::string hashLogPath;
+    std::string verifyPath;
+    std::string framesPattern;
+    int frameWidth = 1920;
+    int frameHeight = 1080;
+    long long frameEvery = 1;
+
+    // Parse "--name value" pairs; a trailing name without a value (e.g. --help) shows the usage
+    bool isValueMissing = false;
+    for (int i = 1; i < argc; i += 2)
+    {
+        const char* name = argv[i];
+        if (i + 1 == argc)
+        {
+            isValueMissing = true;
+            break;
+        }
+        const char* value = argv[i + 1];
+
+        if (std::strcmp(name, "--steps") == 0) { steps = std::atoll(value); isStepsSet = true; }
+        else if (std::strcmp(name, "--width") == 0) clothWidth = std::atoi(value);
+        else if (std::strcmp(name, "--height") == 0) clothHeight = std::atoi(value);
+        else if (std::strcmp(name, "--gap") == 0) gap = std::atoi(value);
+        else if (std::strcmp(name, "--dt") == 0) deltaTime = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--threads") == 0) threads = static_cast<unsigned>(std::atoi(value));
+        else if (std::strcmp(name, "--min-iterations") == 0) solver.minIterations = std::atoi(value);
+        else if (std::strcmp(name, "--max-iterations") == 0) solver.maxIterations = std::atoi(value);
+        else if (std::strcmp(name, "--tolerance") == 0) solver.tolerance = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--norm") == 0) solver.norm = std::strcmp(value, "rms") == 0 ? ResidualNorm::RMS : ResidualNorm::Max;
+        else if (std::strcmp(name, "--report") == 0) report = std::atoi(value) != 0;
+        else if (std::strcmp(name, "--self-collision") == 0) solver.selfCollisionDistance = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--shear") == 0) solver.shearStiffness = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--bending") == 0) solver.bendingStiffness = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--multigrid") == 0) solver.multigridLevels = std::atoi(value);
+        else if (std::strcmp(name, "--trace") == 0) tracePath = value;
+        else if (std::strcmp(name, "--load") == 0) loadPath = value;
+        else if (std::strcmp(name, "--save") == 0) savePath = value;
+        else if (std::strcmp(name, "--record") == 0) recordPath = value;
+        else if (std::strcmp(name, "--scene") == 0) scenePath = value;
+        else if (std::strcmp(name, "--reset-every") == 0) resetEvery = std::atoll(value);
+        else if (std::strcmp(name, "--sleep") == 0) solver.sleepSpeed = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--replay") == 0) replayPath = value;
+        else if (std::strcmp(name, "--hash-log") == 0) hashLogPath = value;
+        else if (std::strcmp(name, "--verify") == 0) verifyPath = value;
+        else if (std::strcmp(name, "--reference") == 0) isReference = std::atoi(value) != 0;
+        else if (std::strcmp(name, "--frames") == 0) framesPattern = value;
+        else if (std::strcmp(name, "--frame-size") == 0)
+        {
+            if (std::sscanf(value, "%dx%d", &frameWidth, &frameHeight) != 2) frameWidth = 0;
+        }
+        else if (std::strcmp(name, "--frame-every") == 0) frameEvery = std::atoll(value);
+        else if (std::strcmp(name, "--xpbd") == 0) solver.model = std::atoi(value) != 0 ? ConstraintModel::Compliance : ConstraintModel::Stiffness;
+        else if (std::strcmp(name, "--structural-compliance") == 0) solver.structuralCompliance = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--shear-compliance") == 0) solver.shearCompliance = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--bending-compliance") == 0) solver.bendingCompliance = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--implicit") == 0) solver.integrator = std::atoi(value) != 0 ? IntegratorType::ImplicitEuler : IntegratorType::Verlet;
+        else if (std::strcmp(name, "--spring-stiffness") == 0) solver.springStiffness = static_cast<float>(std::atof(value));
+        else if (std::strcmp(name, "--cg-iterations") == 0) solver.cgMaxIterations = std::atoi(value);
+        else if (std::strcmp(name, "--cg-tolerance") == 0) solver.cgTolerance = static_cast<float>(std::atof(value));
+        else
+        {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+
+    if (isValueMissing || steps <= 0 || clothWidth <= 0 || clothHeight <= 0 || gap <= 0 || frameWidth <= 0 || frameHeight <= 0 || frameEvery <= 0)
+    {
+        std::cerr << "Usage: cloth_headless [--steps N] [--width W] [--height H] [--gap G] [--dt SECONDS] [--threads T]\n"
+                  << "                      [--min-iterations N] [--max-iterations N] [--tolerance T] [--norm max|rms] [--report 0|1]\n"
+                  << "                      [--self-collision DISTANCE] [--shear STIFFNESS] [--bending STIFFNESS] [--multigrid LEVELS]\n"
+                  << "                      [--trace FILE] [--load FILE] [--save FILE] [--record FILE]\n"
+                  << "                      [--scene FILE] [--reset-every N] [--sleep SPEED]\n"
+                  << "                      [--replay FILE] [--hash-log FILE] [--verify FILE] [--reference 0|1]\n"
+                  << "                      [--frames PATTERN] [--frame-size WxH] [--frame-every N]\n"
+                  << "                      [--xpbd 0|1] [--structural-compliance C] [--shear-compliance C] [--bending-compliance C]\n"
+                  << "                      [--implicit 0|1] [--spring-stiffness K] [--cg-iterations N] [--cg-tolerance T]" << std::endl;
+        return 1;
+    }
+
+    // Logged input brings its own time step and bounds
+    InputLogReader replay;
+    if (!replayPath.empty())
+    {
+        if (!replay.Open(replayPath) || replay.GetStepCount() == 0)
+        {
+            std::cerr << "Could not read input log " << replayPath << std::endl;
+            return 1;
+        }
+
+        deltaTime = replay.GetDeltaTime();
+        if (!isStepsSet)
+        {
+            steps = static_cast<long long>(replay.GetStepCount());
+        }
+    }
+
+    int width_particle_count = clothWidth / gap;
+    int height_particle_count = clothHeight / gap;
+
+    // Size the simulation area around the cloth the same way the viewer's window frames it
+    int boundsWidth = std::max(WIN_WIDTH, clothWidth + 2 * gap);
+    int boundsHeight = std::max(WIN_HEIGHT, static_cast<int>(clothHeight * 1.5f));
+
+    int start_x = boundsWidth * 0.5f - width_particle_count * gap * 0.5f;
+    int start_y = boundsHeight * 0.1f;
+
+    Cloth cloth(width_particle_count, height_particle_count, gap, start_x, start_y, GRAVITY, DRAG, ELASTICITY);
+
+    if (!scenePath.empty())
+    {
+        std::vector<ClothDesc> cloths;
+        std::vector<Collider> colliders;
+        if (!ClothScene::Load(scenePath, cloths, colliders))
+        {
+            return 1;
+        }
+
+        // Scene coordinates are window pixels
+        cloth.Rebuild(cloths);
+        cloth.SetColliders(colliders);
+        boundsWidth = WIN_WIDTH;
+        boundsHeight = WIN_HEIGHT;
+    }
+
+    if (!replayPath.empty())
+    {
+        boundsWidth = replay.GetBoundsWidth();
+        boundsHeight = replay.GetBoundsHeight();
+    }
+
+    // One pool for the solver, the renderer and the step graph, so they never oversubscribe the cores
+    auto threadPool = std::make_shared<ThreadPool>(threads);
+
+    cloth.SetBounds(boundsWidth, boundsHeight);
+    cloth.SetThreadPool(threadPool);
+    cloth.SetReferenceSolver(isReference);
+    cloth.SetSolverSettings(solver);
+
+    if (!loadPath.empty())
+    {
+        auto loadBegin = std::chrono::steady_clock::now();
+
+        if (!ClothCheckpoint::Load(cloth, loadPath))
+        {
+            std::cerr << "Could not load checkpoint " << loadPath << std::endl;
+            return 1;
+        }
+
+        std::cout << "load (ms)   : " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadBegin).count() << "\n";
+    }
+
+    // No cursor in batch runs
+    ClothInput input;
+
+    TrajectoryWriter recorder;
+    if (!recordPath.empty() && !recorder.Open(recordPath, cloth))
+    {
+        std::cerr << "Could not write trajectory " << recordPath << std::endl;
+        return 1;
+    }
+
+    SoftwareRenderer renderer;
+    ImageSequenceWriter frameWriter;
+    Image frame;
+    if (!framesPattern.empty())
+    {
+        if (!frameWriter.Open(framesPattern, frameWidth, frameHeight))
+        {
+            return 1;
+        }
+
+        renderer.SetThreadPool(threadPool);
+        renderer.SetColliders(cloth.GetColliders());
+        frame.Resize(frameWidth, frameHeight);
+    }
+
+    std::ofstream hashLog;
+    if (!hashLogPath.empty())
+    {
+        hashLog.open(hashLogPath);
+        if (!hashLog)
+        {
+            std::cerr << "Could not write " << hashLogPath << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream expectedHashes;
+    if (!verifyPath.empty())
+    {
+        expectedHashes.open(verifyPath);
+        if (!expectedHashes)
+        {
+            std::cerr << "Could not read " << verifyPath << std::endl;
+            return 1;
+        }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    long long totalIterations = 0;
+    long long verifiedSteps = 0;
+    long long renderedFrames = 0;
+    double renderSeconds = 0.0;
+    std::string divergence;
+
+    // One step as a task graph: the solver phases run in order, then the consumers
+    // below, which only read the cloth, so hashing, recording and drawing the frame overlap
+    long long step = 0;
+    TaskGraph stepGraph;
+    const TaskGraph::TaskId updateTask = cloth.AddStepTasks(stepGraph, deltaTime, input);
+
+    // Hashing reads the whole state, so it is skipped unless asked for
+    if (hashLog.is_open() || expectedHashes.is_open())
+    {
+        stepGraph.Precede(updateTask, stepGraph.Add([&] {
+            const std::string hash = StateHash::ToHex(StateHash::Compute(cloth));
+
+            if (hashLog.is_open())
+            {
+                hashLog << step + 1 << " " << hash << "\n";
+            }
+
+            long long expectedStep = 0;
+            std::string expectedHash;
+            if (expectedHashes.is_open() && expectedHashes >> expectedStep >> expectedHash)
+            {
+                if (expectedStep != step + 1 || expectedHash != hash)
+                {
+                    divergence = "Diverged from " + verifyPath + " at step " + std::to_string(step + 1) + ": expected " +
+                                 std::to_string(expectedStep) + " " + expectedHash + ", got " + hash;
+                    return;
+                }
+                verifiedSteps++;
+            }
+        }));
+    }
+
+    // Batch runs keep every step, waiting for the writer if it falls behind
+    if (recorder.IsOpen())
+    {
+        stepGraph.Precede(updateTask, stepGraph.Add([&] { recorder.Capture(cloth, step + 1, true); }));
+    }
+
+    if (frameWriter.IsOpen())
+    {
+        stepGraph.Precede(updateTask, stepGraph.Add([&] {
+            if ((step + 1) % frameEvery != 0) { return; }
+
+            auto renderBegin = std::chrono::steady_clock::now();
+            renderer.Render(cloth, frame);
+            renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderBegin).count();
+            renderedFrames++;
+
+            frameWriter.Submit(frame, true);
+        }));
+    }
+
+    for (step = 0; step < steps; step++)
+    {
+        bool isReset = resetEvery > 0 && step > 0 && step % resetEvery == 0;
+
+        if (!replayPath.empty())
+        {
+            bool isLoggedReset = false;
+            if (!replay.Read(input, isLoggedReset))
+            {
+                steps = step;
+                break;
+            }
+            isReset = isReset || isLoggedReset;
+        }
+
+        if (isReset)
+        {
+            cloth.Reset();
+        }
+
+        stepGraph.Run(*threadPool);
+
+        if (!divergence.empty())
+        {
+            std::cerr << divergence << std::endl;
+            return 1;
+        }
+
+        const SolverStats& stats = cloth.GetLastStepStats();
+        totalIterations += stats.iterations;
+
+        // Per-step solver report: step, passes, residual
+        if (report)
+        {
+            std::cout << step << " " << stats.iterations << " " << stats.residual << "\n";
+        }
+    }
+
+    recorder.Close();
+    frameWriter.Close();
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - begin).count();
+
+    std::cout << "kernel      : " << (isReference ? "Scalar reference" : VerletIntegrator::GetKernelName()) << " (integrate), "
+              << (isReference ? "Scalar reference" : ConstraintKernel::GetKernelName()) << " (constraints)\n"
+              << "threads     : " << (threads == 0 ? std::thread::hardware_concurrency() : threads) << "\n"
+              << "cloths      : " << cloth.GetClothCount() << "\n"
+              << "particles   : " << cloth.GetParticles().Size() << "\n"
+              << "constraints : " << cloth.GetConstraints().size() << "\n"
+              << "steps       : " << steps << "\n"
+              << "time (s)    : " << seconds << "\n"
+              << "iterations  : " << (steps > 0 ? static_cast<double>(totalIterations) / steps : 0.0) << " per step\n"
+              << "residual    : " << cloth.GetLastStepStats().residual << " (last step)\n"
+              << "contacts    : " << cloth.GetLastStepStats().contacts << " (last step)\n"
+              << "islands     : " << cloth.GetSleepingIslandCount() << " of " << cloth.GetIslandCount() << " asleep\n"
+              << "steps/sec   : " << (seconds > 0.0 ? steps / seconds : 0.0) << std::endl;
+
+    if (!framesPattern.empty())
+    {
+        std::cout << "frames      : " << frameWriter.GetWrittenFrames() << " written to " << framesPattern << "\n"
+                  << "render (ms) : " << (renderedFrames > 0 ? 1000.0 * renderSeconds / renderedFrames : 0.0) << " per frame" << std::endl;
+
+        if (frameWriter.GetFailedFrames() > 0)
+        {
+            return 1;
+        }
+    }
+
+    if (expectedHashes.is_open())
+    {
+        std::cout << "verified    : " << verifiedSteps << " steps match " << verifyPath << std::endl;
+    }
+
+    if (!savePath.empty() && !ClothCheckpoint::Save(cloth, savePath))
+    {
+        std::cerr << "Could not write checkpoint " << savePath << std::endl;
+        return 1;
+    }
+
+    if (!tracePath.empty() && !Profiler::Get().WriteChromeTrace(tracePath))
+    {
+        std::cerr << "Could not write " << tracePath << std::endl;
+        return 1;
+    }
+
+    return 0;
+}